@@ -12,6 +12,25 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <time.h>
+#include <unistd.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <limits.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/epoll.h>
+#include <sys/signalfd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <dirent.h>
+
+#include "JheamStorchRoss.h"
 
 /**
  * @brief Contem o tamanho maximo para um caminho suportado pelo programa
@@ -31,13 +50,25 @@ void combinaCaminho(char dest[], char cmnh1[], char cmnh2[]);
 // POSICAO
 
 /**
- * @brief Representa uma posicao em uma matriz bidimensional
+ * @brief Contem a largura de uma linha no indice de @ref tPosicao : o maior mapa, @ref TAM_MAPA , e uma celula de borda de cada lado
+ * @related tPosicao
+ */
+#define POS_LARGURA 102
+/**
+ * @brief Contem o numero de indices de @ref tPosicao , com as bordas; dimensiona as matrizes indexadas por posicao
+ * @related tPosicao
+ */
+#define POS_CELULAS (POS_LARGURA * POS_LARGURA)
+/**
+ * @brief Representa uma posicao em uma matriz bidimensional, como um unico indice linear de 32 bits
+ * 
+ * A celula (i, j) tem o indice (i + 1) * @ref POS_LARGURA + (j + 1), de modo que as posicoes uma celula
+ * alem de cada borda, produzidas por @ref avancaNaDirecao antes de @ref transformaPosicaoValida , tambem
+ * tem indice proprio. Linha e coluna so sao separadas, por @ref adquireI e @ref adquireJ , onde sao
+ * de fato usadas, como na saida e no indice denso de @ref adquireCelula
  * 
  */
-typedef struct {
-    int i; ///< Indica sua posicao na i-esima linha
-    int j; ///< Indica sua posicao na j-esima coluna
-} tPosicao;
+typedef int tPosicao;
 /**
  * @brief Inicializa uma struct de tipo @ref tPosicao
  * 
@@ -101,7 +132,7 @@ int comparaPos(tPosicao pos1, tPosicao pos2);
  */
 typedef struct {
     tPosicao posicao; ///< A posicao do rank
-    int heat; ///< O indice heat do rank
+    long long heat; ///< O indice heat do rank
 } tRank;
 /**
  * @brief Inicializa uma struct de tipo @ref tRank com @ref tPosicao @p posicao e @p heat
@@ -111,7 +142,7 @@ typedef struct {
  * @return tRank 
  * @related tRank
  */
-tRank inicializaRank(tPosicao posicao, int heat);
+tRank inicializaRank(tPosicao posicao, long long heat);
 /**
  * @brief Adquire a @ref tPosicao do @ref tRank @p rank
  * 
@@ -124,10 +155,10 @@ tPosicao adquirePosicao(tRank rank);
  * @brief Adquire o indice heat do @ref tRank @p rank
  * 
  * @param rank O @ref tRank
- * @return int O indice heat do @p rank
+ * @return long long O indice heat do @p rank
  * @related tRank
  */
-int adquireHeat(tRank rank);
+long long adquireHeat(tRank rank);
 /**
  * @brief Ordena o ranking de @ref tRank entre os indices @p e e @p d
  * 
@@ -161,25 +192,27 @@ int comparaRank(tRank rank1, tRank rank2);
 // FILA
 
 /**
- * @brief Contem o tamanho maximo de uma @ref tFila
- * @related tFila
- */
-#define TAM_FILA 100
-/**
- * @brief Representa uma estrultura de dados fila, de fluxo FIFO
+ * @brief Representa uma estrultura de dados fila, de fluxo FIFO, armazenada em um buffer circular
+ * 
+ * O buffer nao pertence a @ref tFila : quem a inicializa o fornece, com a capacidade de que precisa, e o libera.
+ * Copiar a struct copia apenas o ponteiro; para copiar os elementos, use @ref clonaFila
  * 
  */
 typedef struct {
     int tam; ///< Numero de elementos armazenados pela @ref tFila no momento
-    tPosicao vet[TAM_FILA]; ///< Vetor de elementos armazenados pela @ref tFila
+    int inicio; ///< Indice, em vet, do primeiro elemento da @ref tFila
+    int capacidade; ///< Numero de elementos que vet comporta
+    tPosicao *vet; ///< Buffer circular de elementos armazenados pela @ref tFila
 } tFila;
 /**
- * @brief Inicializa uma struct de tipo @ref tFila
+ * @brief Inicializa uma struct de tipo @ref tFila vazia sobre o buffer @p vet
  * 
+ * @param vet O buffer circular, que deve existir enquanto a @ref tFila for usada
+ * @param capacidade O numero de elementos que @p vet comporta
  * @return tFila Uma nova instancia de @ref tFila
  * @related tFila
  */
-tFila inicializaFila();
+tFila inicializaFila(tPosicao vet[], int capacidade);
 /**
  * @brief Adquire o tamanho da @ref tFila @p fila
  * 
@@ -187,7 +220,7 @@ tFila inicializaFila();
  * @return int O numero de elementos armazenados pela @ref tFila @p fila
  * @related tFila
  */
-int adquireTam(tFila fila);
+int adquireTam(const tFila *fila);
 /**
  * @brief Adquire o elemento enfileirado no dado @p index
  * 
@@ -196,24 +229,56 @@ int adquireTam(tFila fila);
  * @return tPosicao A @ref tPosicao no indice @p index na fila; caso esteja fora dos limites, retorna o elemento no final da fila
  * @related tFila
  */
-tPosicao adquireElem(tFila fila, int index);
+tPosicao adquireElem(const tFila *fila, int index);
 /**
- * @brief Adiciona um elemento no inicio da @ref tFila @p fila
+ * @brief Consulta, sem copiar a @ref tFila , o elemento enfileirado no dado @p index
  * 
  * @param fila A @ref tFila
+ * @param index O index no qual sera adquirido o elemento, entre 0 e o tamanho da @p fila menos 1
+ * @return tPosicao A @ref tPosicao no indice @p index na fila
+ * @related tFila
+ */
+tPosicao consultaElem(const tFila *fila, int index);
+/**
+ * @brief Adiciona um elemento no inicio da @ref tFila @p fila
+ * 
+ * Com a @p fila cheia, o novo elemento ocupa o lugar do ultimo, que deve ser removido em seguida com @ref desenfileira
+ * 
+ * @param fila A @ref tFila que sera alterada
  * @param pos O elemento @ref tPos que sera adicionado
- * @return tFila A @p fila com o novo elemento
  * @related tFila
  */
-tFila enfileira(tFila fila, tPosicao pos);
+void enfileira(tFila *fila, tPosicao pos);
 /**
  * @brief Remove um elemento no final da @ref tFila @p fila
  * 
- * @param fila A @ref tFila
- * @return tFila A @p fila sem o ultimo elemento
+ * @param fila A @ref tFila que sera alterada
+ * @related tFila
+ */
+void desenfileira(tFila *fila);
+/**
+ * @brief Remove, em O(1), o elemento no inicio da @ref tFila @p fila ; desfaz o @ref enfileira
+ * 
+ * @param fila A @ref tFila que sera alterada
+ * @related tFila
+ */
+void removeInicio(tFila *fila);
+/**
+ * @brief Devolve, em O(1), o elemento @p pos ao final da @ref tFila @p fila ; desfaz o @ref desenfileira
+ * 
+ * @param fila A @ref tFila que sera alterada
+ * @param pos O elemento @ref tPosicao que sera adicionado
+ * @related tFila
+ */
+void insereFim(tFila *fila, tPosicao pos);
+/**
+ * @brief Copia a @ref tFila @p origem para @p destino , copiando apenas os elementos armazenados
+ * 
+ * @param destino A @ref tFila que recebera a copia, no seu proprio buffer, com capacidade para todos os elementos de @p origem
+ * @param origem A @ref tFila copiada
  * @related tFila
  */
-tFila desenfileira(tFila fila);
+void clonaFila(tFila *destino, const tFila *origem);
 
 // FIM FILA
 // COBRA
@@ -261,12 +326,14 @@ typedef struct {
 /**
  * @brief Inicializa uma struct do tipo @ref tCobra com a cabeca @p posCab e direcao baseada em @p direcaoInicial
  * 
+ * @param corpo O buffer do corpo da @ref tCobra , que deve existir enquanto ela for usada
+ * @param capacidade O numero de partes que @p corpo comporta, ou seja, o maior tamanho da @ref tCobra
  * @param posCab A posicao da cabeca da @ref tCobra
  * @param direcaoInicial A representacao em @ref char da cabeca da cobra que definira a direcaoCabeca da @ref tCobra
  * @return tCobra Uma nova instancia da @ref tCobra
  * @related tCobra
  */
-tCobra inicializaCobra(tPosicao posCab, char direcaoInicial);
+tCobra inicializaCobra(tPosicao corpo[], int capacidade, tPosicao posCab, char direcaoInicial);
 /**
  * @brief Adquire a @ref tPosicao da cabeca da @p cobra
  * 
@@ -274,15 +341,15 @@ tCobra inicializaCobra(tPosicao posCab, char direcaoInicial);
  * @return tPosicao A posicao da cabeca da @p cobra
  * @related tCobra
  */
-tPosicao adquireCabeca(tCobra cobra);
+tPosicao adquireCabeca(const tCobra *cobra);
 /**
  * @brief Adquire a @ref tFila que contem todo o corpo da @ref tCobra @p cobra
  * 
  * @param cobra A @ref tCobra
- * @return tFila As posicoes de todo o corpo da @ref tCobra
+ * @return const tFila* As posicoes de todo o corpo da @ref tCobra
  * @related tCobra
  */
-tFila adquireCorpo(tCobra cobra);
+const tFila *adquireCorpo(const tCobra *cobra);
 /**
  * @brief Adquire a direcao da @ref tCobra @p cobra
  * 
@@ -290,16 +357,15 @@ tFila adquireCorpo(tCobra cobra);
  * @return int A direcao da @ref tCobra
  * @related tCobra
  */
-int adquireDirecao(tCobra cobra);
+int adquireDirecao(const tCobra *cobra);
 /**
  * @brief Define @p direcao como a direcao para a @ref tCobra @p cobra
  * 
- * @param cobra A @ref tCobra
+ * @param cobra A @ref tCobra que sera alterada
  * @param direcao A nova direcao
- * @return tCobra A @ref tCobra com a nova direcao
  * @related tCobra
  */
-tCobra defineDirecao(tCobra cobra, int direcao);
+void defineDirecao(tCobra *cobra, int direcao);
 /**
  * @brief Adquire a ultima celula devorada pela @ref tCobra @p cobra
  * 
@@ -307,7 +373,7 @@ tCobra defineDirecao(tCobra cobra, int direcao);
  * @return char A celula devorada pela @ref tCobra
  * @related tCobra
  */
-char adquireDevorado(tCobra cobra);
+char adquireDevorado(const tCobra *cobra);
 /**
  * @brief Adquire o estado atual da @ref tCobra @p cobra
  * 
@@ -315,16 +381,15 @@ char adquireDevorado(tCobra cobra);
  * @return int O estado, sendo @ref CBR_EST_V para VIVA; @ref CBR_EST_M , para MORTA
  * @related tCobra 
  */
-int adquireEstado(tCobra cobra);
+int adquireEstado(const tCobra *cobra);
 /**
  * @brief Define @p estado como o estado para a @ref tCobra @p cobra
  * 
- * @param cobra A @ref tCobra
+ * @param cobra A @ref tCobra que sera alterada
  * @param estado O novo estado
- * @return tCobra A @ref tCobra com o novo estado
  * @related tCobra 
  */
-tCobra defineEstado(tCobra cobra, int estado);
+void defineEstado(tCobra *cobra, int estado);
 /**
  * @brief Adquire o tamanho atual da @ref tCobra @p cobra
  * 
@@ -332,23 +397,418 @@ tCobra defineEstado(tCobra cobra, int estado);
  * @return int O tamanho da @ref tCobra somando sua cabeca com seu corpo
  * @related tCobra
  */
-int adquireTamanho(tCobra cobra);
+int adquireTamanho(const tCobra *cobra);
+/**
+ * @brief Verifica se a @ref tCobra cresce ao devorar a celula @p celDevorado
+ * 
+ * A cobra cresce sempre que devora comida: seu corpo comporta todas as celulas do tabuleiro
+ * 
+ * @param celDevorado A celula devorada no movimento
+ * @return int Verdadeiro, caso a cobra cresca; do contrario, falso
+ * @related tCobra
+ */
+int cresceAoDevorar(char celDevorado);
 /**
  * @brief Move a cabeca da @ref tCobra para a @ref tPosicao @p pos , atualizando tambem os membros estado, devorado, tamanho e o corpo da @ref tCobra @p cobra
  * 
- * @param cobra A @ref tCobra
+ * @param cobra A @ref tCobra que sera alterada
  * @param pos A nova posicao da cabeca da @ref tCobra
  * @param celDevorado A celula que foi devorada no processo de movimento
- * @return tCobra A @ref tCobra com a posicao da cabeca e do corpo e os membros estado, devorado e tamanho atualizados durante o moviemento
  * @related tCobra
  */
-tCobra moveCbr(tCobra cobra, tPosicao pos, char celDevorado);
+void moveCbr(tCobra *cobra, tPosicao pos, char celDevorado);
+/**
+ * @brief Copia a @ref tCobra @p origem para @p destino , copiando apenas as partes existentes do corpo
+ * 
+ * @param destino A @ref tCobra que recebera a copia, no buffer do seu proprio corpo
+ * @param origem A @ref tCobra copiada
+ * @related tCobra
+ */
+void clonaCobra(tCobra *destino, const tCobra *origem);
 
 // FIM COBRA
+// SUJAS
+
+/**
+ * @brief Representa a lista de celulas do heatmap alteradas desde o ultimo snapshot
+ *
+ */
+typedef struct {
+    int qtd; ///< Numero de celulas sujas no momento
+    int *celulas; ///< Os indices lineares (i * mColunas + j) das celulas sujas, na ordem em que sujaram
+    int *incrementos; ///< O quanto cada celula, pelo seu indice linear, foi incrementada desde o ultimo snapshot
+} tSujas;
+/**
+ * @brief Representa o incremento de uma celula suja, copiado para fora da @ref tSujas
+ *
+ */
+typedef struct {
+    int celula; ///< O indice linear da celula
+    int incremento; ///< O quanto a celula foi incrementada
+} tIncremento;
+/**
+ * @brief Aloca uma @ref tSujas vazia para um mapa de @p nCelulas celulas
+ *
+ * @param nCelulas O numero total de celulas do mapa
+ * @return tSujas* Uma nova instancia de @ref tSujas que deve ser liberada com @ref liberaSujas ; NULL, caso falte memoria
+ * @related tSujas
+ */
+tSujas *inicializaSujas(int nCelulas);
+/**
+ * @brief Marca a celula de indice linear @p celula como suja, incrementando-a em 1
+ *
+ * @param sujas A @ref tSujas
+ * @param celula O indice linear da celula
+ * @related tSujas
+ */
+void marcaSuja(tSujas *sujas, int celula);
+/**
+ * @brief Escreve as celulas sujas como um snapshot delta no arquivo @p arq e limpa a lista
+ *
+ * O snapshot tem o formato: varint(movimento) varint(qtd) e, para cada celula em ordem crescente,
+ * varint(distancia ate a celula anterior) varint(incremento)
+ *
+ * @param sujas A @ref tSujas
+ * @param arq O arquivo binario de destino
+ * @param movimento O numero do movimento ao qual o snapshot se refere
+ * @return int 0 em caso de sucesso; -1, caso falte memoria, e entao nada e escrito e as celulas continuam sujas
+ * @related tSujas
+ */
+int escreveSnapshot(tSujas *sujas, FILE *arq, long long movimento);
+/**
+ * @brief Copia as celulas sujas e seus incrementos para @p destino e limpa a lista
+ *
+ * @param sujas A @ref tSujas
+ * @param destino O vetor que recebera os incrementos, com espaco para ao menos qtd elementos
+ * @return int A quantidade de incrementos copiados
+ * @related tSujas
+ */
+int extraiIncrementos(tSujas *sujas, tIncremento destino[]);
+/**
+ * @brief Escreve os @p incrementos como um snapshot delta no arquivo @p arq , no formato de @ref escreveSnapshot
+ *
+ * @param arq O arquivo binario de destino
+ * @param movimento O numero do movimento ao qual o snapshot se refere
+ * @param incrementos Os incrementos, que serao ordenados pela celula
+ * @param qtd A quantidade de incrementos
+ * @related tSujas
+ */
+void escreveIncrementos(FILE *arq, long long movimento, tIncremento incrementos[], int qtd);
+/**
+ * @brief Libera a memoria de uma @ref tSujas
+ *
+ * @param sujas A @ref tSujas, podendo ser NULL
+ * @related tSujas
+ */
+void liberaSujas(tSujas *sujas);
+/**
+ * @brief Compara dois @ref tIncremento pelo indice linear da celula, no formato esperado pelo qsort
+ *
+ * @param inc1 Ponteiro para o @ref tIncremento que sera comparado com @p inc2
+ * @param inc2 Ponteiro para o @ref tIncremento que sera comparado com @p inc1
+ * @return int Negativo, caso @p inc1 venha antes de @p inc2; zero, caso sejam iguais; positivo, caso contrario
+ * @related tSujas
+ */
+int comparaIncremento(const void *inc1, const void *inc2);
+/**
+ * @brief Escreve @p valor no arquivo @p arq como um varint (LEB128 sem sinal)
+ *
+ * @param arq O arquivo binario de destino
+ * @param valor O valor a ser escrito
+ */
+void escreveVarint(FILE *arq, unsigned long valor);
+/**
+ * @brief Le um varint (LEB128 sem sinal), como escrito por @ref escreveVarint , do buffer em @p *dados
+ *
+ * @param dados Ponteiro para o cursor no buffer, avancado para depois do varint
+ * @param fim O fim do buffer
+ * @param valor Recebe o valor lido
+ * @return int 0 em caso de sucesso; -1, caso o varint esteja truncado ou nao caiba em 64 bits
+ */
+int leVarint(const unsigned char **dados, const unsigned char *fim, unsigned long *valor);
+/**
+ * @brief Soma os incrementos das celulas sujas em @p acumulado, indexado pelo indice linear, e limpa a lista
+ *
+ * @param sujas A @ref tSujas
+ * @param acumulado O vetor de contadores que recebera os incrementos
+ * @related tSujas
+ */
+void acumulaSujas(tSujas *sujas, long long acumulado[]);
+
+// FIM SUJAS
+// HEATMAP
+
+/**
+ * @brief Contem a assinatura, com o '\0' final, que inicia o arquivo de um heatmap mapeado
+ * @related tHeatmap
+ */
+#define HMV_ASSN "JSRHMV1"
+/**
+ * @brief Representa o cabecalho do arquivo binario de um heatmap mapeado, seguido de nLinhas x mColunas contadores de 64 bits
+ *
+ * Todos os inteiros estao na ordem de bytes da maquina; o arquivo tem sempre o mesmo tamanho e e
+ * atualizado no lugar, sem sincronizacao: um leitor pode ver o movimento em andamento pela metade
+ *
+ */
+typedef struct {
+    char assinatura[8]; ///< A assinatura @ref HMV_ASSN
+    unsigned int nLinhas; ///< Numero de linhas do mapa
+    unsigned int mColunas; ///< Numero de colunas do mapa
+    unsigned long long qtdMov; ///< Quantos movimentos os contadores ja contem
+} tCabecalhoVivo;
+/**
+ * @brief Representa o heatmap de um mapa: quantas vezes a cabeca da cobra passou por cada celula
+ *
+ * Os contadores comecam com 32 bits e passam, todos de uma vez, a 64 bits quando algum deles
+ * transbordaria; assim, jogos comuns ocupam metade da memoria, e jogos muito longos nao transbordam
+ *
+ */
+typedef struct {
+    int nCelulas; ///< O numero de celulas, indexadas por i * mColunas + j
+    unsigned int *estreitos; ///< Os contadores de 32 bits; NULL depois de alargados
+    unsigned long long *largos; ///< Os contadores de 64 bits; NULL enquanto os de 32 bits bastam
+    tCabecalhoVivo *vivo; ///< O inicio do arquivo mapeado por @ref mapeiaHeatmap , que contem largos; NULL fora dele
+    int incompleto; ///< Se algum contador deixou de ser incrementado, parado no maximo de 32 bits, por falta de memoria para alarga-los
+} tHeatmap;
+/**
+ * @brief Aloca um @ref tHeatmap zerado para um mapa de @p nCelulas celulas
+ *
+ * @param nCelulas O numero total de celulas do mapa
+ * @return tHeatmap* Uma nova instancia de @ref tHeatmap que deve ser liberada com @ref liberaHeatmap ; NULL, caso falte memoria
+ * @related tHeatmap
+ */
+tHeatmap *inicializaHeatmap(int nCelulas);
+/**
+ * @brief Passa a manter os contadores do @ref tHeatmap num arquivo mapeado em memoria, atualizado no lugar a cada incremento
+ *
+ * O arquivo, com um @ref tCabecalhoVivo e os contadores de 64 bits, pode ser lido por outros processos
+ * enquanto o jogo ocorre, sem custo para o jogo
+ *
+ * @param heatmap O @ref tHeatmap , ainda fora de um arquivo
+ * @param caminho O caminho do arquivo, criado ou sobrescrito
+ * @param nLinhas O numero de linhas do mapa
+ * @param mColunas O numero de colunas do mapa
+ * @return int 0 em caso de sucesso; -1, caso o arquivo nao possa ser criado ou mapeado
+ * @related tHeatmap
+ */
+int mapeiaHeatmap(tHeatmap *heatmap, const char caminho[], int nLinhas, int mColunas);
+/**
+ * @brief Publica no cabecalho do arquivo mapeado que os contadores contem @p qtdMov movimentos; nada faz fora de um arquivo
+ *
+ * @param heatmap O @ref tHeatmap
+ * @param qtdMov A quantidade de movimentos
+ * @related tHeatmap
+ */
+void publicaMovimentos(tHeatmap *heatmap, long long qtdMov);
+/**
+ * @brief Copia o @ref tHeatmap @p origem , na largura atual dos seus contadores, sempre em memoria
+ *
+ * @param origem O @ref tHeatmap
+ * @return tHeatmap* A copia, que deve ser liberada com @ref liberaHeatmap ; NULL, caso falte memoria
+ * @related tHeatmap
+ */
+tHeatmap *clonaHeatmap(const tHeatmap *origem);
+/**
+ * @brief Incrementa em 1 o contador da celula de indice linear @p celula , alargando os contadores se preciso
+ *
+ * @param heatmap O @ref tHeatmap
+ * @param celula O indice linear da celula
+ * @related tHeatmap
+ */
+void incrementaHeatmap(tHeatmap *heatmap, int celula);
+/**
+ * @brief Decrementa em 1 o contador, positivo, da celula de indice linear @p celula
+ *
+ * @param heatmap O @ref tHeatmap
+ * @param celula O indice linear da celula
+ * @related tHeatmap
+ */
+void decrementaHeatmap(tHeatmap *heatmap, int celula);
+/**
+ * @brief Adquire o contador da celula de indice linear @p celula
+ *
+ * @param heatmap O @ref tHeatmap
+ * @param celula O indice linear da celula
+ * @return long long O numero de passagens pela celula
+ * @related tHeatmap
+ */
+long long adquireAcessos(const tHeatmap *heatmap, int celula);
+/**
+ * @brief Soma @p qtd ao contador da celula de indice linear @p celula , alargando os contadores se preciso
+ *
+ * @param heatmap O @ref tHeatmap
+ * @param celula O indice linear da celula
+ * @param qtd O valor, nao negativo, a somar
+ * @related tHeatmap
+ */
+void somaAcessos(tHeatmap *heatmap, int celula, long long qtd);
+/**
+ * @brief Passa os contadores do @ref tHeatmap de 32 para 64 bits
+ *
+ * Sem memoria para os novos contadores, o heatmap continua com os de 32 bits e e marcado como incompleto
+ *
+ * @param heatmap O @ref tHeatmap , ainda com contadores de 32 bits
+ * @return int 0 em caso de sucesso; -1, caso falte memoria
+ * @related tHeatmap
+ */
+int alargaHeatmap(tHeatmap *heatmap);
+/**
+ * @brief Libera a memoria de um @ref tHeatmap , desfazendo o mapeamento do seu arquivo, que permanece em disco
+ *
+ * @param heatmap O @ref tHeatmap , podendo ser NULL
+ * @related tHeatmap
+ */
+void liberaHeatmap(tHeatmap *heatmap);
+
+// FIM HEATMAP
+// INTEGRAL
+
+/**
+ * @brief Contem o nome do arquivo de saida para o relatorio de regioes
+ * @related tIntegral
+ */
+#define ARQ_REGI "/regioes.txt"
+/**
+ * @brief Representa a tabela de somas de um heatmap (summed-area table): a soma de qualquer retangulo em tempo constante
+ *
+ * A tabela tem uma linha e uma coluna zeradas a mais, no inicio: somas[i * (mColunas + 1) + j] e a soma
+ * das celulas acima e a esquerda de (i, j), exclusive
+ *
+ */
+typedef struct {
+    int nLinhas; ///< Numero de linhas do heatmap
+    int mColunas; ///< Numero de colunas do heatmap
+    long long *somas; ///< As (nLinhas + 1) x (mColunas + 1) somas
+} tIntegral;
+/**
+ * @brief Representa um retangulo do relatorio de regioes, com os cantos inclusive
+ *
+ */
+typedef struct {
+    int i1; ///< A linha do canto superior esquerdo
+    int j1; ///< A coluna do canto superior esquerdo
+    int i2; ///< A linha do canto inferior direito
+    int j2; ///< A coluna do canto inferior direito
+} tRegiao;
+/**
+ * @brief Representa duas somas vizinhas de uma linha da @ref tIntegral , somadas de uma vez por uma instrucao SIMD
+ *
+ */
+typedef long long tParSomas __attribute__((vector_size(2 * sizeof(long long))));
+/**
+ * @brief Aloca a @ref tIntegral de um heatmap de @p nLinhas x @p mColunas e a constroi a partir do @p heatmap
+ *
+ * @param nLinhas O numero de linhas do heatmap
+ * @param mColunas O numero de colunas do heatmap
+ * @param heatmap O @ref tHeatmap
+ * @return tIntegral* Uma nova instancia de @ref tIntegral que deve ser liberada com @ref liberaIntegral ; NULL, caso falte memoria
+ * @related tIntegral
+ */
+tIntegral *inicializaIntegral(int nLinhas, int mColunas, const tHeatmap *heatmap);
+/**
+ * @brief Reconstroi a @ref tIntegral a partir do @p heatmap , das mesmas dimensoes, numa unica passada
+ *
+ * @param integral A @ref tIntegral
+ * @param heatmap O @ref tHeatmap
+ * @related tIntegral
+ */
+void constroiIntegral(tIntegral *integral, const tHeatmap *heatmap);
+/**
+ * @brief Adquire, em tempo constante, a soma das celulas do retangulo de cantos ( @p i1 , @p j1 ) e ( @p i2 , @p j2 ), inclusive
+ *
+ * @param integral A @ref tIntegral
+ * @param i1 A linha do canto superior esquerdo
+ * @param j1 A coluna do canto superior esquerdo
+ * @param i2 A linha do canto inferior direito
+ * @param j2 A coluna do canto inferior direito
+ * @return long long A soma da parte do retangulo dentro do heatmap; 0 se nao houver
+ * @related tIntegral
+ */
+long long somaRegiao(const tIntegral *integral, int i1, int j1, int i2, int j2);
+/**
+ * @brief Le os retangulos do arquivo @p caminho , um por linha, como "i1 j1 i2 j2"
+ *
+ * @param caminho O caminho do arquivo
+ * @param qtd Recebe o numero de retangulos
+ * @return tRegiao* Os retangulos, que devem ser liberados com free; encerra o programa caso o arquivo nao exista ou seja invalido
+ * @related tIntegral
+ */
+tRegiao *leRegioes(const char caminho[], int *qtd);
+/**
+ * @brief Exporta para @ref ARQ_REGI a soma do @p heatmap em cada uma das @p regioes , a partir de uma @ref tIntegral
+ *
+ * @param nLinhas O numero de linhas do heatmap
+ * @param mColunas O numero de colunas do heatmap
+ * @param heatmap O @ref tHeatmap
+ * @param regioes Os retangulos
+ * @param qtd O numero de retangulos
+ * @param caminhoSaida O diretorio de saida
+ * @related tIntegral
+ */
+void exportaRegioes(int nLinhas, int mColunas, const tHeatmap *heatmap, const tRegiao regioes[], int qtd, char caminhoSaida[]);
+/**
+ * @brief Escreve no arquivo @p arq a soma de cada uma das @p regioes na @ref tIntegral
+ *
+ * @param arq O arquivo de destino
+ * @param integral A @ref tIntegral
+ * @param regioes Os retangulos
+ * @param qtd O numero de retangulos
+ * @related tIntegral
+ */
+void escreveRegioes(FILE *arq, const tIntegral *integral, const tRegiao regioes[], int qtd);
+/**
+ * @brief Libera a memoria de uma @ref tIntegral
+ *
+ * @param integral A @ref tIntegral , podendo ser NULL
+ * @related tIntegral
+ */
+void liberaIntegral(tIntegral *integral);
+
+// FIM INTEGRAL
+// ALEATORIO
+
+/**
+ * @brief Representa um gerador de numeros pseudoaleatorios (xorshift64*) com estado proprio
+ *
+ */
+typedef struct {
+    unsigned long long estado; ///< O estado interno do gerador, nunca nulo
+} tAleatorio;
+/**
+ * @brief Inicializa uma struct do tipo @ref tAleatorio a partir de uma @p semente
+ *
+ * @param semente A semente; sementes distintas geram sequencias distintas
+ * @return tAleatorio Uma nova instancia de @ref tAleatorio
+ * @related tAleatorio
+ */
+tAleatorio inicializaAleatorio(unsigned long long semente);
+/**
+ * @brief Sorteia 64 bits pseudoaleatorios, avancando o @p gerador
+ *
+ * @param gerador O @ref tAleatorio
+ * @return unsigned long long Os bits sorteados
+ * @related tAleatorio
+ */
+unsigned long long sorteiaBits(tAleatorio *gerador);
+/**
+ * @brief Sorteia um inteiro no intervalo [0, @p limite)
+ *
+ * @param gerador O @ref tAleatorio
+ * @param limite O limite superior, exclusivo, positivo
+ * @return int O inteiro sorteado
+ * @related tAleatorio
+ */
+int sorteia(tAleatorio *gerador, int limite);
+
+// FIM ALEATORIO
 // MAPA
 
 /**
  * @brief Contem o tamanho maximo para ambas as dimensoes do mapa
+ *
+ * O mapa fica inteiro em memoria: o indice de @ref tPosicao tem largura fixa ( @ref POS_LARGURA ), e as
+ * matrizes de saida e do servidor sao dimensionadas por este limite. Aumenta-lo exige outra representacao de posicao
+ *
  * @related tMapa
  */
 #define TAM_MAPA 100
@@ -372,6 +832,11 @@ tCobra moveCbr(tCobra cobra, tPosicao pos, char celDevorado);
  * @related tMapa
  */
 #define CEL_VAZIA ' '
+/**
+ * @brief Contem a representacao, nas bordas e fora do mapa, de uma celula que nao pertence a ele
+ * @related tMapa
+ */
+#define CEL_FORA '\0'
 /**
  * @brief Contem a representacao para uma celula de parede no mapa
  * @related tMapa
@@ -438,26 +903,84 @@ tCobra moveCbr(tCobra cobra, tPosicao pos, char celDevorado);
  */
 #define MOV_CBRAH 'a'
 /**
- * @brief Representa o mapa no jogo
+ * @brief Contem o numero maximo de itens, comidas e dinheiros, em um mapa
+ * @related tMapa
+ */
+#define TAM_ITENS (TAM_MAPA * TAM_MAPA)
+/**
+ * @brief Contem a semente fixa das chaves de Zobrist, para que o hash de um estado seja o mesmo em toda execucao
+ * @related tMapa
+ */
+#define MAP_SEM_ZOBRIST 0x5A0B215ULL
+/**
+ * @brief Contem o numero de tuneis que um mapa guarda; com mais, valem os dois ultimos lidos
+ * @related tMapa
+ */
+#define MAP_TUNEIS 2
+/**
+ * @brief Aplica a macro @p GERA a cada lado de tabuleiro quadrado com variante especializada do motor
+ *
+ * As variantes so sao geradas quando o programa e compilado com -DJSR_ESPECIALIZADO; sem elas, todo mapa
+ * usa o motor generico. Nelas, as dimensoes sao constantes: a volta pelas bordas vira uma mascara e o indice
+ * do heatmap, um deslocamento. Tem variantes o movimento ( @ref fazMovimento ), a contabilizacao no heatmap
+ * ( @ref contabilizaRodada ), a volta pelas bordas ( @ref transformaPosicaoValida ) e o passo do @ref tLote ;
+ * cada uma escolhe a sua pelo lado de @ref escolheLado , guardado no @ref tMapa
+ *
+ * @related tMapa
+ */
+#ifdef JSR_ESPECIALIZADO
+#define MAP_LADOS(GERA) GERA(16) GERA(32) GERA(64)
+#else
+#define MAP_LADOS(GERA)
+#endif
+/**
+ * @brief Representa os dados imutaveis do mapa no jogo, lidos uma unica vez e compartilhados por referencia
+ * 
+ * As matrizes por celula ficam no mesmo bloco alocado, logo apos a struct, e tem o tamanho do tabuleiro
+ * lido: as linhas de -1 a nLinhas do indice de @ref tPosicao e nLinhas x mColunas itens. Um mapa pequeno
+ * ocupa so alguns KB, nao o pior caso de @ref TAM_MAPA x @ref TAM_MAPA , e continua liberado com um free
  * 
  */
 typedef struct {
     int nLinhas; ///< Numero de linhas que o mapa possui
     int mColunas; ///< Numero de colunas que o mapa possui
-    char vet[TAM_MAPA][TAM_MAPA]; ///< A matriz bidimensional de dimensoes nLinhas x mColunas que contem o mapa
-    tCobra cobra; ///< A cobra que esta no mapa
+    int lado; ///< O lado da variante especializada do motor que atende o mapa, de @ref MAP_LADOS ; 0 para o motor generico
+    char *vet; ///< O mapa inicial sem a cobra, indexado por @ref tPosicao ; @ref CEL_FORA fora de nLinhas x mColunas
+    tCobra cobra; ///< A cobra na sua posicao inicial, so com a cabeca; cada @ref tPartida copia-a para um corpo proprio
     tFila tuneis; ///< A dupla de tuneis que pode estar no mapa
-    int qtdComida; ///< A quatidade de comidas que resta no mapa
-    int heatmap[TAM_MAPA][TAM_MAPA]; ///< O heatmap de posicoes no mapa. Representa as posicoes do mapa pelo numero de acessos da cobra
+    int qtdComida; ///< A quantidade inicial de comidas no mapa
+    int qtdItens; ///< A quantidade de comidas e dinheiros no mapa inicial
+    tPosicao *itens; ///< As posicoes das comidas e dinheiros, na ordem de leitura
+    int *itemDaCelula; ///< O indice em itens de cada celula, por @ref tPosicao ; -1 para celulas sem item
+    unsigned long long *chaveCorpo; ///< A chave de Zobrist de uma celula ocupada pela cobra, por @ref tPosicao
+    unsigned long long *chaveCabeca; ///< A chave de Zobrist da cabeca em cada celula, por @ref tPosicao
+    unsigned long long chaveDirecao[4]; ///< A chave de Zobrist de cada direcao da cabeca
+    unsigned long long *chaveItem; ///< A chave de Zobrist de cada item ainda nao devorado
+    char *itemInalcancavel; ///< Verdadeiro, por item, para a comida que a cobra nunca pode alcancar; veja @ref analisaAlcance
+    int qtdComidaInalcancavel; ///< A quantidade de comidas com itemInalcancavel
 } tMapa;
+/**
+ * @brief Falha a compilacao caso o maior mapa, com as bordas, deixe de caber no indice de @ref tPosicao
+ *
+ */
+typedef char tMapaCabeNaPosicao[POS_LARGURA == TAM_MAPA + 2 ? 1 : -1];
 /**
  * @brief Le um mapa no arquivo @ref ARQ_MAPA dentro do diretorio @p caminhoBase informado
  * 
  * @param caminhoBase O diretorio onde deve estar o arquivo que contem o mapa a ser lido
- * @return tMapa Uma nova instancia de @ref tMapa baseada no arquivo lido
+ * @return tMapa* Uma nova instancia de @ref tMapa baseada no arquivo lido, que deve ser liberada com free
+ * @related tMapa
+ */
+tMapa *leMapa(char caminhoBase[]);
+/**
+ * @brief Le um mapa, no formato do arquivo @ref ARQ_MAPA , do arquivo ja aberto @p arq
+ * 
+ * @param arq O arquivo, posicionado no inicio do mapa
+ * @return tMapa* Uma nova instancia de @ref tMapa , que deve ser liberada com free; NULL, caso as dimensoes sejam invalidas,
+ * nao haja cobra ou falte memoria
  * @related tMapa
  */
-tMapa leMapa(char caminhoBase[]);
+tMapa *leMapaArquivo(FILE *arq);
 /**
  * @brief Adquire a quandidade de linhas do @ref tMapa @p mapa
  * 
@@ -465,7 +988,7 @@ tMapa leMapa(char caminhoBase[]);
  * @return int A quantidade total de linhas do @p tMapa
  * @related tMapa
  */
-int adquireLinhas(tMapa mapa);
+int adquireLinhas(const tMapa *mapa);
 /**
  * @brief Adquire a quandidade de colunas do @ref tMapa @p mapa
  * 
@@ -473,41 +996,63 @@ int adquireLinhas(tMapa mapa);
  * @return int A quantidade total de colunas do @p tMapa
  * @related tMapa
  */
-int adquireColunas(tMapa mapa);
+int adquireColunas(const tMapa *mapa);
 /**
- * @brief Adquire a cobra no @ref tMapa @p mapa
+ * @brief Adquire a cobra na posicao inicial do @ref tMapa @p mapa
  * 
  * @param mapa O @ref tMapa
- * @return int A cobra do @p tMapa
+ * @return const tCobra* A cobra inicial do @p tMapa
  * @related tMapa
  */
-tCobra adquireCobra(tMapa mapa);
+const tCobra *adquireCobraInicial(const tMapa *mapa);
 /**
- * @brief Adquire a quandidade de comida restante no @ref tMapa @p mapa
+ * @brief Adquire a quandidade inicial de comida no @ref tMapa @p mapa
  * 
  * @param mapa O @ref tMapa
- * @return int A quantidade comida restante do @p tMapa
+ * @return int A quantidade inicial de comida do @p tMapa
  * @related tMapa
  */
-int adquireQtdComida(tMapa mapa);
+int adquireQtdComidaInicial(const tMapa *mapa);
 /**
- * @brief Adquire a celula do @ref tMapa @p mapa na @ref tPosicao @p pos
+ * @brief Adquire a celula do @ref tMapa @p mapa na @ref tPosicao @p pos , como era no inicio do jogo e sem a cobra
  * 
  * @param mapa O @ref tMapa
  * @param pos A @ref tPosicao onde esta a celula a ser adquirida
- * @return int A celula localizada na @p tPos dentro do @p tMapa
+ * @return char A celula localizada na @p tPos dentro do @p tMapa
  * @related tMapa
  */
-char adquireCel(tMapa mapa, tPosicao pos);
+char adquireCel(const tMapa *mapa, tPosicao pos);
 /**
- * @brief Define a celula do @ref tMapa @p mapa na @ref tPosicao @p pos como @p cel
+ * @brief Adquire o indice do item, comida ou dinheiro, do @ref tMapa @p mapa na @ref tPosicao @p pos
  * 
  * @param mapa O @ref tMapa
- * @param pos A @ref tPosicao onde esta a celula a ser adquirida
- * @return int A celula localizada na @p tPos dentro do @p tMapa
+ * @param pos A @ref tPosicao
+ * @return int O indice do item em itens; -1, caso a celula nao tenha item
+ * @related tMapa
+ */
+int adquireItem(const tMapa *mapa, tPosicao pos);
+/**
+ * @brief Adquire o indice denso, i * mColunas + j, da @ref tPosicao @p pos no @ref tMapa @p mapa
+ * 
+ * E o indice do heatmap, das @ref tSujas e do @ref tInfinito , cujo leiaute segue o dos arquivos exportados
+ * 
+ * @param mapa O @ref tMapa
+ * @param pos A @ref tPosicao , dentro dos limites do @p mapa
+ * @return int O indice denso da celula, de 0 a nLinhas * mColunas - 1
+ * @related tMapa
+ */
+int adquireCelula(const tMapa *mapa, tPosicao pos);
+/**
+ * @brief Adquire o indice denso da celula em @p pos como @ref adquireCelula , num mapa de @p mColunas colunas
+ * 
+ * Sempre expandida no chamador, para que as variantes de @ref MAP_LADOS a compilem com dimensoes constantes
+ * 
+ * @param pos A @ref tPosicao , dentro dos limites do mapa
+ * @param mColunas O numero de colunas do mapa
+ * @return int O indice denso da celula
  * @related tMapa
  */
-tMapa defineCel(tMapa mapa, tPosicao pos, char cel);
+__inline__ int adquireCelulaDimensoes(tPosicao pos, unsigned int mColunas) __attribute__((always_inline));
 /**
  * @brief Adquire o par do tunel no @ref tMapa @p mapa na @ref tPosicao @p pos
  * 
@@ -516,7 +1061,7 @@ tMapa defineCel(tMapa mapa, tPosicao pos, char cel);
  * @return tPosicao O par do tunel em @p pos no @p tMapa
  * @related tMapa
  */
-tPosicao adquireParTunel(tMapa mapa, tPosicao pos);
+tPosicao adquireParTunel(const tMapa *mapa, tPosicao pos);
 /**
  * @brief Verifica se a @ref tPosicao @p pos esta dentro do @ref tMapa @p mapa
  * 
@@ -525,7 +1070,7 @@ tPosicao adquireParTunel(tMapa mapa, tPosicao pos);
  * @return int Verdadeiro, se @p pos esta dentros dos limites do @p mapa ; caso contrario, falso
  * @related tMapa
  */
-int estaDentroLimite(tMapa mapa, tPosicao pos);
+int estaDentroLimite(const tMapa *mapa, tPosicao pos);
 /**
  * @brief Verifica se a @ref tPosicao @p pos eh valida dentro do @ref tMapa @p mapa
  * 
@@ -534,695 +1079,7925 @@ int estaDentroLimite(tMapa mapa, tPosicao pos);
  * @return int Verdadeiro, caso @p pos seja valida; caso contrario, falso
  * @related tMapa
  */
-int ehPosicaoValida(tMapa mapa, tPosicao pos);
+int ehPosicaoValida(const tMapa *mapa, tPosicao pos);
 /**
  * @brief Transforma a @ref tPosicao @p pos em sua respectiva posicao equivalente
  * 
  * @param mapa O @ref tMapa
- * @param posicao A @ref tPosicao a ser transformada
+ * @param pos A @ref tPosicao a ser transformada
+ * @param direcao A direcao com a qual a cobra atravessa um eventual tunel
  * @return tPosicao A posicao equivalente e valida a @p pos ; caso @p pos seja valida, retorna ela mesma
  * @related tMapa
  */
-tPosicao transformaPosicaoValida(tMapa mapa, tPosicao posicao);
+tPosicao transformaPosicaoValida(const tMapa *mapa, tPosicao pos, int direcao);
 /**
- * @brief Executa o @p movimento da @ref tCobra no @ref tMapa @p mapa
+ * @brief Transforma a @ref tPosicao @p pos como @ref transformaPosicaoValida , num mapa de @p nLinhas x @p mColunas
  * 
- * @param mapa O @ref tMapa
- * @param movimento O movimento a ser efetuado
- * @return tMapa O @ref tMapa com o movimento executado
+ * Sempre expandida no chamador, para que as variantes de @ref MAP_LADOS a compilem com dimensoes constantes
+ * 
+ * @param mapa O @ref tMapa , com as dimensoes @p nLinhas x @p mColunas
+ * @param pos A @ref tPosicao a ser transformada
+ * @param direcao A direcao com a qual a cobra atravessa um eventual tunel
+ * @param nLinhas O numero de linhas do @p mapa
+ * @param mColunas O numero de colunas do @p mapa
+ * @return tPosicao A posicao equivalente e valida a @p pos
  * @related tMapa
  */
-tMapa fazMovimento(tMapa mapa, char movimento);
+__inline__ tPosicao transformaPosicaoDimensoes(const tMapa *mapa, tPosicao pos, int direcao, unsigned int nLinhas, unsigned int mColunas) __attribute__((always_inline));
 /**
- * @brief Limpa o @ref tMapa @p mapa de elementos dinamicos, no caso sua @ref tCobra
- * 
- * @param mapa O @ref tMapa
- * @return tMapa O @ref tMapa sem elementos dinamicos em suas celulas
+ * @brief Declara a variante de @ref transformaPosicaoValida para o mapa de lado @p L , gerada por @ref MAP_DEFINE_TRANSFORMA
  * @related tMapa
  */
-tMapa limpaMapa(tMapa mapa);
+#define MAP_DECLARA_TRANSFORMA(L) tPosicao transformaPosicao##L(const tMapa *mapa, tPosicao pos, int direcao);
 /**
- * @brief Atualiza o @ref tMapa @p mapa com os elementos dinamicos, no caso sua @ref tCobra
- * 
- * @param mapa O @ref tMapa
- * @return tMapa O @ref tMapa com os elementos dinamicos em suas celulas
+ * @brief Define a variante de @ref transformaPosicaoValida para o mapa de lado @p L
  * @related tMapa
  */
-tMapa atualizaMapa(tMapa mapa);
+#define MAP_DEFINE_TRANSFORMA(L) \
+    tPosicao transformaPosicao##L(const tMapa *mapa, tPosicao pos, int direcao) { \
+        return transformaPosicaoDimensoes(mapa, pos, direcao, L, L); \
+    }
+MAP_LADOS(MAP_DECLARA_TRANSFORMA)
 /**
- * @brief Exporta o heatmap do @ref tMapa @p mapa para o arquivo @ref ARQ_HMAP no diretorio @p caminhoBase
+ * @brief Escolhe a variante especializada do motor para um mapa de @p nLinhas x @p mColunas
  * 
- * @param mapa O @ref tMapa
- * @param caminhoBase O diretorio para onde sera salvo o heatmap
+ * @param nLinhas O numero de linhas do mapa
+ * @param mColunas O numero de colunas do mapa
+ * @return int O lado da variante, de @ref MAP_LADOS ; 0, caso o mapa use o motor generico
  * @related tMapa
  */
-void exportaHeatmap(tMapa mapa, char caminhoBase[]);
+int escolheLado(int nLinhas, int mColunas);
 /**
- * @brief Exporta o ranking do @ref tMapa @p mapa para o arquivo @ref ARQ_RANK no diretorio @p caminhoBase
+ * @brief Marca, no @ref tMapa @p mapa recem lido, as comidas que a cobra nunca pode alcancar
  * 
- * @param mapa O @ref tMapa
- * @param caminhoBase O diretorio para onde sera salvo o ranking
+ * Faz uma busca em largura a partir da cabeca inicial por todas as celulas que nao sao parede, nas quatro
+ * direcoes, com a volta pelas bordas e os tuneis de @ref transformaPosicaoValida . Como ignora o corpo
+ * e a proibicao de voltar, a busca alcanca ao menos tudo o que a cobra alcanca: a comida fora dela nunca
+ * sera devorada, e o jogo que so tem essa comida restante nao pode mais ser vencido
+ * 
+ * @param mapa O @ref tMapa , com as celulas, os itens e a cobra inicial ja lidos
  * @related tMapa
  */
-void exportaRanking(tMapa mapa, char caminhoBase[]);
+void analisaAlcance(tMapa *mapa);
 /**
- * @brief Imprime o @ref tMapa @p mapa para a saida padrao
+ * @brief Calcula a direcao resultante de aplicar o @p movimento a @p direcao
  * 
- * @param mapa O @ref tMapa
+ * @param direcao A direcao atual, como @ref CBR_DIR_N
+ * @param movimento O movimento - como @ref MOV_CBRCT , @ref MOV_CBRHO e @ref MOV_CBRAH
+ * @return int A nova direcao
  * @related tMapa
  */
-void imprimeMapa(tMapa mapa);
-
-// FIM MAPA
-// ESTATISTICAS
-
-/**
- * @brief Contem o nome do arquivo de saida para a exportacao das estatisticas
- * @related tEstatisticas
- */
-#define ARQ_STTS "estatisticas.txt"
-/**
- * @brief Representa as estatisticas do jogo
- * @related tEstatisticas
- */
-typedef struct {
-    int qtdMov; ///< A quantidade de movimentos efetuados
-    int qtdNPntMov; ///< A quantidade de movimentos efetuados que nao pontuaram
-    int qtdMovC; ///< A quantidade de movimentos para cima
-    int qtdMovD; ///< A quantidade de movimentos para a direita
-    int qtdMovB; ///< A quantidade de movimentos para baixo
-    int qtdMovE; ///< A quantidade de movimentos para a esquerda
-} tEstatisticas;
+int giraDirecao(int direcao, char movimento);
 /**
- * @brief Inicializa uma struct do tipo @ref tEstatisticas
+ * @brief Exporta o @p heatmap de um mapa @p nLinhas x @p mColunas para o arquivo @ref ARQ_HMAP no diretorio @p caminhoBase
  * 
- * @return tEstatisticas Uma nova instancia de @ref tEstatisticas
- * @related tEstatisticas
+ * @param nLinhas O numero de linhas do mapa
+ * @param mColunas O numero de colunas do mapa
+ * @param heatmap O @ref tHeatmap
+ * @param caminhoBase O diretorio para onde sera salvo o heatmap
+ * @return int 0 em caso de sucesso; -1, caso o arquivo nao possa ser aberto
+ * @related tMapa
  */
-tEstatisticas inicializaEstatisticas();
+int exportaHeatmap(int nLinhas, int mColunas, const tHeatmap *heatmap, char caminhoBase[]);
 /**
- * @brief Adquire a quantidade de movimentos efetuados da @ref tEstatisticas @p estatisticas
+ * @brief Escreve o @p heatmap de um mapa @p nLinhas x @p mColunas no arquivo @p arq , no formato de @ref ARQ_HMAP
  * 
- * @param estatisticas A @ref tEstatisticas
- * @return int A quantidade de movimentos efetuados
- * @related tEstatisticas
+ * @param arq O arquivo
+ * @param nLinhas O numero de linhas do mapa
+ * @param mColunas O numero de colunas do mapa
+ * @param heatmap O @ref tHeatmap
+ * @related tMapa
  */
-int adquireQtdMovimentos(tEstatisticas estatisticas);
+void escreveHeatmap(FILE *arq, int nLinhas, int mColunas, const tHeatmap *heatmap);
 /**
- * @brief Atualiza as @ref tEstatisticas @p estatisticas baseado no movimento efetuado pela @ref tCobra @p cobra
+ * @brief Exporta o ranking do @p heatmap de um mapa @p nLinhas x @p mColunas para o arquivo @ref ARQ_RANK no diretorio @p caminhoBase
  * 
- * @param estatisticas A @ref tEstatisticas
- * @param cobra A @ref tCobra
- * @return tEstatisticas O novo estado atualizado da @p estatisticas
- * @related tEstatisticas
+ * @param nLinhas O numero de linhas do mapa
+ * @param mColunas O numero de colunas do mapa
+ * @param heatmap O @ref tHeatmap
+ * @param caminhoBase O diretorio para onde sera salvo o ranking
+ * @return int 0 em caso de sucesso; -1, caso o arquivo nao possa ser aberto
+ * @related tMapa
  */
-tEstatisticas atualizaEstatisticas(tEstatisticas estatisticas, tCobra cobra);
+int exportaRanking(int nLinhas, int mColunas, const tHeatmap *heatmap, char caminhoBase[]);
 /**
- * @brief Exporta a @ref tEstatisticas @p estatisticas para o arquivo @ref ARQ_STTS no diretorio @p caminhoBase
+ * @brief Escreve o ranking do @p heatmap de um mapa @p nLinhas x @p mColunas no arquivo @p arq , no formato de @ref ARQ_RANK
  * 
- * @param estatisticas A @ref tEstatisticas
- * @param caminhoBase O diretorio para onde sera salvo a @p estatisticas
- * @related tEstatisticas
+ * @param arq O arquivo
+ * @param nLinhas O numero de linhas do mapa
+ * @param mColunas O numero de colunas do mapa
+ * @param heatmap O @ref tHeatmap
+ * @related tMapa
  */
-void exportaEstatisticas(tEstatisticas estatisticas, char caminhoBase[]);
+void escreveRanking(FILE *arq, int nLinhas, int mColunas, const tHeatmap *heatmap);
 
-// FIM ESTATISTICAS
-// JOGO
+// FIM MAPA
+// INFINITO
 
 /**
- * @brief Contem a quantidade de pontos que valem as celulas @ref CEL_DINHR
- * @related tJogo
+ * @brief Representa o modo infinito de uma partida: cada comida devorada renasce numa celula vazia sorteada
+ *
+ * As celulas vazias formam um conjunto indexado - um vetor denso e a posicao de cada celula nele -
+ * atualizado a cada passo da cabeca e da cauda, de modo que o sorteio e O(1) mesmo com o tabuleiro quase
+ * cheio. As comidas renascidas nao entram no hash de Zobrist da partida
+ *
  */
-#define JOG_PNT_D 10
+typedef struct {
+    tAleatorio gerador; ///< O gerador que sorteia as celulas das comidas renascidas
+    int qtdLivres; ///< Quantas celulas estao vazias no momento
+    int *livres; ///< As celulas vazias, pelo indice linear (i * mColunas + j), nas qtdLivres primeiras posicoes
+    int *posicaoLivre; ///< A posicao de cada celula, pelo indice linear, em livres; -1 para celulas ocupadas
+    char *comida; ///< Se cada celula, pelo indice linear, tem uma comida renascida
+    int renascida; ///< A celula da comida renascida pelo ultimo movimento que devorou comida; -1 se nao havia celula vazia
+} tInfinito;
 /**
- * @brief Contem a quantidade de pontos que valem as celulas @ref CEL_COMID
- * @related tJogo
+ * @brief Aloca um @ref tInfinito para o inicio do jogo no @ref tMapa @p mapa
+ *
+ * @param mapa O @ref tMapa
+ * @param semente A semente do sorteio das comidas renascidas
+ * @return tInfinito* Uma nova instancia de @ref tInfinito , com as celulas vazias do mapa inicial fora da cobra,
+ * que deve ser liberada com @ref liberaInfinito ; NULL, caso falte memoria
+ * @related tInfinito
  */
-#define JOG_PNT_C 1
+tInfinito *inicializaInfinito(const tMapa *mapa, unsigned long long semente);
 /**
- * @brief Contem a representacao para o estado continua do jogo
- * @related tJogo
+ * @brief Retira a celula de indice linear @p celula do conjunto de celulas vazias, caso esteja nele
+ *
+ * @param infinito O @ref tInfinito
+ * @param celula O indice linear da celula
+ * @related tInfinito
  */
-#define JOG_EST_C 0
+void ocupaCelula(tInfinito *infinito, int celula);
 /**
- * @brief Contem a representacao para o estado vitoria do jogo
- * @related tJogo
+ * @brief Poe a celula de indice linear @p celula no conjunto de celulas vazias, caso nao esteja nele
+ *
+ * @param infinito O @ref tInfinito
+ * @param celula O indice linear da celula, que deve estar vazia
+ * @related tInfinito
  */
-#define JOG_EST_V 1
+void desocupaCelula(tInfinito *infinito, int celula);
 /**
- * @brief Contem a representacao para o estado derrota do jogo
- * @related tJogo
+ * @brief Verifica se a celula de indice linear @p celula tem uma comida renascida
+ *
+ * @param infinito O @ref tInfinito
+ * @param celula O indice linear da celula
+ * @return int Verdadeiro, caso tenha; do contrario, falso
+ * @related tInfinito
  */
-#define JOG_EST_D 2
+int temComidaRenascida(const tInfinito *infinito, int celula);
 /**
- * @brief Contem o diretorio de saida para os arquivos
- * @related tJogo
+ * @brief Remove a comida renascida da celula de indice linear @p celula , devorada pela cobra
+ *
+ * @param infinito O @ref tInfinito
+ * @param celula O indice linear da celula
+ * @related tInfinito
  */
-#define DIR_SAID "/saida/"
+void devoraComidaRenascida(tInfinito *infinito, int celula);
 /**
- * @brief Contem o nome do arquivo de saida para a exportacao da inicializacao
- * @related tJogo
+ * @brief Sorteia uniformemente uma celula vazia e faz renascer nela uma comida
+ *
+ * @param infinito O @ref tInfinito
+ * @return int O indice linear da celula sorteada; -1, caso nao haja celula vazia
+ * @related tInfinito
  */
-#define ARQ_INIC "/inicializacao.txt"
+int renasceComida(tInfinito *infinito);
 /**
- * @brief Contem o nome do arquivo de saida para a exportacao do resumo
- * @related tJogo
+ * @brief Libera a memoria de um @ref tInfinito
+ *
+ * @param infinito O @ref tInfinito , podendo ser NULL
+ * @related tInfinito
  */
-#define ARQ_RESM "/resumo.txt"
+void liberaInfinito(tInfinito *infinito);
+
+// FIM INFINITO
+// PARTIDA
+
 /**
- * @brief Representa o jogo snake
+ * @brief Contem o numero de palavras do conjunto de bits de itens devorados
+ * @related tPartida
+ */
+#define PAR_PALAVRAS ((TAM_ITENS + 63) / 64)
+/**
+ * @brief Representa o estado dinamico de um jogo sobre um @ref tMapa : tudo o que um movimento altera, exceto o heatmap
+ * 
+ * O tabuleiro nao e copiado: comidas e dinheiros sao um conjunto de bits sobre os itens do @ref tMapa ,
+ * e as celulas da cobra sao desenhadas apenas para impressao
  * 
  */
 typedef struct {
-    tMapa mapa; ///< O mapa
-    int pontuacao; ///< A pontuacao atual
+    tCobra cobra; ///< A cobra, cujo corpo, alocado pela propria @ref tPartida , comporta nLinhas x mColunas partes
+    int qtdComida; ///< A quantidade de comidas que resta no mapa
+    long long pontuacao; ///< A pontuacao atual
     int estado; ///< O estado atual do jogo que pode ser @ref JOG_EST_C , @ref JOG_EST_V ou @ref JOG_EST_D
-    tEstatisticas estatisticas; ///< As estatisticas do jogo
-    char caminhoSaida[TAM_CAMINHO]; ///< O caminho de saida para os arquivos do jogo
-} tJogo;
+    unsigned long long hash; ///< O hash de Zobrist da cabeca, direcao, corpo e itens restantes, mantido a cada movimento
+    unsigned long long consumidos[PAR_PALAVRAS]; ///< Os bits dos itens do @ref tMapa ja devorados; so as (qtdItens + 63) / 64 primeiras palavras sao usadas
+    tInfinito *infinito; ///< O modo infinito, em que a comida devorada renasce; NULL fora dele
+} tPartida;
 /**
- * @brief Inicializa uma struct do tipo @ref tJogo no diretorio @p caminhoBase
+ * @brief Inicializa uma struct do tipo @ref tPartida no inicio do jogo sobre o @ref tMapa @p mapa
  * 
- * @param caminhoBase O diretorio onde o jogo ocorre e todos os seus dados estao
- * @return tJogo Uma nova instancia de @ref tJogo
- * @related tJogo
+ * @param mapa O @ref tMapa
+ * @return tPartida Uma nova instancia de @ref tPartida , que deve ser liberada com @ref liberaPartida ;
+ * sem memoria para o corpo da cobra, com o buffer do corpo NULL
+ * @related tPartida
  */
-tJogo inicializaJogo(char caminhoBase[]);
+tPartida inicializaPartida(const tMapa *mapa);
 /**
- * @brief Verifica se o jogo terminou ou nao
+ * @brief Libera o corpo da cobra da @ref tPartida @p partida , alocado por @ref inicializaPartida
  * 
- * @param jogo O @ref tJogo
- * @return int Verdadeiro, se o jogo acabou; do contrario, falso
- * @related tJogo
+ * @param partida A @ref tPartida
+ * @related tPartida
  */
-int acabou(tJogo jogo);
+void liberaPartida(tPartida *partida);
 /**
- * @brief Efetua a rodada do @ref tJogo @p jogo com o @p movimento
+ * @brief Copia a @ref tPartida @p origem para @p destino , copiando apenas o corpo ocupado da cobra e as palavras usadas de consumidos
  * 
- * @param jogo O @ref tJogo
- * @param movimento O movimento que sera feito na rodada
- * @return tJogo O novo estado do @p jogo ao fim da rodada
- * @related tJogo
+ * A copia fica fora do modo infinito, cujo estado nao e compartilhado
+ * 
+ * @param mapa O @ref tMapa da partida
+ * @param destino A @ref tPartida que recebera a copia, ja inicializada com @ref inicializaPartida , cujo corpo e mantido
+ * @param origem A @ref tPartida copiada
+ * @related tPartida
  */
-tJogo fazRodada(tJogo jogo, char movimento);
+void clonaPartida(const tMapa *mapa, tPartida *destino, const tPartida *origem);
 /**
- * @brief Exporta o arquivo de inicializacao do @ref tJogo para o arquivo @ref ARQ_INIC
+ * @brief Adquire a cobra da @ref tPartida @p partida
  * 
- * @param jogo O @ref tJogo
- * @related tJogo
+ * @param partida A @ref tPartida
+ * @return const tCobra* A cobra da @p partida
+ * @related tPartida
  */
-void exportaInicializacao(tJogo jogo);
+const tCobra *adquireCobra(const tPartida *partida);
 /**
- * @brief Exporta o resumo do evento ocorrido no @ref tJogo @p jogo com o @p movimento para o arquivo @ref ARQ_RESM
+ * @brief Adquire a quandidade de comida restante na @ref tPartida @p partida
  * 
- * @param jogo O @ref tJogo
- * @param currMov A numero desse movimento
- * @param cobra A @ref tCobra do jogo
- * @param movimento O movimento efetuado - como @ref MOV_CBRCT , @ref MOV_CBRHO e @ref MOV_CBRAH
- * @related tJogo
+ * @param partida A @ref tPartida
+ * @return int A quantidade comida restante no mapa
+ * @related tPartida
  */
-void exportaResumo(tJogo jogo, int currMov, tCobra cobra, char movimento);
+int adquireQtdComida(const tPartida *partida);
 /**
- * @brief Exporta todos os dados do jogo - como o heatmap, estatisticas e ranking
+ * @brief Adquire o hash de Zobrist da @ref tPartida @p partida
  * 
- * @param jogo O @ref tJogo
- * @related tJogo
+ * Partidas com a mesma cabeca, direcao, celulas do corpo e itens restantes tem o mesmo hash; serve para
+ * tabelas de transposicao, deteccao de ciclos e descarte de estados repetidos
+ * 
+ * @param partida A @ref tPartida
+ * @return unsigned long long O hash, mantido em O(1) por @ref fazMovimento
+ * @related tPartida
  */
-void exportaJogo(tJogo jogo);
+unsigned long long adquireHash(const tPartida *partida);
 /**
- * @brief Imprime o @ref tJogo @p jogo para a saida padrao
+ * @brief Calcula do zero o hash de Zobrist da @ref tPartida @p partida , percorrendo o corpo e os itens
  * 
- * @param jogo O @ref tJogo
- * @related tJogo
+ * @param mapa O @ref tMapa
+ * @param partida A @ref tPartida
+ * @return unsigned long long O hash, igual ao mantido por @ref fazMovimento
+ * @related tPartida
  */
-void imprimeJogo(tJogo jogo);
-
-// FIM JOGO
-
-int main(int argc, char const *argv[]) {
-    if (argc <= 1) {
-        printf("%s\n", "ERRO: O diretorio de arquivos de configuracao nao foi informado");
-        return EXIT_FAILURE;
+unsigned long long calculaHash(const tMapa *mapa, const tPartida *partida);
+/**
+ * @brief Verifica se o item de indice @p item do @ref tMapa ja foi devorado na @ref tPartida @p partida
+ * 
+ * @param partida A @ref tPartida
+ * @param item O indice do item
+ * @return int Verdadeiro, caso o item ja tenha sido devorado; do contrario, falso
+ * @related tPartida
+ */
+int foiConsumido(const tPartida *partida, int item);
+/**
+ * @brief Verifica, em O(1), se toda a comida restante na @ref tPartida @p partida e inalcancavel ( @ref analisaAlcance )
+ * 
+ * A comida inalcancavel nunca e devorada, entao basta comparar as quantidades; no modo infinito a comida
+ * renasce, e a verificacao nao se aplica
+ * 
+ * @param mapa O @ref tMapa
+ * @param partida A @ref tPartida
+ * @return int Verdadeiro, caso reste comida e nenhuma possa ser alcancada, ou seja, o jogo nao possa mais ser vencido
+ * @related tPartida
+ */
+int restaSoInalcancavel(const tMapa *mapa, const tPartida *partida);
+/**
+ * @brief Adquire a celula na @ref tPosicao @p pos como a cobra a encontra: a do @ref tMapa , com os itens ja devorados vazios
+ * 
+ * @param mapa O @ref tMapa
+ * @param partida A @ref tPartida
+ * @param pos A @ref tPosicao
+ * @return char A celula, sem considerar a propria cobra
+ * @related tPartida
+ */
+char adquireCelPartida(const tMapa *mapa, const tPartida *partida, tPosicao pos);
+/**
+ * @brief Executa o @p movimento da @ref tCobra na @ref tPartida @p partida , atualizando pontuacao e estado
+ * 
+ * @param mapa O @ref tMapa
+ * @param partida A @ref tPartida que sera alterada
+ * @param movimento O movimento a ser efetuado
+ * @related tPartida
+ */
+void fazMovimento(const tMapa *mapa, tPartida *partida, char movimento);
+/**
+ * @brief Executa o @p movimento como @ref fazMovimento , num mapa de @p nLinhas x @p mColunas
+ * 
+ * Sempre expandida no chamador, para que as variantes de @ref MAP_LADOS a compilem com dimensoes constantes
+ * 
+ * @param mapa O @ref tMapa , com as dimensoes @p nLinhas x @p mColunas
+ * @param partida A @ref tPartida que sera alterada
+ * @param movimento O movimento a ser efetuado
+ * @param nLinhas O numero de linhas do @p mapa
+ * @param mColunas O numero de colunas do @p mapa
+ * @related tPartida
+ */
+__inline__ void fazMovimentoDimensoes(const tMapa *mapa, tPartida *partida, char movimento, unsigned int nLinhas, unsigned int mColunas) __attribute__((always_inline));
+/**
+ * @brief Declara a variante de @ref fazMovimento para o mapa de lado @p L , gerada por @ref PAR_DEFINE_MOVIMENTO
+ * @related tPartida
+ */
+#define PAR_DECLARA_MOVIMENTO(L) void fazMovimento##L(const tMapa *mapa, tPartida *partida, char movimento);
+/**
+ * @brief Define a variante de @ref fazMovimento para o mapa de lado @p L
+ * @related tPartida
+ */
+#define PAR_DEFINE_MOVIMENTO(L) \
+    void fazMovimento##L(const tMapa *mapa, tPartida *partida, char movimento) { \
+        fazMovimentoDimensoes(mapa, partida, movimento, L, L); \
     }
-    
-    char caminhoBase[TAM_CAMINHO];
-    strcpy(caminhoBase, argv[1]);
-    
-    tJogo jogo = inicializaJogo(caminhoBase);
-    
-    exportaInicializacao(jogo);
-    do {
-        char movimento;
-        scanf("%c%*c", &movimento);
-        
-        jogo = fazRodada(jogo, movimento);
-
-        printf("%c", '\n');
-        printf("Estado do jogo apos o movimento '%c':\n", movimento);
-        imprimeJogo(jogo);
-    } while (!acabou(jogo));
-
-    exportaJogo(jogo);
-
-    return EXIT_SUCCESS;
-}
-
-// JOGO
-tJogo inicializaJogo(char caminhoBase[]) {
-    tMapa mapa = leMapa(caminhoBase);
-    tEstatisticas estatisticas = inicializaEstatisticas();
-
-    tJogo jogo = { mapa, 0, 0, estatisticas };
+MAP_LADOS(PAR_DECLARA_MOVIMENTO)
+/**
+ * @brief Move a cobra da @ref tPartida para @p posDest na @p direcao , atualizando corpo, itens devorados e hash
+ * 
+ * Nao atualiza pontuacao, comida restante nem estado da partida; veja @ref pontuaPartida
+ * 
+ * @param mapa O @ref tMapa
+ * @param partida A @ref tPartida que sera alterada
+ * @param direcao A nova direcao da cabeca
+ * @param posDest A celula valida para onde a cabeca vai, como devolvida por @ref transformaPosicaoValida
+ * @return char A celula devorada
+ * @related tPartida
+ */
+char moveNaPartida(const tMapa *mapa, tPartida *partida, int direcao, tPosicao posDest);
+/**
+ * @brief Atualiza pontuacao, comida restante e estado da @ref tPartida depois de a cobra devorar @p devorado
+ * 
+ * @param partida A @ref tPartida que sera alterada
+ * @param devorado A celula devorada, devolvida por @ref moveNaPartida
+ * @related tPartida
+ */
+void pontuaPartida(tPartida *partida, char devorado);
+/**
+ * @brief Representa o registro compacto de um movimento, suficiente para desfaze-lo em O(1)
+ * 
+ */
+typedef struct {
+    tPosicao cauda; ///< A celula da cauda que saiu do corpo; ignorada caso a cobra tenha crescido
+    int celula; ///< A celula do heatmap tocada pela cabeca, indexada por i * mColunas + j
+    short deltaPontuacao; ///< Os pontos ganhos no movimento
+    char devorado; ///< A celula devorada no movimento
+    char devoradoAnterior; ///< A ultima celula devorada pela cobra antes do movimento
+    char direcaoAnterior; ///< A direcao da cabeca antes do movimento
+    char estadoAnterior; ///< O estado da partida antes do movimento
+    char cresceu; ///< Se a cobra cresceu no movimento
+} tRegistro;
+/**
+ * @brief Executa o @p movimento como @ref fazMovimento e devolve o @ref tRegistro que permite desfaze-lo
+ * 
+ * @param mapa O @ref tMapa
+ * @param partida A @ref tPartida que sera alterada
+ * @param movimento O movimento a ser efetuado
+ * @return tRegistro O registro do movimento
+ * @related tPartida
+ */
+tRegistro fazMovimentoRegistrado(const tMapa *mapa, tPartida *partida, char movimento);
+/**
+ * @brief Desfaz, em O(1), o movimento descrito por @p registro , o ultimo feito na @ref tPartida @p partida
+ * 
+ * Nao suporta o modo infinito: a comida renascida e as celulas vazias nao voltam atras
+ * 
+ * @param mapa O @ref tMapa
+ * @param partida A @ref tPartida que sera alterada
+ * @param registro O @ref tRegistro devolvido por @ref fazMovimentoRegistrado
+ * @related tPartida
+ */
+void desfazMovimento(const tMapa *mapa, tPartida *partida, const tRegistro *registro);
+/**
+ * @brief Verifica se o @p movimento nao mata a @ref tCobra imediatamente, seja por parede ou pelo proprio corpo
+ * 
+ * @param mapa O @ref tMapa
+ * @param partida A @ref tPartida
+ * @param movimento O movimento a ser avaliado
+ * @return int Verdadeiro, caso a cobra sobreviva ao @p movimento ; do contrario, falso
+ * @related tPartida
+ */
+int ehMovimentoSeguro(const tMapa *mapa, const tPartida *partida, char movimento);
+/**
+ * @brief Desenha o tabuleiro da @ref tPartida , com itens restantes e cobra, em @p tabuleiro
+ * 
+ * @param mapa O @ref tMapa
+ * @param partida A @ref tPartida
+ * @param tabuleiro A matriz que recebera o desenho nas suas nLinhas x mColunas primeiras celulas
+ * @related tPartida
+ */
+void desenhaTabuleiro(const tMapa *mapa, const tPartida *partida, char tabuleiro[TAM_MAPA][TAM_MAPA]);
+/**
+ * @brief Imprime o tabuleiro da @ref tPartida @p partida no @ref tMapa @p mapa para a saida padrao
+ * 
+ * @param mapa O @ref tMapa
+ * @param partida A @ref tPartida
+ * @related tPartida
+ */
+void imprimeMapa(const tMapa *mapa, const tPartida *partida);
+/**
+ * @brief Escreve o tabuleiro da @ref tPartida @p partida no @ref tMapa @p mapa no arquivo @p arq
+ * 
+ * @param arq O arquivo
+ * @param mapa O @ref tMapa
+ * @param partida A @ref tPartida
+ * @related tPartida
+ */
+void escreveMapa(FILE *arq, const tMapa *mapa, const tPartida *partida);
+/**
+ * @brief Representa, sem ponteiros e em tamanho fixo, uma @ref tPartida fora do modo infinito; seguida, num arquivo,
+ * das tamCorpo partes do corpo, da cabeca a cauda, como unsigned short, e das (qtdItens + 63) / 64 palavras usadas de consumidos
+ * 
+ */
+typedef struct {
+    long long pontuacao; ///< A pontuacao
+    unsigned long long hash; ///< O hash de Zobrist, que confere a partida restaurada
+    int qtdComida; ///< A quantidade de comidas que resta no mapa
+    short tamCorpo; ///< O numero de partes da cobra
+    char estado; ///< O estado da partida
+    char estadoCobra; ///< O estado da cobra
+    char direcaoCabeca; ///< A direcao da cabeca
+    char devorado; ///< A ultima celula devorada pela cobra
+} tPontoPartida;
+/**
+ * @brief Falha a compilacao caso uma @ref tPosicao deixe de caber nas partes do corpo de um @ref tPontoPartida
+ * 
+ */
+typedef char tPontoCabePosicao[POS_CELULAS <= USHRT_MAX + 1 ? 1 : -1];
+/**
+ * @brief Falha a compilacao caso a maior cobra deixe de caber no tamCorpo de um @ref tPontoPartida
+ * 
+ */
+typedef char tPontoCabeCorpo[TAM_MAPA * TAM_MAPA <= SHRT_MAX ? 1 : -1];
+/**
+ * @brief Salva a @ref tPartida @p partida , fora do modo infinito, no @ref tPontoPartida @p ponto e nas partes @p corpo
+ * 
+ * @param partida A @ref tPartida
+ * @param ponto O @ref tPontoPartida que recebera a partida; corpo e consumidos ficam de fora
+ * @param corpo O vetor que recebera as tamCorpo partes do corpo, com espaco para nLinhas x mColunas
+ * @related tPartida
+ */
+void salvaPartida(const tPartida *partida, tPontoPartida *ponto, unsigned short corpo[]);
+/**
+ * @brief Restaura na @ref tPartida @p partida o @ref tPontoPartida @p ponto , as partes @p corpo e as palavras usadas de @p consumidos
+ * 
+ * @param mapa O @ref tMapa da partida salva
+ * @param partida A @ref tPartida que recebera o ponto, fora do modo infinito, ja inicializada com @ref inicializaPartida
+ * @param ponto O @ref tPontoPartida
+ * @param corpo As tamCorpo partes do corpo
+ * @param consumidos As (qtdItens + 63) / 64 palavras usadas de consumidos
+ * @return int Verdadeiro, caso o ponto seja valido e a partida restaurada tenha o hash salvo; do contrario, falso
+ * @related tPartida
+ */
+int restauraPartida(const tMapa *mapa, tPartida *partida, const tPontoPartida *ponto, const unsigned short corpo[],
+    const unsigned long long consumidos[]);
 
-    // faz o o caminho de output
-    combinaCaminho(jogo.caminhoSaida, caminhoBase, DIR_SAID);
+// FIM PARTIDA
+// DIARIO
 
-    return jogo;
-}
+/**
+ * @brief Contem a capacidade inicial de um @ref tDiario
+ * @related tDiario
+ */
+#define DIA_CAP_INICIAL 1024
+/**
+ * @brief Representa o diario de movimentos de um jogo: uma pilha de @ref tRegistro
+ * 
+ */
+typedef struct {
+    int qtd; ///< O numero de registros na pilha
+    int capacidade; ///< O numero de registros alocados
+    tRegistro *registros; ///< Os registros, do primeiro ao ultimo movimento
+} tDiario;
+/**
+ * @brief Inicializa um @ref tDiario vazio
+ * 
+ * @return tDiario* Uma nova instancia de @ref tDiario , que deve ser liberada com @ref liberaDiario
+ * @related tDiario
+ */
+tDiario *inicializaDiario();
+/**
+ * @brief Empilha o @p registro no @ref tDiario @p diario
+ * 
+ * @param diario O @ref tDiario
+ * @param registro O @ref tRegistro do ultimo movimento
+ * @related tDiario
+ */
+void empilhaRegistro(tDiario *diario, tRegistro registro);
+/**
+ * @brief Desempilha o registro do ultimo movimento do @ref tDiario @p diario
+ * 
+ * @param diario O @ref tDiario , que nao pode estar vazio
+ * @return tRegistro O registro desempilhado
+ * @related tDiario
+ */
+tRegistro desempilhaRegistro(tDiario *diario);
+/**
+ * @brief Libera a memoria de um @ref tDiario
+ * 
+ * @param diario O @ref tDiario , podendo ser NULL
+ * @related tDiario
+ */
+void liberaDiario(tDiario *diario);
 
-int acabou(tJogo jogo) {
-    return jogo.estado != JOG_EST_C;
-}
+// FIM DIARIO
+// ESTATISTICAS
 
-tJogo fazRodada(tJogo jogo, char movimento) {
-    jogo.mapa = limpaMapa(jogo.mapa);
-    jogo.mapa = fazMovimento(jogo.mapa, movimento);
+/**
+ * @brief Contem o nome do arquivo de saida para a exportacao das estatisticas
+ * @related tEstatisticas
+ */
+#define ARQ_STTS "estatisticas.txt"
+/**
+ * @brief Representa as estatisticas do jogo
+ * @related tEstatisticas
+ */
+typedef struct {
+    long long qtdMov; ///< A quantidade de movimentos efetuados
+    long long qtdNPntMov; ///< A quantidade de movimentos efetuados que nao pontuaram
+    long long qtdMovC; ///< A quantidade de movimentos para cima
+    long long qtdMovD; ///< A quantidade de movimentos para a direita
+    long long qtdMovB; ///< A quantidade de movimentos para baixo
+    long long qtdMovE; ///< A quantidade de movimentos para a esquerda
+} tEstatisticas;
+/**
+ * @brief Inicializa uma struct do tipo @ref tEstatisticas
+ * 
+ * @return tEstatisticas Uma nova instancia de @ref tEstatisticas
+ * @related tEstatisticas
+ */
+tEstatisticas inicializaEstatisticas();
+/**
+ * @brief Adquire a quantidade de movimentos efetuados da @ref tEstatisticas @p estatisticas
+ * 
+ * @param estatisticas A @ref tEstatisticas
+ * @return long long A quantidade de movimentos efetuados
+ * @related tEstatisticas
+ */
+long long adquireQtdMovimentos(tEstatisticas estatisticas);
+/**
+ * @brief Atualiza as @ref tEstatisticas @p estatisticas baseado no movimento efetuado pela @ref tCobra @p cobra
+ * 
+ * @param estatisticas A @ref tEstatisticas
+ * @param cobra A @ref tCobra
+ * @return tEstatisticas O novo estado atualizado da @p estatisticas
+ * @related tEstatisticas
+ */
+tEstatisticas atualizaEstatisticas(tEstatisticas estatisticas, const tCobra *cobra);
+/**
+ * @brief Reverte a atualizacao feita por @ref atualizaEstatisticas com a @ref tCobra @p cobra
+ * 
+ * @param estatisticas A @ref tEstatisticas
+ * @param cobra A @ref tCobra logo apos o movimento que sera revertido
+ * @return tEstatisticas O estado da @p estatisticas antes do movimento
+ * @related tEstatisticas
+ */
+tEstatisticas desfazEstatisticas(tEstatisticas estatisticas, const tCobra *cobra);
+/**
+ * @brief Exporta a @ref tEstatisticas @p estatisticas para o arquivo @ref ARQ_STTS no diretorio @p caminhoBase
+ * 
+ * @param estatisticas A @ref tEstatisticas
+ * @param caminhoBase O diretorio para onde sera salvo a @p estatisticas
+ * @return int 0 em caso de sucesso; -1, caso o arquivo nao possa ser aberto
+ * @related tEstatisticas
+ */
+int exportaEstatisticas(tEstatisticas estatisticas, char caminhoBase[]);
+/**
+ * @brief Escreve a @ref tEstatisticas @p estatisticas no arquivo @p arq , no formato de @ref ARQ_STTS
+ * 
+ * @param arq O arquivo
+ * @param estatisticas A @ref tEstatisticas
+ * @related tEstatisticas
+ */
+void escreveEstatisticas(FILE *arq, tEstatisticas estatisticas);
 
-    tCobra cbr = adquireCobra(jogo.mapa);
+// FIM ESTATISTICAS
+// EXPORTADOR
 
-    // atualiza a pontuacao do jogo
-    char devorado = adquireDevorado(cbr);
-    if (devorado == CEL_DINHR) {
-        jogo.pontuacao += JOG_PNT_D;
-    }
-    else if (devorado == CEL_COMID) {
-        jogo.pontuacao += JOG_PNT_C;
+/**
+ * @brief Contem a capacidade da fila de tarefas de um @ref tExportador
+ * @related tExportador
+ */
+#define EXP_CAP 256
+/**
+ * @brief Contem o tipo de tarefa que acrescenta um @ref tEvento ao resumo
+ * @related tExportador
+ */
+#define EXP_TRF_R 0
+/**
+ * @brief Contem o tipo de tarefa que escreve o arquivo de inicializacao a partir de um @ref tQuadroInicial
+ * @related tExportador
+ */
+#define EXP_TRF_I 1
+/**
+ * @brief Contem o tipo de tarefa que acrescenta um @ref tQuadroSerie a serie do heatmap
+ * @related tExportador
+ */
+#define EXP_TRF_S 2
+/**
+ * @brief Contem o tipo de tarefa que escreve estatisticas, heatmap e ranking a partir de um @ref tQuadroFinal
+ * @related tExportador
+ */
+#define EXP_TRF_F 3
+/**
+ * @brief Contem o tipo de tarefa que encerra a thread do @ref tExportador
+ * @related tExportador
+ */
+#define EXP_TRF_E 4
+/**
+ * @brief Contem o tipo de tarefa que acrescenta um @ref tEvento ao resumo e ao arquivo @ref ARQ_EVTS
+ * @related tExportador
+ */
+#define EXP_TRF_V 5
+/**
+ * @brief Contem o tipo de evento em que a cobra devora uma comida e cresce
+ * @related tEvento
+ */
+#define EVT_COMIDA 1
+/**
+ * @brief Contem o tipo de evento em que a cobra devora um dinheiro
+ * @related tEvento
+ */
+#define EVT_DINHEIRO 2
+/**
+ * @brief Contem o tipo de evento em que a cobra morre ao bater numa parede
+ * @related tEvento
+ */
+#define EVT_PAREDE 3
+/**
+ * @brief Contem o tipo de evento em que a cobra morre ao bater no proprio corpo
+ * @related tEvento
+ */
+#define EVT_CORPO 4
+/**
+ * @brief Contem o tipo de evento em que a cobra devora a ultima comida, vencendo o jogo
+ * @related tEvento
+ */
+#define EVT_VITORIA 5
+/**
+ * @brief Contem o nome do arquivo de saida com o registro binario dos eventos
+ * @related tEvento
+ */
+#define ARQ_EVTS "/eventos.bin"
+/**
+ * @brief Contem a assinatura, com o '\0' final, que inicia o arquivo @ref ARQ_EVTS
+ * @related tEvento
+ */
+#define EVT_ASSN "JSREVT1"
+/**
+ * @brief Representa um evento relevante de uma rodada - comida, dinheiro, colisao ou vitoria
+ *
+ * E tambem o registro de tamanho fixo, de 24 bytes na ordem de bytes da maquina, que segue a
+ * assinatura @ref EVT_ASSN no arquivo @ref ARQ_EVTS ; o resumo em texto e escrito a partir dele
+ *
+ */
+typedef struct {
+    long long movimento; ///< O numero do movimento
+    long long pontuacao; ///< A pontuacao apos o movimento
+    int tamanho; ///< O tamanho da cobra apos o movimento
+    char tipo; ///< O tipo do evento, como @ref EVT_COMIDA
+    char comando; ///< O movimento efetuado - como @ref MOV_CBRCT , @ref MOV_CBRHO e @ref MOV_CBRAH
+    char reservado[2]; ///< Completa o registro; sempre zero
+} tEvento;
+/**
+ * @brief Representa a funcao registrada para receber cada @ref tEvento do jogo, na thread do jogo
+ *
+ */
+typedef void (*tTratadorEvento)(const tEvento *evento, void *contexto);
+/**
+ * @brief Representa a copia imutavel do tabuleiro inicial, para o arquivo de inicializacao
+ *
+ */
+typedef struct {
+    int nLinhas; ///< Numero de linhas do tabuleiro
+    int mColunas; ///< Numero de colunas do tabuleiro
+    char *tabuleiro; ///< O tabuleiro desenhado, indexado por i * mColunas + j
+    tPosicao cabeca; ///< A posicao inicial da cabeca da cobra
+} tQuadroInicial;
+/**
+ * @brief Representa a copia imutavel de um snapshot da serie do heatmap
+ *
+ */
+typedef struct {
+    long long movimento; ///< O numero do movimento ao qual o snapshot se refere
+    int qtd; ///< A quantidade de incrementos
+    tIncremento *incrementos; ///< Os incrementos extraidos da @ref tSujas
+} tQuadroSerie;
+/**
+ * @brief Representa a copia imutavel do fim de um jogo, para estatisticas, heatmap e ranking
+ *
+ */
+typedef struct {
+    int nLinhas; ///< Numero de linhas do heatmap
+    int mColunas; ///< Numero de colunas do heatmap
+    tHeatmap *heatmap; ///< A copia do heatmap
+    tEstatisticas estatisticas; ///< As estatisticas do jogo
+    char *caminhoSaida; ///< O diretorio de saida; preenchido por quem processa a tarefa
+    int rankingExportado; ///< O retorno de @ref exportaRanking ; preenchido por quem processa a tarefa
+} tQuadroFinal;
+/**
+ * @brief Representa uma tarefa de exportacao: um evento ou um quadro, que passa a pertencer a quem a processa
+ *
+ */
+typedef struct {
+    int tipo; ///< O tipo da tarefa, como @ref EXP_TRF_R
+    tEvento evento; ///< O evento, nas tarefas @ref EXP_TRF_R e @ref EXP_TRF_V
+    void *quadro; ///< O quadro alocado, nas tarefas @ref EXP_TRF_I , @ref EXP_TRF_S e @ref EXP_TRF_F
+} tTarefa;
+/**
+ * @brief Representa a thread que escreve os arquivos do jogo em segundo plano
+ *
+ * As tarefas passam por uma fila circular de um produtor e um consumidor sincronizada pelos semaforos:
+ * o sem_post que conta uma tarefa ou posicao livre tambem publica a escrita da fila feita antes dele
+ *
+ */
+typedef struct {
+    tTarefa fila[EXP_CAP]; ///< A fila circular de tarefas
+    unsigned long inicio; ///< Quantas tarefas o consumidor ja retirou; so ele escreve
+    unsigned long fim; ///< Quantas tarefas o produtor ja colocou; so ele escreve
+    sem_t itens; ///< Conta as tarefas na fila
+    sem_t livres; ///< Conta as posicoes livres na fila
+    pthread_t thread; ///< A thread escritora
+    char caminhoSaida[TAM_CAMINHO]; ///< O diretorio de saida, copiado para nao depender do jogo
+    FILE *resumo; ///< O arquivo de resumo, mantido aberto entre eventos
+    FILE *eventos; ///< O arquivo @ref ARQ_EVTS , mantido aberto entre eventos; NULL enquanto nenhuma tarefa @ref EXP_TRF_V chega
+    int falhou; ///< Verdadeiro quando alguma tarefa nao pode escrever seus arquivos; so a thread escritora escreve
+} tExportador;
+/**
+ * @brief Inicializa um @ref tExportador e sua thread escritora para o diretorio @p caminhoSaida
+ *
+ * @param caminhoSaida O diretorio de saida dos arquivos
+ * @return tExportador* Uma nova instancia de @ref tExportador , que deve ser encerrada com @ref encerraExportador ;
+ * NULL, caso falte memoria ou a thread nao possa ser criada
+ * @related tExportador
+ */
+tExportador *inicializaExportador(char caminhoSaida[]);
+/**
+ * @brief Coloca a @p tarefa na fila do @ref tExportador , esperando apenas se a fila estiver cheia
+ *
+ * @param exportador O @ref tExportador
+ * @param tarefa A @ref tTarefa
+ * @related tExportador
+ */
+void enviaTarefa(tExportador *exportador, tTarefa tarefa);
+/**
+ * @brief Envia a @p tarefa ao @p exportador ou, se ele for NULL, processa-a imediatamente
+ *
+ * @param exportador O @ref tExportador , podendo ser NULL
+ * @param caminhoSaida O diretorio de saida, usado quando a tarefa e processada imediatamente
+ * @param tarefa A @ref tTarefa
+ * @return int 0 em caso de sucesso ou de envio ao exportador; -1, caso a tarefa processada imediatamente falhe
+ * @related tExportador
+ */
+int despachaTarefa(tExportador *exportador, char caminhoSaida[], tTarefa tarefa);
+/**
+ * @brief Processa a @p tarefa , escrevendo seus arquivos e liberando seu quadro
+ *
+ * @param caminhoSaida O diretorio de saida
+ * @param resumo O arquivo de resumo aberto, ou NULL; e aberto sob demanda e fechado ao fim do jogo
+ * @param eventos O arquivo @ref ARQ_EVTS aberto, ou NULL; aberto sob demanda pelas tarefas @ref EXP_TRF_V e fechado junto com o resumo
+ * @param tarefa A @ref tTarefa
+ * @return int 0 em caso de sucesso; -1, caso algum arquivo nao possa ser aberto, quando a parte dele e descartada
+ * @related tExportador
+ */
+int processaTarefa(char caminhoSaida[], FILE **resumo, FILE **eventos, tTarefa *tarefa);
+/**
+ * @brief Ponto de entrada da thread escritora: processa as tarefas ate receber @ref EXP_TRF_E
+ *
+ * @param arg O @ref tExportador
+ * @return void* Sempre NULL
+ * @related tExportador
+ */
+void *executaExportador(void *arg);
+/**
+ * @brief Ponto de entrada da thread que escreve o ranking enquanto o heatmap e escrito em paralelo
+ *
+ * @param arg O @ref tQuadroFinal
+ * @return void* Sempre NULL
+ * @related tExportador
+ */
+void *executaRanking(void *arg);
+/**
+ * @brief Escreve o @p evento no arquivo de resumo @p arq
+ *
+ * @param arq O arquivo de resumo
+ * @param evento O @ref tEvento
+ * @related tExportador
+ */
+void escreveResumo(FILE *arq, const tEvento *evento);
+/**
+ * @brief Acrescenta o registro binario do @p evento ao arquivo @p arq , precedido de @ref EVT_ASSN se o arquivo estiver vazio
+ *
+ * @param arq O arquivo @ref ARQ_EVTS , aberto para acrescentar
+ * @param evento O @ref tEvento
+ * @related tExportador
+ */
+void escreveEvento(FILE *arq, const tEvento *evento);
+/**
+ * @brief Escreve o tabuleiro inicial do @p quadro no arquivo @p arq , no formato de @ref ARQ_INIC
+ *
+ * @param arq O arquivo de inicializacao
+ * @param quadro O @ref tQuadroInicial
+ * @related tExportador
+ */
+void escreveInicializacao(FILE *arq, const tQuadroInicial *quadro);
+/**
+ * @brief Espera a fila esvaziar, encerra a thread escritora e libera o @ref tExportador
+ *
+ * @param exportador O @ref tExportador , podendo ser NULL
+ * @return int 0 em caso de sucesso; -1, caso alguma tarefa nao tenha podido escrever seus arquivos
+ * @related tExportador
+ */
+int encerraExportador(tExportador *exportador);
+
+// FIM EXPORTADOR
+// JOGO
+
+/**
+ * @brief Contem a quantidade de pontos que valem as celulas @ref CEL_DINHR
+ * @related tJogo
+ */
+#define JOG_PNT_D 10
+/**
+ * @brief Contem a quantidade de pontos que valem as celulas @ref CEL_COMID
+ * @related tJogo
+ */
+#define JOG_PNT_C 1
+/**
+ * @brief Contem a representacao para o estado continua do jogo
+ * @related tJogo
+ */
+#define JOG_EST_C 0
+/**
+ * @brief Contem a representacao para o estado vitoria do jogo
+ * @related tJogo
+ */
+#define JOG_EST_V 1
+/**
+ * @brief Contem a representacao para o estado derrota do jogo
+ * @related tJogo
+ */
+#define JOG_EST_D 2
+/**
+ * @brief Contem o diretorio de saida para os arquivos
+ * @related tJogo
+ */
+#define DIR_SAID "/saida/"
+/**
+ * @brief Contem o nome do arquivo de saida para a exportacao da inicializacao
+ * @related tJogo
+ */
+#define ARQ_INIC "/inicializacao.txt"
+/**
+ * @brief Contem o nome do arquivo de saida para a exportacao do resumo
+ * @related tJogo
+ */
+#define ARQ_RESM "/resumo.txt"
+/**
+ * @brief Contem o nome do arquivo de saida para a serie temporal de snapshots do heatmap
+ * @related tJogo
+ */
+#define ARQ_SERI "/heatmap_serie.bin"
+/**
+ * @brief Contem a assinatura que inicia o arquivo @ref ARQ_SERI
+ * @related tJogo
+ */
+#define SER_ASSN "HMS1"
+/**
+ * @brief Contem o nome do arquivo de saida para o heatmap mapeado em memoria, atualizado durante o jogo
+ * @related tJogo
+ */
+#define ARQ_HMVV "/heatmap_vivo.bin"
+/**
+ * @brief Representa o jogo snake
+ * 
+ */
+typedef struct {
+    const tMapa *mapa; ///< O mapa, imutavel e compartilhado por todas as copias do jogo
+    tPartida partida; ///< O estado dinamico do jogo
+    tEstatisticas estatisticas; ///< As estatisticas do jogo
+    tHeatmap *heatmap; ///< O heatmap de posicoes no mapa; NULL quando nao e registrado
+    tSujas *sujas; ///< As celulas do heatmap alteradas desde o ultimo snapshot; NULL quando nao sao registradas
+    char *caminhoSaida; ///< O caminho de saida para os arquivos do jogo, compartilhado por todas as copias do jogo
+    int intervaloSerie; ///< A cada quantos movimentos um snapshot do heatmap e exportado; 0 quando desabilitado
+    int gravaEventos; ///< Se os eventos tambem sao acrescentados ao arquivo @ref ARQ_EVTS , alem do resumo
+    tDiario *diario; ///< O diario das rodadas feitas por @ref fazRodada , compartilhado por todas as copias do jogo; NULL enquanto nao e habilitado
+    tRegistro ultimoRegistro; ///< O registro da ultima rodada feita por @ref fazRodada , de onde os quadros delta tiram as celulas alteradas
+    tExportador *exportador; ///< O exportador em segundo plano dos arquivos; NULL quando sao escritos na propria thread
+    FILE *resumo; ///< Recebe uma copia de cada evento do resumo, alem do arquivo; NULL quando nao e mantida
+    tTratadorEvento tratador; ///< Recebe cada evento do jogo; NULL quando nenhum e registrado
+    void *contexto; ///< O contexto repassado ao tratador
+} tJogo;
+/**
+ * @brief Inicializa uma struct do tipo @ref tJogo no diretorio @p caminhoBase
+ * 
+ * @param caminhoBase O diretorio onde o jogo ocorre e todos os seus dados estao
+ * @return tJogo Uma nova instancia de @ref tJogo
+ * @related tJogo
+ */
+tJogo inicializaJogo(char caminhoBase[]);
+/**
+ * @brief Inicializa uma struct do tipo @ref tJogo sobre o @ref tMapa @p mapa , sem diretorio de saida: nada e exportado
+ * 
+ * @param mapa O @ref tMapa , que passa a pertencer ao jogo
+ * @return tJogo Uma nova instancia de @ref tJogo ; sem memoria para o heatmap ou o corpo da cobra, com heatmap NULL
+ * @related tJogo
+ */
+tJogo criaJogo(const tMapa *mapa);
+/**
+ * @brief Verifica se o jogo terminou ou nao
+ * 
+ * @param jogo O @ref tJogo
+ * @return int Verdadeiro, se o jogo acabou; do contrario, falso
+ * @related tJogo
+ */
+int acabou(tJogo jogo);
+/**
+ * @brief Efetua a rodada do @ref tJogo @p jogo com o @p movimento
+ * 
+ * @param jogo O @ref tJogo
+ * @param movimento O movimento que sera feito na rodada
+ * @return tJogo O novo estado do @p jogo ao fim da rodada
+ * @related tJogo
+ */
+tJogo fazRodada(tJogo jogo, char movimento);
+/**
+ * @brief Simula a rodada do @ref tJogo @p jogo com o @p movimento, alterando-o no lugar e sem exportar nada
+ * 
+ * @param jogo O @ref tJogo que sera alterado
+ * @param movimento O movimento que sera feito na rodada
+ * @related tJogo
+ */
+void avancaJogo(tJogo *jogo, char movimento);
+/**
+ * @brief Contabiliza no heatmap, nas celulas sujas e nas estatisticas o movimento que a partida acabou de fazer
+ * 
+ * @param jogo O @ref tJogo que sera alterado
+ * @related tJogo
+ */
+void contabilizaRodada(tJogo *jogo);
+/**
+ * @brief Contabiliza a rodada como @ref contabilizaRodada , num mapa de @p mColunas colunas
+ * 
+ * Sempre expandida no chamador, para que as variantes de @ref MAP_LADOS a compilem com dimensoes constantes
+ * 
+ * @param jogo O @ref tJogo que sera alterado, cujo mapa tem @p mColunas colunas
+ * @param mColunas O numero de colunas do mapa
+ * @related tJogo
+ */
+__inline__ void contabilizaRodadaDimensoes(tJogo *jogo, unsigned int mColunas) __attribute__((always_inline));
+/**
+ * @brief Declara a variante de @ref contabilizaRodada para o mapa de lado @p L , gerada por @ref JOG_DEFINE_CONTABILIZA
+ * @related tJogo
+ */
+#define JOG_DECLARA_CONTABILIZA(L) void contabilizaRodada##L(tJogo *jogo);
+/**
+ * @brief Define a variante de @ref contabilizaRodada para o mapa de lado @p L
+ * @related tJogo
+ */
+#define JOG_DEFINE_CONTABILIZA(L) \
+    void contabilizaRodada##L(tJogo *jogo) { \
+        contabilizaRodadaDimensoes(jogo, L); \
+    }
+MAP_LADOS(JOG_DECLARA_CONTABILIZA)
+/**
+ * @brief Desfaz, em O(1), a ultima rodada feita por @ref fazRodada ; nao faz nada sem o diario, sem rodadas ou no modo infinito
+ * 
+ * Restaura partida, estatisticas e heatmap; os arquivos ja exportados e a serie do heatmap nao sao desfeitos
+ * 
+ * @param jogo O @ref tJogo
+ * @return tJogo O estado do @p jogo antes da ultima rodada
+ * @related tJogo
+ */
+tJogo desfazRodada(tJogo jogo);
+/**
+ * @brief Desfaz a ultima rodada como @ref desfazRodada , alterando o @p jogo no lugar
+ * 
+ * @param jogo O @ref tJogo que sera alterado
+ * @related tJogo
+ */
+void retrocedeJogo(tJogo *jogo);
+/**
+ * @brief Exporta o arquivo de inicializacao do @ref tJogo para o arquivo @ref ARQ_INIC ; nada faz em jogo sem diretorio de saida
+ * 
+ * @param jogo O @ref tJogo
+ * @return int 0 em caso de sucesso; -1, caso falte memoria para o quadro ou, sem exportador, o arquivo nao possa ser aberto
+ * @related tJogo
+ */
+int exportaInicializacao(tJogo jogo);
+/**
+ * @brief Emite o @ref tEvento ocorrido no @ref tJogo @p jogo com o @p movimento , caso haja um
+ * 
+ * O evento vai para o tratador registrado, para o resumo em memoria, para o arquivo @ref ARQ_RESM e, se
+ * habilitado por @ref habilitaEventos , para o arquivo @ref ARQ_EVTS
+ * 
+ * @param jogo O @ref tJogo
+ * @param currMov A numero desse movimento
+ * @param cobra A @ref tCobra do jogo
+ * @param movimento O movimento efetuado - como @ref MOV_CBRCT , @ref MOV_CBRHO e @ref MOV_CBRAH
+ * @related tJogo
+ */
+void emiteEvento(tJogo jogo, long long currMov, const tCobra *cobra, char movimento);
+/**
+ * @brief Exporta todos os dados do jogo - como o heatmap, estatisticas e ranking; nada faz em jogo sem diretorio de saida
+ * 
+ * @param jogo O @ref tJogo
+ * @return int 0 em caso de sucesso; -1, caso falte memoria para o ultimo snapshot ou o quadro final, que nao sao exportados,
+ * ou, sem exportador, algum arquivo nao possa ser aberto
+ * @related tJogo
+ */
+int exportaJogo(tJogo jogo);
+/**
+ * @brief Habilita a serie temporal do heatmap, exportada para @ref ARQ_SERI a cada @p intervalo movimentos
+ *
+ * O arquivo comeca com @ref SER_ASSN seguido de varint(nLinhas) varint(mColunas) varint(intervalo) e do
+ * snapshot do movimento 0; cada snapshot seguinte contem apenas as celulas alteradas desde o anterior,
+ * de modo que a soma de todos eles resulta no heatmap final
+ *
+ * @param jogo O @ref tJogo
+ * @param intervalo O numero de movimentos entre snapshots
+ * @return tJogo O @p jogo com a serie habilitada; sem memoria para as celulas sujas ou sem poder criar o arquivo, com a serie desabilitada e sujas NULL
+ * @related tJogo
+ */
+tJogo habilitaSerie(tJogo jogo, int intervalo);
+/**
+ * @brief Passa a escrever os arquivos do @ref tJogo @p jogo pelo @ref tExportador @p exportador , em segundo plano
+ *
+ * Os arquivos so estao completos apos @ref encerraExportador ; o exportador nao depende do jogo e pode
+ * continuar escrevendo depois de @ref liberaJogo
+ *
+ * @param jogo O @ref tJogo
+ * @param exportador O @ref tExportador
+ * @return tJogo O @p jogo com o exportador habilitado
+ * @related tJogo
+ */
+tJogo habilitaExportador(tJogo jogo, tExportador *exportador);
+/**
+ * @brief Poe o @ref tJogo @p jogo , ainda sem movimentos, no modo infinito ( @ref tInfinito )
+ *
+ * Cada comida devorada renasce numa celula vazia sorteada, de modo que a comida restante nunca acaba e o
+ * jogo so termina com a morte da cobra
+ *
+ * @param jogo O @ref tJogo
+ * @param semente A semente do sorteio das comidas renascidas
+ * @return tJogo O @p jogo no modo infinito; sem memoria para o @ref tInfinito , fora dele
+ * @related tJogo
+ */
+tJogo habilitaInfinito(tJogo jogo, unsigned long long semente);
+/**
+ * @brief Habilita o diario de rodadas do @ref tJogo @p jogo , que permite @ref desfazRodada
+ *
+ * O diario guarda um @ref tRegistro por rodada e nunca e podado, por isso so existe quando pedido;
+ * no modo infinito ele nao registra nada, ja que a comida renascida nao pode ser desfeita
+ *
+ * @param jogo O @ref tJogo , ainda sem rodadas
+ * @return tJogo O @p jogo com o diario
+ * @related tJogo
+ */
+tJogo habilitaDiario(tJogo jogo);
+/**
+ * @brief Habilita o registro binario dos eventos do @ref tJogo @p jogo no arquivo @ref ARQ_EVTS , alem do resumo
+ *
+ * @param jogo O @ref tJogo , com diretorio de saida e ainda sem rodadas
+ * @return tJogo O @p jogo com o registro dos eventos
+ * @related tJogo
+ */
+tJogo habilitaEventos(tJogo jogo);
+/**
+ * @brief Registra o @p tratador que recebe cada @ref tEvento do @ref tJogo @p jogo , substituindo o anterior
+ *
+ * @param jogo O @ref tJogo
+ * @param tratador O tratador; NULL para nenhum
+ * @param contexto O contexto repassado ao tratador a cada evento
+ * @return tJogo O @p jogo com o tratador
+ * @related tJogo
+ */
+tJogo registraTratador(tJogo jogo, tTratadorEvento tratador, void *contexto);
+/**
+ * @brief Passa a manter o heatmap do @ref tJogo @p jogo no arquivo @ref ARQ_HMVV , atualizado no lugar a cada movimento
+ *
+ * Veja @ref mapeiaHeatmap e @ref tCabecalhoVivo ; @ref ARQ_HMAP continua sendo exportado ao fim do jogo
+ *
+ * @param jogo O @ref tJogo , com diretorio de saida
+ * @return int 0 em caso de sucesso; -1, caso o arquivo nao possa ser criado ou mapeado
+ * @related tJogo
+ */
+int habilitaHeatmapVivo(tJogo *jogo);
+/**
+ * @brief Exporta as celulas do heatmap alteradas desde o ultimo snapshot para o arquivo @ref ARQ_SERI
+ *
+ * Sem memoria para o snapshot, as celulas continuam sujas e vao no snapshot seguinte
+ *
+ * @param jogo O @ref tJogo
+ * @return int 0 em caso de sucesso; -1, caso falte memoria ou, sem exportador, o arquivo nao possa ser aberto
+ * @related tJogo
+ */
+int exportaSnapshotHeatmap(tJogo jogo);
+/**
+ * @brief Libera os recursos alocados por @ref inicializaJogo , @ref habilitaSerie , @ref habilitaInfinito e @ref habilitaDiario , inclusive o @ref tMapa compartilhado
+ *
+ * @param jogo O @ref tJogo
+ * @related tJogo
+ */
+void liberaJogo(tJogo jogo);
+/**
+ * @brief Imprime o @ref tJogo @p jogo para a saida padrao
+ * 
+ * @param jogo O @ref tJogo
+ * @related tJogo
+ */
+void imprimeJogo(tJogo jogo);
+/**
+ * @brief Imprime a @p pontuacao e, se o jogo acabou no @p estado , a mensagem de fim de jogo
+ * 
+ * @param pontuacao A pontuacao do jogo
+ * @param estado O estado do jogo - como @ref JOG_EST_C , @ref JOG_EST_V e @ref JOG_EST_D
+ * @related tJogo
+ */
+void imprimePlacar(long long pontuacao, int estado);
+/**
+ * @brief Escreve o placar como @ref imprimePlacar no arquivo @p arq
+ * 
+ * @param arq O arquivo
+ * @param pontuacao A pontuacao do jogo
+ * @param estado O estado do jogo - como @ref JOG_EST_C , @ref JOG_EST_V e @ref JOG_EST_D
+ * @related tJogo
+ */
+void escrevePlacar(FILE *arq, long long pontuacao, int estado);
+
+// FIM JOGO
+// LOTE
+
+/**
+ * @brief Contem o numero de jogos avancados juntos em um @ref tLote
+ * @related tLote
+ */
+#define LOT_TAM 16
+/**
+ * @brief Representa ate @ref LOT_TAM jogos independentes sobre o mesmo @ref tMapa , avancados em passo unico
+ *
+ * O estado quente de cada jogo fica em vetores paralelos (estrutura de vetores): cabeca, direcao,
+ * pontuacao, comida restante e atividade. Os lacos sobre esses vetores percorrem sempre as
+ * @ref LOT_TAM posicoes, sem desvios, para que o compilador os vetorize; corpo, itens devorados
+ * e estatisticas continuam em cada @ref tJogo e sao atualizados jogo a jogo
+ *
+ */
+typedef struct {
+    int qtd; ///< O numero de jogos do lote; as posicoes seguintes ficam inativas
+    const tMapa *mapa; ///< O mapa, compartilhado por todos os jogos
+    int cabecaI[LOT_TAM]; ///< A linha da cabeca de cada jogo
+    int cabecaJ[LOT_TAM]; ///< A coluna da cabeca de cada jogo
+    int direcao[LOT_TAM]; ///< A direcao da cabeca de cada jogo
+    long long pontuacao[LOT_TAM]; ///< A pontuacao de cada jogo
+    int qtdComida[LOT_TAM]; ///< A comida restante de cada jogo
+    int ativo[LOT_TAM]; ///< Verdadeiro enquanto o jogo continua
+    int morreu[LOT_TAM]; ///< Verdadeiro se a cobra do jogo morreu no ultimo movimento
+    int devorado[LOT_TAM]; ///< A celula devorada por cada jogo no ultimo movimento
+    tJogo jogos[LOT_TAM]; ///< Os jogos, com corpo, itens e estatisticas proprios
+} tLote;
+/**
+ * @brief Inicializa o @ref tLote @p lote com @p qtd copias do @ref tJogo @p modelo recem inicializado
+ *
+ * Os jogos compartilham o mapa do modelo e nao registram heatmap
+ *
+ * @param lote O @ref tLote
+ * @param modelo O @ref tJogo recem inicializado
+ * @param qtd O numero de jogos, de 1 a @ref LOT_TAM
+ * @param sujas As @ref tSujas de cada jogo, ou NULL para nao registra-las
+ * @param corpos O espaco do corpo da cobra de cada jogo, com nLinhas x mColunas posicoes por jogo
+ * @related tLote
+ */
+void inicializaLote(tLote *lote, const tJogo *modelo, int qtd, tSujas *sujas[], tPosicao corpos[]);
+/**
+ * @brief Recomeca o jogo de indice @p k do @ref tLote como uma nova copia do @ref tJogo @p modelo , mantendo suas @ref tSujas e o espaco do corpo da cobra
+ *
+ * Permite reaproveitar a posicao de um jogo que acabou sem esperar pelos demais do lote
+ *
+ * @param lote O @ref tLote
+ * @param k O indice do jogo, menor que o qtd do lote
+ * @param modelo O @ref tJogo recem inicializado, com o mesmo mapa do lote
+ * @related tLote
+ */
+void reiniciaNoLote(tLote *lote, int k, const tJogo *modelo);
+/**
+ * @brief Avanca em um movimento todos os jogos ativos do @ref tLote , com o mesmo resultado de @ref avancaJogo em cada um
+ *
+ * O jogo em que so resta comida inalcancavel ( @ref restaSoInalcancavel ) deixa de ser ativo, pois nao pode mais ser vencido
+ *
+ * @param lote O @ref tLote
+ * @param movimentos O movimento de cada jogo, com @ref LOT_TAM posicoes; ignorado nos inativos
+ * @related tLote
+ */
+void avancaLote(tLote *lote, const char movimentos[]);
+/**
+ * @brief Avanca o @ref tLote como @ref avancaLote , num mapa de @p nLinhas x @p mColunas
+ *
+ * Sempre expandida no chamador, para que as variantes de @ref MAP_LADOS a compilem com dimensoes constantes
+ *
+ * @param lote O @ref tLote , cujo mapa tem as dimensoes @p nLinhas x @p mColunas
+ * @param movimentos O movimento de cada jogo, com @ref LOT_TAM posicoes; ignorado nos inativos
+ * @param nLinhas O numero de linhas do mapa
+ * @param mColunas O numero de colunas do mapa
+ * @related tLote
+ */
+__inline__ void avancaLoteDimensoes(tLote *lote, const char movimentos[], int nLinhas, int mColunas) __attribute__((always_inline));
+/**
+ * @brief Declara a variante de @ref avancaLote para o mapa de lado @p L , gerada por @ref LOT_DEFINE_AVANCA
+ * @related tLote
+ */
+#define LOT_DECLARA_AVANCA(L) void avancaLote##L(tLote *lote, const char movimentos[]);
+/**
+ * @brief Define a variante de @ref avancaLote para o mapa de lado @p L
+ * @related tLote
+ */
+#define LOT_DEFINE_AVANCA(L) \
+    void avancaLote##L(tLote *lote, const char movimentos[]) { \
+        avancaLoteDimensoes(lote, movimentos, L, L); \
+    }
+MAP_LADOS(LOT_DECLARA_AVANCA)
+/**
+ * @brief Conta os jogos do @ref tLote que ainda continuam
+ *
+ * @param lote O @ref tLote
+ * @return int O numero de jogos ativos
+ * @related tLote
+ */
+int contaAtivos(const tLote *lote);
+
+// FIM LOTE
+// TELA
+
+/**
+ * @brief Representa a saida em quadros delta: um quadro-chave completo e, a cada movimento, so as celulas alteradas
+ *
+ * Protocolo, em texto na saida padrao:
+ * - quadro-chave: "Q movimento comando pontuacao estado nLinhas mColunas" seguido das nLinhas linhas do tabuleiro;
+ * - quadro delta: "D movimento comando pontuacao estado qtd" seguido de qtd linhas "i j glifo".
+ * O primeiro quadro e o quadro-chave do movimento 0, com comando '-'
+ *
+ */
+typedef struct {
+    int nLinhas; ///< Numero de linhas do tabuleiro
+    int mColunas; ///< Numero de colunas do tabuleiro
+    int intervaloChave; ///< A cada quantos movimentos emitir um quadro-chave; 0 para apenas o inicial
+    char quadro[TAM_MAPA][TAM_MAPA]; ///< O tabuleiro como esta na saida ate o ultimo quadro
+} tTela;
+/**
+ * @brief Inicializa uma @ref tTela para o @ref tMapa @p mapa
+ *
+ * @param mapa O @ref tMapa
+ * @param intervaloChave A cada quantos movimentos emitir um quadro-chave; 0 para apenas o inicial
+ * @return tTela* Uma nova instancia de @ref tTela , que deve ser liberada com free
+ * @related tTela
+ */
+tTela *inicializaTela(const tMapa *mapa, int intervaloChave);
+/**
+ * @brief Imprime o quadro do movimento mais recente do @ref tJogo @p jogo : chave no movimento 0 e a cada intervaloChave, delta nos demais
+ *
+ * @param tela A @ref tTela
+ * @param jogo O @ref tJogo , cujo ultimo movimento deve ter sido feito por @ref fazRodada
+ * @param comando O movimento efetuado, ou '-' no movimento 0
+ * @related tTela
+ */
+void imprimeQuadro(tTela *tela, const tJogo *jogo, char comando);
+/**
+ * @brief Imprime o quadro-chave do @ref tJogo @p jogo , com o tabuleiro completo
+ *
+ * @param tela A @ref tTela
+ * @param jogo O @ref tJogo
+ * @param comando O movimento efetuado, ou '-' no movimento 0
+ * @related tTela
+ */
+void imprimeQuadroChave(tTela *tela, const tJogo *jogo, char comando);
+/**
+ * @brief Imprime o quadro delta do ultimo movimento do @ref tJogo @p jogo , apenas com as celulas alteradas
+ *
+ * @param tela A @ref tTela
+ * @param jogo O @ref tJogo
+ * @param comando O movimento efetuado
+ * @related tTela
+ */
+void imprimeQuadroDelta(tTela *tela, const tJogo *jogo, char comando);
+/**
+ * @brief Atualiza o quadro da @ref tTela com o ultimo movimento do @ref tJogo @p jogo , registrando as celulas alteradas
+ *
+ * @param tela A @ref tTela
+ * @param jogo O @ref tJogo , cujo ultimo movimento deve ter sido feito por @ref fazRodada
+ * @param alteradas O vetor que recebera as celulas cujo glifo mudou, com espaco para nLinhas x mColunas + 4 posicoes
+ * @return int A quantidade de celulas alteradas
+ * @related tTela
+ */
+int atualizaTela(tTela *tela, const tJogo *jogo, tPosicao alteradas[]);
+/**
+ * @brief Adquire o glifo com o qual a celula @p pos aparece no tabuleiro da @ref tPartida
+ *
+ * Considera apenas a cabeca, a segunda parte do corpo e, se a cobra morreu, o corpo inteiro; sao as unicas
+ * partes da cobra que um movimento pode alterar
+ *
+ * @param mapa O @ref tMapa
+ * @param partida A @ref tPartida
+ * @param pos A @ref tPosicao
+ * @return char O glifo da celula
+ * @related tTela
+ */
+char adquireGlifo(const tMapa *mapa, const tPartida *partida, tPosicao pos);
+/**
+ * @brief Le quadros no protocolo da @ref tTela de @p entrada e imprime cada movimento como a saida normal do jogo
+ *
+ * @param entrada O arquivo com os quadros
+ * @related tTela
+ */
+void reconstroiQuadros(FILE *entrada);
+
+// FIM TELA
+// AOVIVO
+
+/**
+ * @brief Contem a taxa padrao de quadros por segundo do modo ao vivo
+ * @related tAoVivo
+ */
+#define AOV_FPS 30
+/**
+ * @brief Representa a visualizacao ao vivo do jogo em um terminal ANSI
+ *
+ * A tela e limpa uma unica vez; depois, a cada quadro, o cursor e posicionado apenas nas celulas alteradas desde
+ * o quadro anterior. Quadros sao desenhados no maximo fps vezes por segundo, acumulando os movimentos entre eles.
+ * O jogo apenas monta o quadro em memoria; uma thread escritora o envia ao terminal. Enquanto ela escreve, os quadros
+ * seguintes sao descartados e suas celulas continuam sujas, de modo que um terminal lento nunca atrasa o jogo
+ *
+ */
+typedef struct {
+    tTela *tela; ///< O tabuleiro atual, atualizado a cada movimento
+    int fps; ///< A taxa maxima de quadros por segundo
+    double inicio; ///< O instante, em segundos, do inicio do jogo
+    double proximoQuadro; ///< O instante, em segundos, a partir do qual o proximo quadro pode ser desenhado
+    int qtdSujas; ///< A quantidade de celulas alteradas desde o ultimo quadro
+    tPosicao *sujas; ///< As celulas alteradas desde o ultimo quadro
+    char (*marcadas)[TAM_MAPA]; ///< Verdadeiro nas celulas que ja estao em sujas
+    char *buffer; ///< O buffer no qual cada quadro e montado antes de uma unica escrita
+    int tamQuadro; ///< O tamanho do quadro montado em buffer; -1 encerra a thread escritora
+    int emThread; ///< Se os quadros sao escritos pela thread escritora; senao, pelo proprio jogo
+    sem_t livre; ///< Vale 1 enquanto a thread escritora nao esta escrevendo, e o buffer pode ser remontado
+    sem_t pronto; ///< Conta os quadros montados que a thread escritora ainda deve escrever
+    pthread_t thread; ///< A thread escritora
+} tAoVivo;
+/**
+ * @brief Inicializa o modo ao vivo para o @ref tJogo @p jogo , limpando a tela e desenhando o tabuleiro completo
+ *
+ * @param jogo O @ref tJogo
+ * @param fps A taxa maxima de quadros por segundo
+ * @return tAoVivo* Uma nova instancia de @ref tAoVivo , que deve ser encerrada com @ref encerraAoVivo
+ * @related tAoVivo
+ */
+tAoVivo *inicializaAoVivo(const tJogo *jogo, int fps);
+/**
+ * @brief Acumula as celulas alteradas pelo ultimo movimento do @ref tJogo @p jogo e desenha um quadro se ja for a hora
+ *
+ * @param aoVivo O @ref tAoVivo
+ * @param jogo O @ref tJogo , cujo ultimo movimento deve ter sido feito por @ref fazRodada
+ * @related tAoVivo
+ */
+void registraAoVivo(tAoVivo *aoVivo, const tJogo *jogo);
+/**
+ * @brief Desenha as celulas alteradas desde o ultimo quadro e a linha de status: pontuacao, tamanho e movimentos por segundo
+ *
+ * O quadro e entregue a thread escritora; se ela ainda estiver escrevendo o anterior, o quadro e descartado
+ *
+ * @param aoVivo O @ref tAoVivo
+ * @param jogo O @ref tJogo
+ * @return int 1, caso o quadro tenha sido desenhado; 0, caso tenha sido descartado
+ * @related tAoVivo
+ */
+int desenhaAoVivo(tAoVivo *aoVivo, const tJogo *jogo);
+/**
+ * @brief Monta no buffer do @ref tAoVivo as sequencias ANSI das celulas alteradas e a linha de status
+ *
+ * @param aoVivo O @ref tAoVivo
+ * @param jogo O @ref tJogo
+ * @return int O tamanho do quadro montado
+ * @related tAoVivo
+ */
+int montaAoVivo(tAoVivo *aoVivo, const tJogo *jogo);
+/**
+ * @brief Ponto de entrada da thread escritora: escreve os quadros montados ate receber um de tamanho -1
+ *
+ * @param arg O @ref tAoVivo
+ * @return void* Sempre NULL
+ * @related tAoVivo
+ */
+void *executaAoVivo(void *arg);
+/**
+ * @brief Desenha o ultimo quadro, devolve o cursor abaixo do tabuleiro e libera o @ref tAoVivo
+ *
+ * @param aoVivo O @ref tAoVivo
+ * @param jogo O @ref tJogo
+ * @related tAoVivo
+ */
+void encerraAoVivo(tAoVivo *aoVivo, const tJogo *jogo);
+/**
+ * @brief Adquire o instante atual de um relogio monotonico
+ *
+ * @return double O instante, em segundos
+ */
+double adquireSegundos();
+
+// FIM AOVIVO
+// MONTECARLO
+
+/**
+ * @brief A politica que sorteia qualquer um dos tres movimentos
+ * @related tResultadoMC
+ */
+#define MC_POL_A 0
+/**
+ * @brief A politica que sorteia apenas entre os movimentos que nao matam a cobra imediatamente
+ * @related tResultadoMC
+ */
+#define MC_POL_C 1
+/**
+ * @brief O fim de jogo por vitoria
+ * @related tResultadoMC
+ */
+#define MC_FIM_V 0
+/**
+ * @brief O fim de jogo por colisao com parede
+ * @related tResultadoMC
+ */
+#define MC_FIM_P 1
+/**
+ * @brief O fim de jogo por colisao com o proprio corpo
+ * @related tResultadoMC
+ */
+#define MC_FIM_C 2
+/**
+ * @brief O fim de jogo por atingir o limite de movimentos
+ * @related tResultadoMC
+ */
+#define MC_FIM_L 3
+/**
+ * @brief O fim de jogo, antecipado, por so restar comida inalcancavel ( @ref restaSoInalcancavel )
+ * @related tResultadoMC
+ */
+#define MC_FIM_I 4
+/**
+ * @brief Contem o numero de causas de fim de jogo, de @ref MC_FIM_V a @ref MC_FIM_I
+ * @related tResultadoMC
+ */
+#define MC_QTD_FINS 5
+/**
+ * @brief Contem o numero de faixas da distribuicao de movimentos sobrevividos
+ * @related tResultadoMC
+ */
+#define MC_FAIXAS 20
+/**
+ * @brief Contem o nome do arquivo de saida para o relatorio da simulacao de Monte Carlo
+ * @related tResultadoMC
+ */
+#define ARQ_MNTC "/montecarlo.txt"
+/**
+ * @brief Contem o nome do arquivo de saida para o heatmap agregado da simulacao de Monte Carlo
+ * @related tResultadoMC
+ */
+#define ARQ_HMMC "/heatmap_montecarlo.txt"
+/**
+ * @brief Representa os resultados agregados de um conjunto de jogos simulados
+ *
+ */
+typedef struct {
+    long long qtdJogos; ///< Numero de jogos simulados
+    long long qtdFins[MC_QTD_FINS]; ///< Numero de jogos por causa de fim, indexado por @ref MC_FIM_V , @ref MC_FIM_P , @ref MC_FIM_C , @ref MC_FIM_L e @ref MC_FIM_I
+    int qtdComida; ///< A quantidade de comidas do mapa
+    int qtdComidaInalcancavel; ///< A quantidade de comidas do mapa que a cobra nunca pode alcancar
+    int maxPontuacao; ///< A maior pontuacao possivel no mapa
+    long long *histPontuacao; ///< Numero de jogos por pontuacao final, de 0 a maxPontuacao
+    int limiteMov; ///< O limite de movimentos por jogo
+    long long *histMovimentos; ///< Numero de jogos por movimentos sobrevividos, de 0 a limiteMov
+    int nLinhas; ///< Numero de linhas do mapa
+    int mColunas; ///< Numero de colunas do mapa
+    long long *heatmap; ///< O heatmap somado de todos os jogos, indexado por i * mColunas + j
+} tResultadoMC;
+/**
+ * @brief Representa o trabalho de uma thread da simulacao de Monte Carlo
+ *
+ */
+typedef struct {
+    const tJogo *modelo; ///< O jogo recem inicializado, compartilhado e somente leitura
+    long long qtdJogos; ///< Numero de jogos que esta thread simula
+    int politica; ///< A politica de escolha dos movimentos, como @ref MC_POL_A
+    unsigned long long semente; ///< A semente da simulacao; o jogo de indice g usa um gerador proprio com semente + g
+    long long primeiroJogo; ///< O indice do primeiro jogo desta thread
+    tResultadoMC resultado; ///< Os resultados desta thread
+} tTrabalhadorMC;
+/**
+ * @brief Inicializa uma struct do tipo @ref tResultadoMC vazia para o jogo @p modelo
+ *
+ * @param modelo O @ref tJogo recem inicializado
+ * @param limiteMov O limite de movimentos por jogo
+ * @return tResultadoMC Uma nova instancia que deve ser liberada com @ref liberaResultadoMC
+ * @related tResultadoMC
+ */
+tResultadoMC inicializaResultadoMC(const tJogo *modelo, int limiteMov);
+/**
+ * @brief Registra um @p jogo terminado no @ref tResultadoMC @p resultado
+ *
+ * As celulas sujas do heatmap do @p jogo sao acumuladas e limpas no processo
+ *
+ * @param resultado O @ref tResultadoMC
+ * @param jogo O @ref tJogo terminado ou interrompido pelo limite de movimentos
+ * @related tResultadoMC
+ */
+void registraJogoMC(tResultadoMC *resultado, const tJogo *jogo);
+/**
+ * @brief Soma o @ref tResultadoMC @p origem ao @p destino
+ *
+ * @param destino O @ref tResultadoMC que recebera a soma
+ * @param origem O @ref tResultadoMC que sera somado
+ * @related tResultadoMC
+ */
+void mesclaResultadoMC(tResultadoMC *destino, const tResultadoMC *origem);
+/**
+ * @brief Libera a memoria de um @ref tResultadoMC
+ *
+ * @param resultado O @ref tResultadoMC
+ * @related tResultadoMC
+ */
+void liberaResultadoMC(tResultadoMC *resultado);
+/**
+ * @brief Escolhe o proximo movimento da cobra na @p partida segundo a @p politica
+ *
+ * @param mapa O @ref tMapa
+ * @param partida A @ref tPartida
+ * @param politica A politica, como @ref MC_POL_A
+ * @param gerador O @ref tAleatorio do jogo
+ * @return char O movimento escolhido
+ * @related tResultadoMC
+ */
+char escolheMovimentoMC(const tMapa *mapa, const tPartida *partida, int politica, tAleatorio *gerador);
+/**
+ * @brief Ponto de entrada de uma thread da simulacao: simula os jogos de um @ref tTrabalhadorMC
+ *
+ * @param arg O @ref tTrabalhadorMC
+ * @return void* Sempre NULL
+ * @related tResultadoMC
+ */
+void *executaTrabalhadorMC(void *arg);
+/**
+ * @brief Simula @p qtdJogos jogos no mapa do diretorio @p caminhoBase em @p qtdThreads threads e exporta os resultados
+ *
+ * Cada thread avanca seus jogos em lotes de @ref LOT_TAM ( @ref tLote ), cada jogo com seu proprio gerador;
+ * assim o resultado depende so da semente, e nao do numero de threads. Os resultados sao mesclados ao
+ * fim e exportados para @ref ARQ_MNTC e @ref ARQ_HMMC
+ *
+ * @param caminhoBase O diretorio do jogo
+ * @param qtdJogos O numero de jogos a simular
+ * @param qtdThreads O numero de threads
+ * @param limiteMov O limite de movimentos por jogo
+ * @param politica A politica de escolha dos movimentos, como @ref MC_POL_A
+ * @param semente A semente da simulacao
+ * @related tResultadoMC
+ */
+void simulaMonteCarlo(char caminhoBase[], long long qtdJogos, int qtdThreads, int limiteMov, int politica, unsigned long long semente);
+/**
+ * @brief Adquire o valor no percentil @p fracao de um histograma
+ *
+ * @param hist O histograma
+ * @param tam O numero de posicoes do histograma
+ * @param total A soma de todas as posicoes do histograma
+ * @param fracao O percentil, entre 0 e 1
+ * @return int A menor posicao cuja contagem acumulada atinge @p fracao do @p total
+ * @related tResultadoMC
+ */
+int adquirePercentil(const long long hist[], int tam, long long total, double fracao);
+/**
+ * @brief Exporta o relatorio do @ref tResultadoMC para @ref ARQ_MNTC e seu heatmap para @ref ARQ_HMMC
+ *
+ * @param resultado O @ref tResultadoMC
+ * @param caminhoSaida O diretorio de saida
+ * @related tResultadoMC
+ */
+void exportaMonteCarlo(const tResultadoMC *resultado, char caminhoSaida[]);
+
+// FIM MONTECARLO
+// AUTOPILOTO
+
+/**
+ * @brief Contem o nome do arquivo de saida para os movimentos gerados pelo autopiloto
+ * @related tBusca
+ */
+#define ARQ_MOVS "/movimentos.txt"
+/**
+ * @brief Representa os buffers reutilizaveis da busca em largura do autopiloto
+ *
+ * Um estado da busca e o par (celula, direcao), indexado por (i * mColunas + j) * 4 + direcao,
+ * ja que a direcao define quais movimentos sao possiveis e a saida dos tuneis
+ *
+ */
+typedef struct {
+    int nLinhas; ///< Numero de linhas do mapa para o qual os buffers foram alocados
+    int mColunas; ///< Numero de colunas do mapa para o qual os buffers foram alocados
+    int nPalavras; ///< Numero de palavras de 64 bits de cada conjunto de estados
+    unsigned long long *visitados; ///< Conjunto de bits dos estados ja visitados
+    unsigned long long *fronteira; ///< Conjunto de bits dos estados da camada atual
+    unsigned long long *proxima; ///< Conjunto de bits dos estados da proxima camada
+    int *pai; ///< O estado de onde cada estado visitado foi alcancado
+    char *movimentoPai; ///< O movimento que levou do pai a cada estado visitado
+    int *restante; ///< Por celula, quantos movimentos faltam para o corpo da cobra desocupa-la
+    char *caminho; ///< Os movimentos do ultimo caminho encontrado, em ordem
+    int tamCaminho; ///< O numero de movimentos em caminho
+} tBusca;
+/**
+ * @brief Aloca os buffers de uma @ref tBusca para um mapa de @p nLinhas x @p mColunas
+ *
+ * @param nLinhas Numero de linhas do mapa
+ * @param mColunas Numero de colunas do mapa
+ * @return tBusca* Uma nova instancia que deve ser liberada com @ref liberaBusca
+ * @related tBusca
+ */
+tBusca *inicializaBusca(int nLinhas, int mColunas);
+/**
+ * @brief Busca o menor caminho da cabeca da cobra ate a @ref CEL_COMID ou @ref CEL_DINHR mais proxima
+ *
+ * Respeita paredes, o corpo da cobra (que desocupa as celulas a medida que a cauda avanca),
+ * a volta pelas bordas e os tuneis. O caminho encontrado fica em caminho e tamCaminho
+ *
+ * @param busca A @ref tBusca, sem nenhuma alocacao durante a busca
+ * @param mapa O @ref tMapa
+ * @param partida A @ref tPartida
+ * @return int O numero de movimentos do caminho; 0, caso nenhuma comida ou dinheiro seja alcancavel
+ * @related tBusca
+ */
+int buscaComida(tBusca *busca, const tMapa *mapa, const tPartida *partida);
+/**
+ * @brief Libera a memoria de uma @ref tBusca
+ *
+ * @param busca A @ref tBusca
+ * @related tBusca
+ */
+void liberaBusca(tBusca *busca);
+/**
+ * @brief Joga no diretorio @p caminhoBase com o autopiloto e exporta os movimentos para @ref ARQ_MOVS
+ *
+ * O arquivo gerado segue o formato da entrada padrao do jogo. Caso o limite seja atingido antes
+ * do fim do jogo, ele termina sem encerrar o jogo
+ *
+ * @param caminhoBase O diretorio do jogo
+ * @param limiteMov O limite de movimentos
+ * @related tBusca
+ */
+void jogaAutopiloto(char caminhoBase[], int limiteMov);
+
+// FIM AUTOPILOTO
+// OTIMIZADOR
+
+/**
+ * @brief Contem o nome do arquivo de saida para o relatorio do otimizador
+ * @related tOtimizador
+ */
+#define ARQ_OTIM "/otimizacao.txt"
+/**
+ * @brief Contem o nome do arquivo de saida para a melhor sequencia de movimentos encontrada
+ * @related tOtimizador
+ */
+#define ARQ_MVOT "/movimentos_otimos.txt"
+/**
+ * @brief Representa um passo da historia do feixe: de qual estado da camada anterior veio e com qual movimento
+ *
+ */
+typedef struct {
+    int pai; ///< O indice do estado de origem na camada anterior
+    char movimento; ///< O movimento que levou ao estado
+} tPassoOt;
+/**
+ * @brief Representa a busca em feixe por sequencias de movimentos de maior pontuacao
+ *
+ */
+typedef struct {
+    const tMapa *mapa; ///< O mapa, compartilhado por todos os estados da busca
+    int largura; ///< A largura do feixe
+    int qtdThreads; ///< O numero de threads que expandem o feixe
+    int qtdFeixe; ///< O numero de estados no feixe atual
+    tPartida *feixe; ///< Os estados do feixe atual
+    tPartida *filhos; ///< Os filhos do feixe atual, 3 por estado, na ordem c, h, a
+    long *valores; ///< A avaliacao de cada filho; valores negativos marcam filhos que nao continuam no feixe
+    pthread_barrier_t inicio; ///< Barreira que libera as threads para expandir o feixe
+    pthread_barrier_t fim; ///< Barreira que espera todas as threads terminarem a expansao
+    int termina; ///< Verdadeiro quando as threads devem encerrar
+} tOtimizador;
+/**
+ * @brief Representa um filho vivo candidato ao proximo feixe
+ *
+ */
+typedef struct {
+    long valor; ///< A avaliacao do filho
+    int indice; ///< O indice do filho em filhos
+} tFilhoOt;
+/**
+ * @brief Representa o trabalho de uma thread do otimizador
+ *
+ */
+typedef struct {
+    tOtimizador *ot; ///< O @ref tOtimizador compartilhado
+    int id; ///< O indice da thread, de 0 a qtdThreads - 1
+} tTrabalhadorOt;
+/**
+ * @brief Avalia uma partida viva: a pontuacao pesa mais, e a distancia ao item restante mais proximo desempata
+ *
+ * @param ot O @ref tOtimizador
+ * @param partida A @ref tPartida
+ * @return long A avaliacao, nao negativa; maior e melhor
+ * @related tOtimizador
+ */
+long avaliaPartidaOt(const tOtimizador *ot, const tPartida *partida);
+/**
+ * @brief Ponto de entrada de uma thread do otimizador: expande sua fatia do feixe a cada camada
+ *
+ * @param arg O @ref tTrabalhadorOt
+ * @return void* Sempre NULL
+ * @related tOtimizador
+ */
+void *executaTrabalhadorOt(void *arg);
+/**
+ * @brief Compara dois @ref tFilhoOt pela avaliacao decrescente, desempatando pelo indice, no formato esperado pelo qsort
+ *
+ * @param f1 Ponteiro para o @ref tFilhoOt que sera comparado com @p f2
+ * @param f2 Ponteiro para o @ref tFilhoOt que sera comparado com @p f1
+ * @return int Negativo, caso @p f1 deva vir antes de @p f2 ; positivo, caso contrario
+ * @related tOtimizador
+ */
+int comparaFilhoOt(const void *f1, const void *f2);
+/**
+ * @brief Busca, por busca em feixe, a sequencia de movimentos de maior pontuacao no mapa do diretorio @p caminhoBase
+ *
+ * Exporta o relatorio para @ref ARQ_OTIM e a sequencia, no formato da entrada padrao do jogo, para @ref ARQ_MVOT
+ *
+ * @param caminhoBase O diretorio do jogo
+ * @param largura A largura do feixe
+ * @param limiteMov O numero maximo de movimentos da sequencia
+ * @param qtdThreads O numero de threads; 0 para o numero de nucleos
+ * @related tOtimizador
+ */
+void otimizaJogo(char caminhoBase[], int largura, int limiteMov, int qtdThreads);
+
+// FIM OTIMIZADOR
+// SERVIDOR
+
+/**
+ * @brief Contem o numero maximo de eventos tratados por chamada ao epoll_wait
+ * @related tServidor
+ */
+#define SRV_EVENTOS 256
+/**
+ * @brief Contem o tamanho do buffer de entrada de uma sessao; comporta um mapa inline de @ref TAM_MAPA x @ref TAM_MAPA
+ * @related tSessao
+ */
+#define SRV_ENTRADA (TAM_MAPA * (TAM_MAPA + 1) + 64)
+/**
+ * @brief Contem o numero maximo de mapas lidos por caminho mantidos em memoria pelo servidor
+ * @related tServidor
+ */
+#define SRV_CACHE 64
+/**
+ * @brief Contem o limite da saida pendente de uma sessao: acima dele a sessao deixa de ler e processar comandos ate o
+ * cliente receber as respostas; a resposta de um unico comando pode ultrapassa-lo
+ * @related tSessao
+ */
+#define SRV_SAIDA_MAX (64 * 1024)
+/**
+ * @brief Representa uma sessao de um cliente do servidor: um jogo sobre um mapa e os buffers da conexao
+ *
+ */
+typedef struct {
+    int fd; ///< O socket do cliente
+    int indice; ///< O indice da sessao no vetor de sessoes do servidor
+    const tMapa *mapa; ///< O mapa do jogo; NULL antes de MAPA ou INLINE
+    int possuiMapa; ///< Verdadeiro quando o mapa pertence a sessao, e nao ao cache do servidor
+    tPartida partida; ///< O estado do jogo
+    long long qtdMov; ///< A quantidade de movimentos feitos no jogo
+    int encerra; ///< Verdadeiro quando a sessao deve fechar assim que a saida for enviada
+    int fimEntrada; ///< Verdadeiro quando o cliente ja encerrou o envio
+    int falha; ///< Verdadeiro quando faltou memoria para a sessao, que e fechada sem enviar o restante da saida
+    int qtdEntrada; ///< Quantos bytes recebidos ainda nao foram processados
+    char entrada[SRV_ENTRADA]; ///< Os bytes recebidos ainda nao processados
+    int qtdSaida; ///< Quantos bytes de resposta ainda nao foram enviados
+    int capSaida; ///< A capacidade do buffer de saida
+    char *saida; ///< As respostas ainda nao enviadas
+} tSessao;
+/**
+ * @brief Representa um mapa lido por caminho e mantido em memoria pelo servidor
+ *
+ */
+typedef struct {
+    char caminho[TAM_CAMINHO]; ///< O diretorio do mapa
+    tMapa *mapa; ///< O mapa, compartilhado pelas sessoes
+} tMapaCache;
+/**
+ * @brief Representa o servidor de jogos em um socket de dominio Unix, com um laco de eventos epoll
+ *
+ * Protocolo em linhas de texto. Comandos do cliente:
+ * - "MAPA diretorio": le o mapa de diretorio/mapa.txt e inicia um jogo; responde "OK nLinhas mColunas qtdComida";
+ * - "INLINE nLinhas mColunas" seguido das nLinhas linhas do mapa: inicia um jogo com o mapa enviado;
+ * - "NOVO": reinicia o jogo no mesmo mapa; responde como MAPA;
+ * - "M movimentos": faz cada movimento (c, h ou a); responde, por movimento, "R movimento pontuacao estado devorado",
+ *   com o devorado '.' quando nada foi devorado;
+ * - "FIM": encerra a sessao.
+ * Erros sao respondidos com "ERRO mensagem"
+ *
+ */
+typedef struct {
+    int fdEscuta; ///< O socket que aceita conexoes
+    int fdSinal; ///< O signalfd de SIGINT e SIGTERM, que encerram o servidor
+    int epoll; ///< A instancia do epoll
+    int qtdSessoes; ///< O numero de sessoes abertas
+    int capSessoes; ///< A capacidade do vetor de sessoes
+    tSessao **sessoes; ///< As sessoes abertas
+    int qtdCache; ///< O numero de mapas no cache
+    tMapaCache cache[SRV_CACHE]; ///< Os mapas lidos por caminho
+} tServidor;
+/**
+ * @brief Executa o servidor no socket @p caminhoSocket ate receber SIGINT ou SIGTERM
+ *
+ * @param caminhoSocket O caminho do socket de dominio Unix; um arquivo existente e substituido
+ * @related tServidor
+ */
+void executaServidor(const char caminhoSocket[]);
+/**
+ * @brief Aceita todas as conexoes pendentes, abrindo uma @ref tSessao para cada
+ *
+ * @param servidor O @ref tServidor
+ * @related tServidor
+ */
+void aceitaSessoes(tServidor *servidor);
+/**
+ * @brief Fecha a conexao da @ref tSessao @p sessao e a libera
+ *
+ * @param servidor O @ref tServidor
+ * @param sessao A @ref tSessao
+ * @related tServidor
+ */
+void fechaSessao(tServidor *servidor, tSessao *sessao);
+/**
+ * @brief Le o que o cliente enviou e processa os comandos completos, enquanto a saida pendente nao exceder @ref SRV_SAIDA_MAX
+ *
+ * @param servidor O @ref tServidor
+ * @param sessao A @ref tSessao
+ * @related tServidor
+ */
+void leSessao(tServidor *servidor, tSessao *sessao);
+/**
+ * @brief Processa os comandos completos do buffer de entrada da @ref tSessao , deixando nele apenas o incompleto
+ *
+ * @param servidor O @ref tServidor
+ * @param sessao A @ref tSessao
+ * @related tServidor
+ */
+void processaEntrada(tServidor *servidor, tSessao *sessao);
+/**
+ * @brief Faz os @p movimentos no jogo da @ref tSessao , respondendo o resultado de cada um
+ *
+ * @param sessao A @ref tSessao
+ * @param movimentos Os movimentos, terminados em '\0'
+ * @related tSessao
+ */
+void jogaSessao(tSessao *sessao, const char movimentos[]);
+/**
+ * @brief Troca o mapa da @ref tSessao e inicia um novo jogo nele
+ *
+ * @param sessao A @ref tSessao
+ * @param mapa O novo mapa
+ * @param possuiMapa Verdadeiro, caso o mapa passe a pertencer a sessao
+ * @related tSessao
+ */
+void iniciaSessao(tSessao *sessao, const tMapa *mapa, int possuiMapa);
+/**
+ * @brief Acrescenta o texto formatado ao buffer de saida da @ref tSessao , no estilo do printf
+ *
+ * @param sessao A @ref tSessao
+ * @param formato O formato
+ * @related tSessao
+ */
+void respondeSessao(tSessao *sessao, const char *formato, ...) __attribute__((format(printf, 2, 3)));
+/**
+ * @brief Envia o que for possivel do buffer de saida, esperando por EPOLLOUT se o socket estiver cheio
+ *
+ * @param servidor O @ref tServidor
+ * @param sessao A @ref tSessao
+ * @return int Verdadeiro, caso a sessao continue aberta
+ * @related tServidor
+ */
+int escreveSessao(tServidor *servidor, tSessao *sessao);
+/**
+ * @brief Adquire o mapa do diretorio @p caminho , lendo-o apenas na primeira vez enquanto houver espaco no cache
+ *
+ * @param servidor O @ref tServidor
+ * @param caminho O diretorio do mapa
+ * @param possuiMapa Recebe verdadeiro quando o mapa nao ficou no cache e pertence a quem o pediu
+ * @return tMapa* O mapa; NULL, caso nao exista ou seja invalido
+ * @related tServidor
+ */
+tMapa *carregaMapa(tServidor *servidor, char caminho[], int *possuiMapa);
+
+// FIM SERVIDOR
+// AGREGADOR
+
+/**
+ * @brief Contem o nome do arquivo de saida para a media, por celula, dos heatmaps agregados
+ * @related tAgregado
+ */
+#define ARQ_HMMD "/heatmap_media.txt"
+/**
+ * @brief Contem o nome do arquivo de saida para o maximo, por celula, dos heatmaps agregados
+ * @related tAgregado
+ */
+#define ARQ_HMMX "/heatmap_maximo.txt"
+/**
+ * @brief Contem o nome do arquivo de saida para o percentil, por celula, dos heatmaps agregados
+ * @related tAgregado
+ */
+#define ARQ_HMPC "/heatmap_percentil.txt"
+/**
+ * @brief Contem o retorno de @ref agregaHeatmaps e @ref leHeatmapArquivo quando falta memoria
+ * @related tAgregado
+ */
+#define AGR_SEM_MEMORIA -2
+/**
+ * @brief Representa o agregado de varios heatmaps do mesmo mapa, celula a celula, indexado por i * mColunas + j
+ *
+ */
+typedef struct {
+    int nLinhas; ///< Numero de linhas do mapa
+    int mColunas; ///< Numero de colunas do mapa
+    int qtdHeatmaps; ///< Numero de heatmaps agregados
+    long long *soma; ///< A soma dos heatmaps
+    long long *maximo; ///< O maior valor entre os heatmaps
+    double *media; ///< A media dos heatmaps
+    long long *percentil; ///< O percentil pedido, pelo metodo do posto mais proximo; NULL quando nenhum foi pedido
+} tAgregado;
+/**
+ * @brief Representa o trabalho de uma thread da agregacao, que le um bloco de arquivos e depois reduz um bloco de linhas
+ *
+ */
+typedef struct {
+    const char *const *arquivos; ///< Todos os arquivos, compartilhados e somente leitura
+    int qtdArquivos; ///< O numero total de arquivos
+    int primeiroArquivo; ///< O indice do primeiro arquivo que esta thread le
+    int fimArquivos; ///< O indice seguinte ao do ultimo arquivo que esta thread le
+    int primeiraLinha; ///< A primeira linha que esta thread reduz
+    int fimLinhas; ///< A linha seguinte a ultima que esta thread reduz
+    int id; ///< O indice desta thread
+    int qtdThreads; ///< O numero de threads
+    long long *somas; ///< Compartilhado: a soma parcial dos arquivos de cada thread, em thread * nCelulas + celula
+    long long *maximos; ///< Compartilhado: o maximo parcial dos arquivos de cada thread, em thread * nCelulas + celula
+    long long *valores; ///< Compartilhado: o valor de cada arquivo em cada celula, em celula * qtdArquivos + arquivo; NULL sem percentil
+    int invalido; ///< O indice do primeiro arquivo invalido desta thread; -1 se nenhum
+    int semMemoria; ///< Se faltou memoria para ler algum arquivo desta thread
+    double percentil; ///< O percentil pedido, entre 0 e 100; 0 para nenhum
+    tAgregado *agregado; ///< O @ref tAgregado que a reducao preenche
+} tTrabalhadorAg;
+/**
+ * @brief Agrega, em @p qtdThreads threads, os heatmaps dos @p arquivos : cada thread soma um bloco de arquivos, e depois um bloco de linhas das parciais
+ *
+ * Cada arquivo pode estar em qualquer formato de heatmap do programa: texto, como @ref ARQ_HMAP ou @ref ARQ_HMMC ,
+ * heatmap vivo ( @ref ARQ_HMVV ) ou serie ( @ref ARQ_SERI ), cujos snapshots sao somados. O percentil guarda o valor
+ * de cada arquivo em cada celula, ocupando memoria proporcional a celulas x arquivos
+ *
+ * @param arquivos Os caminhos dos arquivos
+ * @param qtdArquivos O numero de arquivos, positivo
+ * @param qtdThreads O numero de threads; 0 ou negativo para o numero de nucleos
+ * @param percentil O percentil a calcular, entre 0 (exclusive) e 100; 0 para nenhum
+ * @param agregado Recebe o agregado, apenas em caso de sucesso; deve ser liberado com @ref liberaAgregado
+ * @return int -1 em caso de sucesso; @ref AGR_SEM_MEMORIA , caso falte memoria; o indice do primeiro arquivo invalido
+ * ou com dimensoes diferentes das do primeiro, caso contrario
+ * @related tAgregado
+ */
+int agregaHeatmaps(const char *const arquivos[], int qtdArquivos, int qtdThreads, double percentil, tAgregado *agregado);
+/**
+ * @brief Ponto de entrada de uma thread da agregacao: soma os arquivos de um @ref tTrabalhadorAg
+ *
+ * @param arg O @ref tTrabalhadorAg
+ * @return void* Sempre NULL
+ * @related tAgregado
+ */
+void *executaLeituraAg(void *arg);
+/**
+ * @brief Ponto de entrada de uma thread da agregacao: reduz as parciais de todas as threads nas linhas de um @ref tTrabalhadorAg
+ *
+ * @param arg O @ref tTrabalhadorAg
+ * @return void* Sempre NULL
+ * @related tAgregado
+ */
+void *executaReducaoAg(void *arg);
+/**
+ * @brief Compara dois long long, no formato esperado pelo qsort
+ *
+ * @param v1 Ponteiro para o valor que sera comparado com @p v2
+ * @param v2 Ponteiro para o valor que sera comparado com @p v1
+ * @return int Negativo, caso @p v1 seja menor que @p v2 ; zero, caso sejam iguais; positivo, caso contrario
+ * @related tAgregado
+ */
+int comparaValorAg(const void *v1, const void *v2);
+/**
+ * @brief Le o heatmap do arquivo @p caminho , em qualquer formato aceito por @ref agregaHeatmaps
+ *
+ * @param caminho O caminho do arquivo
+ * @param nLinhas Recebe o numero de linhas
+ * @param mColunas Recebe o numero de colunas
+ * @param contagens Recebe os contadores, indexados por i * mColunas + j; com espaco para @ref TAM_MAPA x @ref TAM_MAPA
+ * @return int 0 em caso de sucesso; -1, caso o arquivo nao possa ser lido ou seja invalido; @ref AGR_SEM_MEMORIA , caso falte memoria
+ * @related tAgregado
+ */
+int leHeatmapArquivo(const char caminho[], int *nLinhas, int *mColunas, long long contagens[]);
+/**
+ * @brief Le um heatmap em texto, como @ref ARQ_HMAP : uma linha por linha do mapa, com os contadores separados por espaco
+ *
+ * @param texto O texto, terminado em '\0'
+ * @param nLinhas Recebe o numero de linhas
+ * @param mColunas Recebe o numero de colunas
+ * @param contagens Recebe os contadores
+ * @return int 0 em caso de sucesso; -1, caso o texto seja invalido
+ * @related tAgregado
+ */
+int leHeatmapTexto(const char texto[], int *nLinhas, int *mColunas, long long contagens[]);
+/**
+ * @brief Le um heatmap vivo, como @ref ARQ_HMVV : um @ref tCabecalhoVivo seguido dos contadores de 64 bits
+ *
+ * @param dados O conteudo do arquivo
+ * @param tam O numero de bytes de @p dados
+ * @param nLinhas Recebe o numero de linhas
+ * @param mColunas Recebe o numero de colunas
+ * @param contagens Recebe os contadores
+ * @return int 0 em caso de sucesso; -1, caso o conteudo seja invalido
+ * @related tAgregado
+ */
+int leHeatmapVivo(const unsigned char dados[], size_t tam, int *nLinhas, int *mColunas, long long contagens[]);
+/**
+ * @brief Le a serie de um heatmap, como @ref ARQ_SERI , somando todos os seus snapshots
+ *
+ * @param dados O conteudo do arquivo
+ * @param tam O numero de bytes de @p dados
+ * @param nLinhas Recebe o numero de linhas
+ * @param mColunas Recebe o numero de colunas
+ * @param contagens Recebe os contadores
+ * @return int 0 em caso de sucesso; -1, caso o conteudo seja invalido
+ * @related tAgregado
+ */
+int leHeatmapSerie(const unsigned char dados[], size_t tam, int *nLinhas, int *mColunas, long long contagens[]);
+/**
+ * @brief Exporta o @ref tAgregado : a soma para @ref ARQ_HMAP , @ref ARQ_RANK e, com regioes, @ref ARQ_REGI , e a media, o maximo e o percentil para @ref ARQ_HMMD , @ref ARQ_HMMX e @ref ARQ_HMPC
+ *
+ * @param agregado O @ref tAgregado
+ * @param regioes Os retangulos do relatorio de regioes da soma; NULL para nenhum
+ * @param qtdRegioes O numero de retangulos
+ * @param caminhoSaida O diretorio de saida
+ * @related tAgregado
+ */
+void exportaAgregado(const tAgregado *agregado, const tRegiao regioes[], int qtdRegioes, char caminhoSaida[]);
+/**
+ * @brief Agrega os heatmaps cujos caminhos sao lidos da entrada padrao, um por linha, e exporta o agregado para o diretorio de saida
+ *
+ * @param caminhoBase O diretorio cujo subdiretorio @ref DIR_SAID recebe o agregado
+ * @param qtdThreads O numero de threads; 0 para o numero de nucleos
+ * @param percentil O percentil a exportar, entre 0 (exclusive) e 100; 0 para nenhum
+ * @param regioes Os retangulos do relatorio de regioes da soma; NULL para nenhum
+ * @param qtdRegioes O numero de retangulos
+ * @related tAgregado
+ */
+void agregaEntrada(char caminhoBase[], int qtdThreads, double percentil, const tRegiao regioes[], int qtdRegioes);
+/**
+ * @brief Libera a memoria de um @ref tAgregado
+ *
+ * @param agregado O @ref tAgregado
+ * @related tAgregado
+ */
+void liberaAgregado(tAgregado *agregado);
+
+// FIM AGREGADOR
+// BIBLIOTECA
+
+/**
+ * @brief Representa, por tras da API de JheamStorchRoss.h, um @ref tJogo com o resumo opcionalmente mantido em memoria
+ *
+ */
+struct jsrJogo {
+    tJogo jogo; ///< O jogo; seu resumo e um open_memstream sobre textoResumo, ou NULL ate @ref jsrDefineResumo
+    tExportador *exportador; ///< O exportador dos arquivos; NULL enquanto a saida nao e definida
+    char *textoResumo; ///< O texto do resumo, atualizado a cada fflush do resumo do jogo
+    size_t tamResumo; ///< O tamanho de textoResumo
+    tIntegral *integral; ///< A tabela de somas do heatmap para @ref jsrSomaRegiao ; NULL ate a primeira consulta
+    long long movIntegral; ///< Quantos movimentos o heatmap tinha quando integral foi construida
+};
+/**
+ * @brief Adquire o @ref tJogo por tras de um @ref jsrJogo , para a linha de comando desenhar seus quadros
+ *
+ * @param motor O @ref jsrJogo
+ * @return const tJogo* O jogo, valido ate @ref jsrLiberaJogo e atualizado a cada @ref jsrJoga
+ * @related tJogo
+ */
+const tJogo *adquireJogo(const jsrJogo *motor);
+/**
+ * @brief Falha a compilacao caso os estados da API deixem de ser os do @ref tJogo , que @ref jsrConsulta repassa direto
+ *
+ */
+typedef char jsrEstadosIguais[JSR_EST_CONTINUA == JOG_EST_C && JSR_EST_VITORIA == JOG_EST_V && JSR_EST_DERROTA == JOG_EST_D ? 1 : -1];
+/**
+ * @brief Falha a compilacao caso os tipos de evento da API deixem de ser os do @ref tEvento
+ *
+ */
+typedef char jsrTiposIguais[JSR_EVT_COMIDA == EVT_COMIDA && JSR_EVT_DINHEIRO == EVT_DINHEIRO && JSR_EVT_PAREDE == EVT_PAREDE &&
+                            JSR_EVT_CORPO == EVT_CORPO && JSR_EVT_VITORIA == EVT_VITORIA ? 1 : -1];
+/**
+ * @brief Falha a compilacao caso o @ref jsrEvento deixe de ter o leiaute do @ref tEvento , que @ref jsrRegistraTratador repassa direto
+ *
+ */
+typedef char jsrEventosIguais[sizeof(jsrEvento) == sizeof(tEvento) &&
+                              offsetof(jsrEvento, movimento) == offsetof(tEvento, movimento) &&
+                              offsetof(jsrEvento, pontuacao) == offsetof(tEvento, pontuacao) &&
+                              offsetof(jsrEvento, tamanho) == offsetof(tEvento, tamanho) &&
+                              offsetof(jsrEvento, tipo) == offsetof(tEvento, tipo) &&
+                              offsetof(jsrEvento, comando) == offsetof(tEvento, comando) ? 1 : -1];
+/**
+ * @brief Cria, pela API, o jogo do diretorio @p caminhoBase com saida em seu subdiretorio @ref DIR_SAID , como a linha de comando
+ *
+ * @param caminhoBase O diretorio onde o jogo ocorre e todos os seus dados estao
+ * @param intervaloSerie A cada quantos movimentos exportar um snapshot do heatmap; 0 para nenhum
+ * @return jsrJogo* O jogo; encerra o programa caso o mapa nao exista ou seja invalido
+ * @related tJogo
+ */
+jsrJogo *abreJogo(char caminhoBase[], int intervaloSerie);
+/**
+ * @brief Falha a compilacao caso o @ref jsrAgregado deixe de ter o leiaute do @ref tAgregado , que @ref jsrAgregaHeatmaps preenche direto
+ *
+ */
+typedef char jsrAgregadosIguais[sizeof(jsrAgregado) == sizeof(tAgregado) &&
+                                offsetof(jsrAgregado, nLinhas) == offsetof(tAgregado, nLinhas) &&
+                                offsetof(jsrAgregado, mColunas) == offsetof(tAgregado, mColunas) &&
+                                offsetof(jsrAgregado, qtdHeatmaps) == offsetof(tAgregado, qtdHeatmaps) &&
+                                offsetof(jsrAgregado, soma) == offsetof(tAgregado, soma) &&
+                                offsetof(jsrAgregado, maximo) == offsetof(tAgregado, maximo) &&
+                                offsetof(jsrAgregado, media) == offsetof(tAgregado, media) &&
+                                offsetof(jsrAgregado, percentil) == offsetof(tAgregado, percentil) ? 1 : -1];
+
+// FIM BIBLIOTECA
+// OPCOES
+
+/**
+ * @brief Contem o bit do modo de a reproducao dos movimentos da entrada padrao, quando nenhuma opcao de modo e informada
+ * @related tOpcoes
+ */
+#define OPC_REPRODUCAO 0x001
+/**
+ * @brief Contem o bit do modo escolhido por "--reconstroi"
+ * @related tOpcoes
+ */
+#define OPC_RECONSTROI 0x002
+/**
+ * @brief Contem o bit do modo escolhido por "--servidor"
+ * @related tOpcoes
+ */
+#define OPC_SERVIDOR 0x004
+/**
+ * @brief Contem o bit do modo escolhido por "--agrega"
+ * @related tOpcoes
+ */
+#define OPC_AGREGA 0x008
+/**
+ * @brief Contem o bit do modo escolhido por "--montecarlo"
+ * @related tOpcoes
+ */
+#define OPC_MONTECARLO 0x010
+/**
+ * @brief Contem o bit do modo escolhido por "--autopiloto"
+ * @related tOpcoes
+ */
+#define OPC_AUTOPILOTO 0x020
+/**
+ * @brief Contem o bit do modo escolhido por "--otimiza"
+ * @related tOpcoes
+ */
+#define OPC_OTIMIZA 0x040
+/**
+ * @brief Contem o bit do modo escolhido por "--indice"
+ * @related tOpcoes
+ */
+#define OPC_INDICE 0x080
+/**
+ * @brief Contem o bit do modo escolhido por "--quadros"
+ * @related tOpcoes
+ */
+#define OPC_QUADROS 0x100
+/**
+ * @brief Representa, para @ref leOpcoes , uma opcao de linha de comando e os modos em que ela vale
+ *
+ */
+typedef struct {
+    const char *texto; ///< A opcao, como "--serie"
+    int modo; ///< O bit do modo que a opcao escolhe, como @ref OPC_MONTECARLO ; 0 para uma opcao que nao escolhe modo
+    int modos; ///< Os bits dos modos em que a opcao vale
+} tRegraOpcao;
+/**
+ * @brief Representa as opcoes de linha de comando que seguem o diretorio do jogo
+ *
+ */
+typedef struct {
+    int intervaloSerie; ///< Valor de "--serie N": a cada quantos movimentos exportar um snapshot do heatmap
+    long long qtdJogosMC; ///< Valor de "--montecarlo N": quantos jogos simular; 0 para jogar com a entrada padrao
+    int qtdThreads; ///< Valor de "--threads T": quantas threads usar; 0 para o numero de nucleos
+    int limiteMov; ///< Valor de "--limite L": o limite de movimentos por jogo simulado
+    int politica; ///< Valor de "--politica aleatoria|cautelosa"
+    unsigned long long semente; ///< Valor de "--semente S"
+    int autopiloto; ///< Presenca de "--autopiloto": gerar os movimentos em vez de le-los
+    int otimiza; ///< Presenca de "--otimiza": buscar a sequencia de movimentos de maior pontuacao
+    int largura; ///< Valor de "--feixe W": a largura do feixe do otimizador
+    int deltas; ///< Presenca de "--deltas": imprimir quadros delta em vez do tabuleiro completo
+    int intervaloChave; ///< Valor de "--chave K": a cada quantos movimentos imprimir um quadro-chave nos quadros delta
+    int reconstroi; ///< Presenca de "--reconstroi": ler quadros delta da entrada padrao e imprimir os tabuleiros completos
+    int aoVivo; ///< Presenca de "--ao-vivo": animar o jogo no terminal com sequencias ANSI
+    int fps; ///< Valor de "--fps F": a taxa maxima de quadros por segundo do modo ao vivo
+    const char *caminhoSocket; ///< Valor de "--servidor CAMINHO": o socket em que servir jogos; NULL para jogar localmente
+    int infinito; ///< Presenca de "--infinito": a comida devorada renasce numa celula sorteada com a semente de "--semente"
+    int heatmapVivo; ///< Presenca de "--heatmap-vivo": manter o heatmap num arquivo mapeado, atualizado a cada movimento
+    int eventos; ///< Presenca de "--eventos": registrar tambem os eventos, em binario, no arquivo @ref ARQ_EVTS
+    const char *caminhoCache; ///< Valor de "--cache DIR": o cache de resultados das reproducoes; NULL para sempre simular
+    int intervaloIndice; ///< Valor de "--indice N": indexar o replay da entrada padrao com um ponto de controle a cada N movimentos
+    long long primeiroQuadro; ///< Valor de "--quadros A[-B]": o primeiro movimento cujo quadro imprimir a partir do indice; 0 para nenhum
+    long long ultimoQuadro; ///< Valor de "--quadros A[-B]": o ultimo movimento cujo quadro imprimir a partir do indice
+    int agrega; ///< Presenca de "--agrega": agregar os heatmaps cujos caminhos sao lidos da entrada padrao
+    double percentil; ///< Valor de "--percentil P": o percentil por celula a exportar na agregacao; 0 para nenhum
+    const char *caminhoRegioes; ///< Valor de "--regioes ARQ": os retangulos do relatorio de regioes; NULL para nenhum
+} tOpcoes;
+/**
+ * @brief Le as opcoes de linha de comando a partir do terceiro argumento
+ *
+ * @param argc O numero de argumentos
+ * @param argv Os argumentos
+ * @return tOpcoes As opcoes lidas; encerra o programa caso alguma seja invalida ou nao valha no modo escolhido
+ * @related tOpcoes
+ */
+tOpcoes leOpcoes(int argc, char const *argv[]);
+
+// FIM OPCOES
+// CACHE
+
+/**
+ * @brief Contem o nome, no diretorio de cada entrada do cache, do arquivo com a saida padrao da reproducao
+ * @related tCache
+ */
+#define ARQ_CSAI "/saida.txt"
+/**
+ * @brief Contem o modelo, para mkdtemp, do diretorio em que uma entrada do cache e montada antes de ser publicada
+ * @related tCache
+ */
+#define DIR_CTMP "/.tmp-XXXXXX"
+/**
+ * @brief Contem a versao do motor e dos arquivos de saida que entra na chave do cache
+ *
+ * E independente da versao da API: deve mudar sempre que os mesmos mapa, opcoes e movimentos passarem a produzir
+ * outra saida padrao ou outros arquivos, invalidando as entradas antigas
+ *
+ * @related tCache
+ */
+#define CCH_VERSAO "3"
+/**
+ * @brief Lista, para inicializar um vetor de caminhos, os arquivos de saida de uma reproducao guardados em cada entrada do cache
+ * @related tCache
+ */
+#define CCH_ARQUIVOS ARQ_INIC, ARQ_RESM, ARQ_EVTS, "/" ARQ_STTS, ARQ_HMAP, ARQ_RANK, ARQ_SERI
+/**
+ * @brief Contem o tipo da entrada do cache cujo jogo acabou dentro dos movimentos: vale para qualquer entrada com o mesmo inicio
+ * @related tCache
+ */
+#define CCH_TIP_F 'f'
+/**
+ * @brief Contem o tipo da entrada do cache cujos movimentos acabaram antes do jogo: vale para a mesma entrada ou como prefixo
+ * @related tCache
+ */
+#define CCH_TIP_E 'e'
+/**
+ * @brief Representa uma chave de 128 bits do cache, acumulada sobre os bytes que determinam uma reproducao
+ *
+ * Nao e um hash criptografico: protege contra colisoes acidentais, nao contra entradas construidas
+ *
+ */
+typedef struct {
+    unsigned long long a; ///< A primeira metade, um FNV-1a de 64 bits
+    unsigned long long b; ///< A segunda metade, uma mistura independente por multiplicacao e rotacao
+} tChaveCache;
+/**
+ * @brief Cria uma @ref tChaveCache vazia
+ *
+ * @return tChaveCache A chave
+ * @related tChaveCache
+ */
+tChaveCache criaChaveCache(void);
+/**
+ * @brief Acumula na @p chave os @p tam bytes de @p dados e o proprio tamanho, separando-os do proximo trecho
+ *
+ * @param chave A @ref tChaveCache
+ * @param dados Os bytes
+ * @param tam O numero de bytes
+ * @related tChaveCache
+ */
+void acrescentaChaveCache(tChaveCache *chave, const void *dados, size_t tam);
+/**
+ * @brief Escreve a @p chave como 32 digitos hexadecimais e um '\0'
+ *
+ * @param chave A @ref tChaveCache
+ * @param texto Recebe os 33 caracteres
+ * @related tChaveCache
+ */
+void formataChaveCache(tChaveCache chave, char texto[]);
+/**
+ * @brief Calcula a @ref tChaveCache da versao do motor e dos bytes do arquivo @ref ARQ_MAPA do diretorio @p caminhoBase
+ *
+ * @param caminhoBase O diretorio do jogo
+ * @return tChaveCache A chave; encerra o programa caso o mapa nao exista
+ * @related tChaveCache
+ */
+tChaveCache calculaChaveMapa(char caminhoBase[]);
+/**
+ * @brief Representa o cache de resultados das reproducoes da linha de comando, enderecado pelo conteudo
+ *
+ * Cada mapa, com a versao do motor ( @ref CCH_VERSAO ) e as opcoes que alteram a saida, tem um diretorio cuja chave os resume;
+ * nele, cada entrada e um diretorio "chave-L-tipo-O-Q" com a saida padrao e os arquivos de saida de uma reproducao,
+ * onde chave resume os L primeiros bytes dos movimentos, lidos pelo jogo, e O e Q sao o tamanho da saida padrao e o numero
+ * de quadros impressos ate o fim dos movimentos ou do jogo. L e Q sao medidos na leitura, e nao deduzidos um do outro:
+ * quebras de linha CRLF ou linhas em branco nao mudam o ponto em que o prefixo e retomado.
+ * Uma entrada cujos movimentos acabaram antes do jogo e o prefixo de movimentos acrescentados depois: seus quadros
+ * sao copiados, e o jogo e refeito sem desenha-los, o que custa bem menos que imprimi-los.
+ * As entradas sao montadas num diretorio temporario e publicadas com rename, de modo que execucoes simultaneas
+ * nunca veem uma entrada pela metade
+ *
+ */
+typedef struct {
+    char caminho[TAM_CAMINHO]; ///< O diretorio das entradas do mapa e das opcoes
+    char caminhoSaida[TAM_CAMINHO]; ///< O diretorio de saida do jogo
+    char temporario[TAM_CAMINHO]; ///< O diretorio em que a nova entrada e montada
+    char prefixo[TAM_CAMINHO]; ///< A entrada cujos quadros iniciam a reproducao; "" quando nenhuma
+    char *movimentos; ///< Toda a entrada padrao
+    size_t tamMovimentos; ///< O numero de bytes de movimentos
+    FILE *entrada; ///< A entrada dos movimentos, lida de movimentos em vez da entrada padrao
+    long long qtdPulados; ///< Quantos quadros, ainda por imprimir, ja vieram da entrada prefixo
+    long long qtdQuadros; ///< Quantos quadros passaram por @ref pulaQuadro
+    long long quadrosEntrada; ///< O valor de qtdQuadros quando os movimentos acabaram
+    long tamPrefixo; ///< O tamanho da saida padrao da entrada prefixo quando seus movimentos acabaram
+    long fimEntrada; ///< O tamanho da saida padrao quando os movimentos acabaram; -1 enquanto nao acabam
+    int saidaOriginal; ///< O descritor da saida padrao original, enquanto a saida padrao e capturada; -1 fora disso
+} tCache;
+/**
+ * @brief Abre o cache em @p caminhoCache para a reproducao do jogo em @p caminhoBase , lendo toda a entrada padrao
+ *
+ * @param caminhoCache O diretorio do cache, criado se nao existir
+ * @param caminhoBase O diretorio do jogo
+ * @param opcoes As opcoes da linha de comando
+ * @return tCache* O cache; encerra o programa caso o mapa nao exista ou o cache nao possa ser criado
+ * @related tCache
+ */
+tCache *abreCache(const char caminhoCache[], char caminhoBase[], tOpcoes opcoes);
+/**
+ * @brief Procura uma entrada que valha para os movimentos: copia seus arquivos para a saida, se houver; senao, escolhe o maior prefixo
+ *
+ * Os arquivos sao copiados, e nao ligados, porque o motor acrescenta ao resumo e aos eventos existentes:
+ * uma ligacao escreveria, na proxima execucao sem cache, dentro da propria entrada
+ *
+ * @param cache O @ref tCache
+ * @param deltas Verdadeiro, caso os quadros sejam deltas, que nao podem comecar de um prefixo
+ * @return int Verdadeiro, caso a reproducao ja tenha sido servida pelo cache
+ * @related tCache
+ */
+int serveCache(tCache *cache, int deltas);
+/**
+ * @brief Passa a capturar a saida padrao na entrada temporaria, comecando pelos quadros da entrada prefixo, se houver
+ *
+ * @param cache O @ref tCache
+ * @related tCache
+ */
+void capturaSaida(tCache *cache);
+/**
+ * @brief Conta o quadro do movimento atual e indica se ele ja veio da entrada prefixo
+ *
+ * @param cache O @ref tCache ; pode ser NULL
+ * @return int Verdadeiro, caso o quadro nao deva ser impresso
+ * @related tCache
+ */
+int pulaQuadro(tCache *cache);
+/**
+ * @brief Registra que os movimentos acabaram, guardando o tamanho da saida padrao e o numero de quadros ate aqui
+ *
+ * @param cache O @ref tCache ; pode ser NULL
+ * @related tCache
+ */
+void marcaFimEntrada(tCache *cache);
+/**
+ * @brief Encerra a captura, repassando a saida padrao, e publica a reproducao como uma nova entrada do cache
+ *
+ * Deve ser chamada depois que todos os arquivos de saida foram escritos
+ *
+ * @param cache O @ref tCache
+ * @related tCache
+ */
+void registraCache(tCache *cache);
+/**
+ * @brief Libera o @ref tCache
+ *
+ * @param cache O @ref tCache
+ * @related tCache
+ */
+void liberaCache(tCache *cache);
+/**
+ * @brief Copia o arquivo @p origem para @p destino , substituindo-o, ate @p limite bytes
+ *
+ * @param origem O caminho do arquivo copiado
+ * @param destino O caminho da copia; NULL para a saida padrao
+ * @param limite O numero maximo de bytes; -1 para o arquivo todo
+ * @return int Verdadeiro em caso de sucesso; falso se a @p origem nao existir ou a copia falhar
+ * @related tCache
+ */
+int copiaArquivo(const char origem[], const char destino[], long limite);
+/**
+ * @brief Remove o diretorio @p caminho e os arquivos nele
+ *
+ * @param caminho O diretorio
+ * @related tCache
+ */
+void removeDiretorio(const char caminho[]);
+
+// FIM CACHE
+// INDICE
+
+/**
+ * @brief Contem o nome do arquivo de saida com o indice de um replay, gerado por @ref indexaReplay
+ * @related tCabecalhoIndice
+ */
+#define ARQ_INDC "/indice.bin"
+/**
+ * @brief Contem a assinatura, com o '\0' final, que inicia o arquivo @ref ARQ_INDC
+ * @related tCabecalhoIndice
+ */
+#define IDX_ASSN "JSRIDX2"
+/**
+ * @brief Representa o cabecalho do arquivo @ref ARQ_INDC
+ *
+ * Segue-se a ele um ponto de controle a cada intervalo movimentos, a partir do inicio do jogo: um @ref tPontoPartida ,
+ * as partes do corpo e as qtdPalavras palavras usadas de consumidos. Como o corpo cresce, os pontos tem tamanhos diferentes;
+ * depois deles, um byte por movimento do replay, incluindo os repetidos depois do fim da entrada, e, por fim, a posicao
+ * de cada ponto no arquivo, como long long. Todos os inteiros estao na ordem de bytes da maquina
+ *
+ */
+typedef struct {
+    char assinatura[8]; ///< A assinatura @ref IDX_ASSN
+    unsigned long long chaveA; ///< A primeira metade da @ref tChaveCache do mapa e da versao do motor
+    unsigned long long chaveB; ///< A segunda metade da @ref tChaveCache do mapa e da versao do motor
+    int intervalo; ///< A cada quantos movimentos ha um ponto de controle
+    int qtdPalavras; ///< Quantas palavras de consumidos seguem cada @ref tPontoPartida
+    long long qtdMovimentos; ///< Quantos movimentos o replay tem
+    long long qtdPontos; ///< Quantos pontos de controle o indice tem
+    long long tamPontos; ///< Quantos bytes os pontos de controle ocupam
+} tCabecalhoIndice;
+/**
+ * @brief Joga os movimentos da entrada padrao, como a linha de comando mas sem imprimir nada, e exporta o indice @ref ARQ_INDC
+ *
+ * @param caminhoBase O diretorio do jogo
+ * @param intervalo A cada quantos movimentos guardar um ponto de controle
+ * @related tCabecalhoIndice
+ */
+void indexaReplay(char caminhoBase[], int intervalo);
+/**
+ * @brief Imprime, como a linha de comando, os quadros dos movimentos @p primeiro a @p ultimo do replay indexado em @ref ARQ_INDC
+ *
+ * Parte do ultimo ponto de controle antes de @p primeiro : o custo e o do intervalo do indice mais os quadros pedidos,
+ * e nao o de todos os movimentos anteriores
+ *
+ * @param caminhoBase O diretorio do jogo
+ * @param primeiro O primeiro movimento, a partir de 1
+ * @param ultimo O ultimo movimento
+ * @related tCabecalhoIndice
+ */
+void imprimeQuadros(char caminhoBase[], long long primeiro, long long ultimo);
+
+// FIM INDICE
+
+#ifndef JSR_BIBLIOTECA
+int main(int argc, char const *argv[]) {
+    if (argc <= 1) {
+        printf("%s\n", "ERRO: O diretorio de arquivos de configuracao nao foi informado");
+        return EXIT_FAILURE;
+    }
+    
+    char caminhoBase[TAM_CAMINHO];
+    strcpy(caminhoBase, argv[1]);
+    tOpcoes opcoes = leOpcoes(argc, argv);
+
+    if (opcoes.reconstroi) {
+        reconstroiQuadros(stdin);
+        return EXIT_SUCCESS;
+    }
+
+    if (opcoes.caminhoSocket != NULL) {
+        executaServidor(opcoes.caminhoSocket);
+        return EXIT_SUCCESS;
+    }
+
+    // os retangulos sao lidos antes de jogar, para que um arquivo invalido nao desperdice o jogo
+    tRegiao *regioes = NULL;
+    int qtdRegioes = 0;
+    if (opcoes.caminhoRegioes != NULL) {
+        regioes = leRegioes(opcoes.caminhoRegioes, &qtdRegioes);
+    }
+
+    if (opcoes.agrega) {
+        agregaEntrada(caminhoBase, opcoes.qtdThreads, opcoes.percentil, regioes, qtdRegioes);
+        free(regioes);
+        return EXIT_SUCCESS;
+    }
+
+    if (opcoes.qtdJogosMC > 0) {
+        simulaMonteCarlo(caminhoBase, opcoes.qtdJogosMC, opcoes.qtdThreads, opcoes.limiteMov, opcoes.politica, opcoes.semente);
+        return EXIT_SUCCESS;
+    }
+
+    if (opcoes.autopiloto) {
+        jogaAutopiloto(caminhoBase, opcoes.limiteMov);
+        return EXIT_SUCCESS;
+    }
+
+    if (opcoes.otimiza) {
+        otimizaJogo(caminhoBase, opcoes.largura, opcoes.limiteMov, opcoes.qtdThreads);
+        return EXIT_SUCCESS;
+    }
+
+    if (opcoes.intervaloIndice > 0) {
+        indexaReplay(caminhoBase, opcoes.intervaloIndice);
+        return EXIT_SUCCESS;
+    }
+
+    if (opcoes.primeiroQuadro > 0) {
+        imprimeQuadros(caminhoBase, opcoes.primeiroQuadro, opcoes.ultimoQuadro);
+        return EXIT_SUCCESS;
+    }
+    
+    tCache *cache = NULL;
+    FILE *entrada = stdin;
+    if (opcoes.caminhoCache != NULL) {
+        cache = abreCache(opcoes.caminhoCache, caminhoBase, opcoes);
+        if (serveCache(cache, opcoes.deltas)) {
+            liberaCache(cache);
+            return EXIT_SUCCESS;
+        }
+        entrada = cache->entrada;
+    }
+    
+    jsrJogo *motor = abreJogo(caminhoBase, opcoes.intervaloSerie);
+    const tJogo *jogo = adquireJogo(motor);
+    if (opcoes.infinito && jsrDefineInfinito(motor, opcoes.semente) != 0) {
+        printf("ERRO: Memoria insuficiente para o modo infinito\n");
+        exit(EXIT_FAILURE);
+    }
+    if (opcoes.heatmapVivo && jsrDefineHeatmapVivo(motor) != 0) {
+        printf("ERRO: Nao foi possivel mapear o arquivo do heatmap (%s)\n", ARQ_HMVV);
+        exit(EXIT_FAILURE);
+    }
+    if (opcoes.eventos) {
+        jsrDefineEventos(motor);
+    }
+
+    if (cache != NULL) {
+        capturaSaida(cache);
+    }
+
+    tTela *tela = NULL;
+    tAoVivo *aoVivo = NULL;
+    if (opcoes.aoVivo) {
+        aoVivo = inicializaAoVivo(jogo, opcoes.fps);
+    }
+    else if (opcoes.deltas) {
+        tela = inicializaTela(jogo->mapa, opcoes.intervaloChave);
+        imprimeQuadro(tela, jogo, '-');
+    }
+    char tabuleiro[TAM_MAPA * (TAM_MAPA + 1) + 128];
+    jsrEstado estado;
+    do {
+        char movimento;
+        // o jogo infinito nunca e vencido: termina tambem com a entrada
+        if (fscanf(entrada, "%c%*c", &movimento) == EOF) {
+            marcaFimEntrada(cache);
+            if (opcoes.infinito) {
+                break;
+            }
+        }
+        
+        jsrJoga(motor, &movimento, 1);
+        jsrConsulta(motor, &estado);
+
+        if (aoVivo != NULL) {
+            registraAoVivo(aoVivo, jogo);
+            continue;
+        }
+        if (tela != NULL) {
+            imprimeQuadro(tela, jogo, movimento);
+            continue;
+        }
+        if (pulaQuadro(cache)) {
+            continue;
+        }
+
+        printf("%c", '\n');
+        printf("Estado do jogo apos o movimento '%c':\n", movimento);
+        jsrArtefato(motor, JSR_ART_TABULEIRO, tabuleiro, sizeof(tabuleiro));
+        fputs(tabuleiro, stdout);
+    } while (estado.estado == JSR_EST_CONTINUA);
+    free(tela);
+    if (aoVivo != NULL) {
+        encerraAoVivo(aoVivo, jogo);
+    }
+
+    if (regioes != NULL) {
+        exportaRegioes(adquireLinhas(jogo->mapa), adquireColunas(jogo->mapa), jogo->heatmap, regioes, qtdRegioes, jogo->caminhoSaida);
+        free(regioes);
+    }
+
+    if (jsrLiberaJogo(motor) != 0) {
+        printf("ERRO: Falha ao exportar o jogo (memoria insuficiente ou arquivo inacessivel)\n");
+        exit(EXIT_FAILURE);
+    }
+    if (cache != NULL) {
+        registraCache(cache);
+        liberaCache(cache);
+    }
+
+    return EXIT_SUCCESS;
+}
+#endif
+
+// INDICE
+void indexaReplay(char caminhoBase[], int intervalo) {
+    tMapa *mapa = leMapa(caminhoBase);
+    tChaveCache chave = calculaChaveMapa(caminhoBase);
+
+    char caminhoSaida[TAM_CAMINHO];
+    char caminhoIndice[TAM_CAMINHO];
+    combinaCaminho(caminhoSaida, caminhoBase, DIR_SAID);
+    combinaCaminho(caminhoIndice, caminhoSaida, ARQ_INDC);
+    FILE *arq = fopen(caminhoIndice, "wb");
+    if (arq == NULL) {
+        printf("ERRO: Nao foi possivel criar o indice (%s)\n", caminhoIndice);
+        exit(EXIT_FAILURE);
+    }
+
+    tCabecalhoIndice cabecalho;
+    memset(&cabecalho, 0, sizeof(cabecalho));
+    memcpy(cabecalho.assinatura, IDX_ASSN, sizeof(cabecalho.assinatura));
+    cabecalho.chaveA = chave.a;
+    cabecalho.chaveB = chave.b;
+    cabecalho.intervalo = intervalo;
+    cabecalho.qtdPalavras = (mapa->qtdItens + 63) / 64;
+    fwrite(&cabecalho, sizeof(cabecalho), 1, arq);
+
+    // os movimentos e as posicoes dos pontos so sao escritos depois de todos os pontos de controle
+    long long capacidade = 4096;
+    long long capPontos = 64;
+    char *movimentos = malloc(capacidade);
+    long long *posicoes = malloc(capPontos * sizeof(long long));
+    unsigned short *corpo = malloc(mapa->nLinhas * mapa->mColunas * sizeof(unsigned short));
+    tPartida partida = inicializaPartida(mapa);
+    if (movimentos == NULL || posicoes == NULL || corpo == NULL || partida.cobra.corpo.vet == NULL) {
+        printf("ERRO: Memoria insuficiente para o indice\n");
+        exit(EXIT_FAILURE);
+    }
+
+    tPontoPartida ponto;
+    char movimento = MOV_CBRCT;
+    while (1) {
+        if (cabecalho.qtdMovimentos % intervalo == 0) {
+            if (cabecalho.qtdPontos == capPontos) {
+                capPontos *= 2;
+                long long *maiores = realloc(posicoes, capPontos * sizeof(long long));
+                if (maiores == NULL) {
+                    printf("ERRO: Memoria insuficiente para o indice\n");
+                    exit(EXIT_FAILURE);
+                }
+                posicoes = maiores;
+            }
+            posicoes[cabecalho.qtdPontos++] = sizeof(cabecalho) + cabecalho.tamPontos;
+
+            salvaPartida(&partida, &ponto, corpo);
+            fwrite(&ponto, sizeof(ponto), 1, arq);
+            fwrite(corpo, sizeof(unsigned short), ponto.tamCorpo, arq);
+            fwrite(partida.consumidos, sizeof(unsigned long long), cabecalho.qtdPalavras, arq);
+            cabecalho.tamPontos += sizeof(ponto) + ponto.tamCorpo * sizeof(unsigned short) + cabecalho.qtdPalavras * sizeof(unsigned long long);
+        }
+        if (partida.estado != JOG_EST_C) {
+            break;
+        }
+
+        // como na linha de comando, o ultimo movimento se repete depois do fim da entrada
+        char lido;
+        if (scanf("%c%*c", &lido) != EOF) {
+            movimento = lido;
+        }
+        fazMovimento(mapa, &partida, movimento);
+
+        if (cabecalho.qtdMovimentos == capacidade) {
+            capacidade *= 2;
+            char *maior = realloc(movimentos, capacidade);
+            if (maior == NULL) {
+                printf("ERRO: Memoria insuficiente para o indice\n");
+                exit(EXIT_FAILURE);
+            }
+            movimentos = maior;
+        }
+        movimentos[cabecalho.qtdMovimentos++] = movimento;
+    }
+
+    fwrite(movimentos, 1, cabecalho.qtdMovimentos, arq);
+    fwrite(posicoes, sizeof(long long), cabecalho.qtdPontos, arq);
+    rewind(arq);
+    fwrite(&cabecalho, sizeof(cabecalho), 1, arq);
+    if (fclose(arq) != 0) {
+        printf("ERRO: Nao foi possivel escrever o indice (%s)\n", caminhoIndice);
+        exit(EXIT_FAILURE);
+    }
+    free(movimentos);
+    free(posicoes);
+    free(corpo);
+    liberaPartida(&partida);
+    free(mapa);
+}
+
+void imprimeQuadros(char caminhoBase[], long long primeiro, long long ultimo) {
+    tMapa *mapa = leMapa(caminhoBase);
+    tChaveCache chave = calculaChaveMapa(caminhoBase);
+
+    char caminhoSaida[TAM_CAMINHO];
+    char caminhoIndice[TAM_CAMINHO];
+    combinaCaminho(caminhoSaida, caminhoBase, DIR_SAID);
+    combinaCaminho(caminhoIndice, caminhoSaida, ARQ_INDC);
+    FILE *arq = fopen(caminhoIndice, "rb");
+    if (arq == NULL) {
+        printf("ERRO: O indice (%s) nao foi encontrado\n", caminhoIndice);
+        exit(EXIT_FAILURE);
+    }
+
+    tCabecalhoIndice cabecalho;
+    if (fread(&cabecalho, sizeof(cabecalho), 1, arq) != 1 || memcmp(cabecalho.assinatura, IDX_ASSN, sizeof(cabecalho.assinatura)) != 0 ||
+        cabecalho.intervalo <= 0 || cabecalho.qtdPalavras != (mapa->qtdItens + 63) / 64) {
+        printf("ERRO: O indice (%s) e invalido\n", caminhoIndice);
+        exit(EXIT_FAILURE);
+    }
+    if (cabecalho.chaveA != chave.a || cabecalho.chaveB != chave.b) {
+        printf("ERRO: O indice (%s) e de outro mapa ou de outra versao do motor\n", caminhoIndice);
+        exit(EXIT_FAILURE);
+    }
+    if (primeiro > cabecalho.qtdMovimentos || ultimo > cabecalho.qtdMovimentos) {
+        printf("ERRO: Os quadros pedidos (%lld a %lld) passam do fim do replay, com %lld movimentos\n", primeiro, ultimo, cabecalho.qtdMovimentos);
+        exit(EXIT_FAILURE);
+    }
+
+    // o ultimo ponto antes de primeiro, que ainda precisa do movimento primeiro para chegar ao seu quadro
+    long long idPonto = (primeiro - 1) / cabecalho.intervalo;
+    long long inicio = idPonto * cabecalho.intervalo;
+    long long inicioMovimentos = sizeof(cabecalho) + cabecalho.tamPontos;
+    long long posicao;
+    tPontoPartida ponto;
+    unsigned long long consumidos[PAR_PALAVRAS];
+    char *movimentos = malloc(ultimo - inicio);
+    unsigned short *corpo = malloc(mapa->nLinhas * mapa->mColunas * sizeof(unsigned short));
+    tPartida partida = inicializaPartida(mapa);
+    if (movimentos == NULL || corpo == NULL || partida.cobra.corpo.vet == NULL) {
+        printf("ERRO: Memoria insuficiente para os quadros\n");
+        exit(EXIT_FAILURE);
+    }
+    // o tamanho do corpo e conferido antes de ler as partes; restauraPartida confere o resto
+    if (idPonto >= cabecalho.qtdPontos ||
+        fseek(arq, inicioMovimentos + cabecalho.qtdMovimentos + idPonto * sizeof(long long), SEEK_SET) != 0 ||
+        fread(&posicao, sizeof(posicao), 1, arq) != 1 || fseek(arq, posicao, SEEK_SET) != 0 ||
+        fread(&ponto, sizeof(ponto), 1, arq) != 1 || ponto.tamCorpo < 1 || ponto.tamCorpo > mapa->nLinhas * mapa->mColunas ||
+        fread(corpo, sizeof(unsigned short), ponto.tamCorpo, arq) != (size_t) ponto.tamCorpo ||
+        fread(consumidos, sizeof(unsigned long long), cabecalho.qtdPalavras, arq) != (size_t) cabecalho.qtdPalavras ||
+        !restauraPartida(mapa, &partida, &ponto, corpo, consumidos) ||
+        fseek(arq, inicioMovimentos + inicio, SEEK_SET) != 0 ||
+        fread(movimentos, 1, ultimo - inicio, arq) != (size_t) (ultimo - inicio)) {
+        printf("ERRO: O indice (%s) esta corrompido\n", caminhoIndice);
+        exit(EXIT_FAILURE);
+    }
+    fclose(arq);
+    free(corpo);
+
+    long long mov;
+    for (mov = inicio + 1; mov <= ultimo; mov++) {
+        char movimento = movimentos[mov - inicio - 1];
+        fazMovimento(mapa, &partida, movimento);
+        if (mov < primeiro) {
+            continue;
+        }
+
+        printf("%c", '\n');
+        printf("Estado do jogo apos o movimento '%c':\n", movimento);
+        escreveMapa(stdout, mapa, &partida);
+        escrevePlacar(stdout, partida.pontuacao, partida.estado);
+    }
+    free(movimentos);
+    liberaPartida(&partida);
+    free(mapa);
+}
+// FIM INDICE
+
+// CACHE
+tChaveCache criaChaveCache(void) {
+    tChaveCache chave = { 0xCBF29CE484222325ULL, 0x9E3779B97F4A7C15ULL };
+    return chave;
+}
+
+void acrescentaChaveCache(tChaveCache *chave, const void *dados, size_t tam) {
+    const unsigned char *bytes = dados;
+    unsigned long long a = chave->a;
+    unsigned long long b = chave->b;
+    size_t i;
+    for (i = 0; i < tam; i++) {
+        a = (a ^ bytes[i]) * 0x100000001B3ULL;
+        b = (b ^ bytes[i]) * 0xC2B2AE3D27D4EB4FULL;
+        b = (b << 31) | (b >> 33);
+    }
+    // o tamanho separa os trechos: "ab" + "c" e "a" + "bc" tem chaves diferentes
+    chave->a = (a ^ tam) * 0x100000001B3ULL;
+    chave->b = (b + tam) * 0xC2B2AE3D27D4EB4FULL;
+}
+
+void formataChaveCache(tChaveCache chave, char texto[]) {
+    unsigned long long metades[2];
+    metades[0] = chave.a;
+    metades[1] = chave.b;
+    int i;
+    for (i = 0; i < 2; i++) {
+        // finaliza com o splitmix64, espalhando os ultimos bytes por todos os digitos
+        unsigned long long z = metades[i];
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        metades[i] = z ^ (z >> 31);
+    }
+    sprintf(texto, "%016llx%016llx", metades[0], metades[1]);
+}
+
+tChaveCache calculaChaveMapa(char caminhoBase[]) {
+    char caminhoMapa[TAM_CAMINHO];
+    combinaCaminho(caminhoMapa, caminhoBase, ARQ_MAPA);
+    FILE *arq = fopen(caminhoMapa, "rb");
+    if (arq == NULL) {
+        printf("ERRO: O arquivo de configuração do mapa (%s) nao foi encontrado\n", caminhoMapa);
+        exit(EXIT_FAILURE);
+    }
+    fseek(arq, 0, SEEK_END);
+    long tam = ftell(arq);
+    rewind(arq);
+    char *texto = malloc(tam > 0 ? tam : 1);
+    if (texto == NULL) {
+        printf("ERRO: Memoria insuficiente para o mapa\n");
+        exit(EXIT_FAILURE);
+    }
+    tam = fread(texto, 1, tam, arq);
+    fclose(arq);
+
+    tChaveCache chave = criaChaveCache();
+    acrescentaChaveCache(&chave, CCH_VERSAO, strlen(CCH_VERSAO));
+    acrescentaChaveCache(&chave, texto, tam);
+    free(texto);
+
+    return chave;
+}
+
+tCache *abreCache(const char caminhoCache[], char caminhoBase[], tOpcoes opcoes) {
+    tCache *cache = calloc(1, sizeof(tCache));
+    size_t capacidade = 4096;
+    if (cache != NULL) {
+        cache->movimentos = malloc(capacidade);
+    }
+    if (cache == NULL || cache->movimentos == NULL) {
+        printf("ERRO: Memoria insuficiente para o cache\n");
+        exit(EXIT_FAILURE);
+    }
+    cache->fimEntrada = -1;
+    cache->saidaOriginal = -1;
+
+    // os movimentos sao lidos de uma vez: a chave depende de todos, e o jogo os le da memoria
+    size_t lidos;
+    while ((lidos = fread(cache->movimentos + cache->tamMovimentos, 1, capacidade - cache->tamMovimentos, stdin)) > 0) {
+        cache->tamMovimentos += lidos;
+        if (cache->tamMovimentos == capacidade) {
+            capacidade *= 2;
+            char *maior = realloc(cache->movimentos, capacidade);
+            if (maior == NULL) {
+                printf("ERRO: Memoria insuficiente para o cache\n");
+                exit(EXIT_FAILURE);
+            }
+            cache->movimentos = maior;
+        }
+    }
+    cache->entrada = fmemopen(cache->movimentos, cache->tamMovimentos, "r");
+    if (cache->entrada == NULL) {
+        printf("ERRO: Memoria insuficiente para o cache\n");
+        exit(EXIT_FAILURE);
+    }
+
+    // a versao, o mapa e as opcoes que alteram a saida escolhem o diretorio; os movimentos, a entrada nele
+    char opcoesSaida[128];
+    snprintf(opcoesSaida, sizeof(opcoesSaida), "deltas=%d chave=%d serie=%d infinito=%d semente=%llu eventos=%d", opcoes.deltas,
+             opcoes.intervaloChave, opcoes.intervaloSerie, opcoes.infinito, opcoes.infinito ? opcoes.semente : 0ULL, opcoes.eventos);
+    tChaveCache chave = calculaChaveMapa(caminhoBase);
+    acrescentaChaveCache(&chave, opcoesSaida, strlen(opcoesSaida));
+    char textoChave[33];
+    formataChaveCache(chave, textoChave);
+
+    // cabem a chave, o nome de uma entrada e o mais longo dos arquivos
+    if (strlen(caminhoCache) + 160 >= TAM_CAMINHO || strlen(caminhoBase) + strlen(DIR_SAID) + 32 >= TAM_CAMINHO) {
+        printf("ERRO: O diretorio do cache (%s) e longo demais\n", caminhoCache);
+        exit(EXIT_FAILURE);
+    }
+    sprintf(cache->caminho, "%s/%s", caminhoCache, textoChave);
+    if ((mkdir(caminhoCache, 0777) != 0 && errno != EEXIST) || (mkdir(cache->caminho, 0777) != 0 && errno != EEXIST)) {
+        printf("ERRO: Nao foi possivel criar o diretorio do cache (%s)\n", cache->caminho);
+        exit(EXIT_FAILURE);
+    }
+    combinaCaminho(cache->caminhoSaida, caminhoBase, DIR_SAID);
+    combinaCaminho(cache->temporario, cache->caminho, DIR_CTMP);
+
+    return cache;
+}
+
+int serveCache(tCache *cache, int deltas) {
+    const char *arquivos[] = { CCH_ARQUIVOS };
+    int qtdArquivos = sizeof(arquivos) / sizeof(arquivos[0]);
+    char origem[TAM_CAMINHO];
+    char destino[TAM_CAMINHO];
+    int i;
+
+    // o resumo e os eventos seriam acrescentados aos de outra execucao: sem eles, a saida so depende da chave
+    for (i = 0; i < qtdArquivos; i++) {
+        sprintf(destino, "%s%s", cache->caminhoSaida, arquivos[i]);
+        unlink(destino);
+    }
+
+    DIR *dir = opendir(cache->caminho);
+    if (dir == NULL) {
+        printf("ERRO: Nao foi possivel ler o diretorio do cache (%s)\n", cache->caminho);
+        exit(EXIT_FAILURE);
+    }
+    int completa = 0;
+    unsigned long maiorPrefixo = 0;
+    struct dirent *entrada;
+    while (!completa && (entrada = readdir(dir)) != NULL) {
+        char chave[33];
+        unsigned long tam;
+        char tipo;
+        long tamSaida;
+        long long qtdQuadros;
+        if (strlen(entrada->d_name) > 112 ||
+            sscanf(entrada->d_name, "%32[0-9a-f]-%lu-%c-%ld-%lld", chave, &tam, &tipo, &tamSaida, &qtdQuadros) != 5 ||
+            tam > cache->tamMovimentos) {
+            continue;
+        }
+        // um jogo que acabou dentro dos movimentos ignora os acrescentados depois; um que nao acabou so vale como prefixo
+        completa = tipo == CCH_TIP_F || (tipo == CCH_TIP_E && tam == cache->tamMovimentos);
+        if (!completa && (tipo != CCH_TIP_E || deltas || tam <= maiorPrefixo)) {
+            continue;
+        }
+
+        char textoChave[33];
+        tChaveCache chaveMovimentos = criaChaveCache();
+        acrescentaChaveCache(&chaveMovimentos, cache->movimentos, tam);
+        formataChaveCache(chaveMovimentos, textoChave);
+        if (strcmp(chave, textoChave) != 0) {
+            completa = 0;
+            continue;
+        }
+
+        combinaCaminho(cache->prefixo, cache->caminho, "/");
+        strcat(cache->prefixo, entrada->d_name);
+        if (!completa) {
+            maiorPrefixo = tam;
+            cache->tamPrefixo = tamSaida;
+            cache->qtdPulados = qtdQuadros;
+        }
+    }
+    closedir(dir);
+    if (!completa) {
+        return 0;
+    }
+
+    for (i = 0; i < qtdArquivos; i++) {
+        sprintf(origem, "%s%s", cache->prefixo, arquivos[i]);
+        sprintf(destino, "%s%s", cache->caminhoSaida, arquivos[i]);
+        if (access(origem, F_OK) == 0 && !copiaArquivo(origem, destino, -1)) {
+            printf("ERRO: Nao foi possivel copiar o arquivo do cache (%s)\n", destino);
+            exit(EXIT_FAILURE);
+        }
+    }
+    combinaCaminho(origem, cache->prefixo, ARQ_CSAI);
+    if (!copiaArquivo(origem, NULL, -1)) {
+        printf("ERRO: Nao foi possivel ler a saida do cache (%s)\n", origem);
+        exit(EXIT_FAILURE);
+    }
+
+    return 1;
+}
+
+void capturaSaida(tCache *cache) {
+    // o nome e unico mesmo entre maquinas que compartilham o cache
+    if (mkdtemp(cache->temporario) == NULL) {
+        printf("ERRO: Nao foi possivel criar o diretorio do cache (%s)\n", cache->temporario);
+        exit(EXIT_FAILURE);
+    }
+
+    char caminho[TAM_CAMINHO];
+    combinaCaminho(caminho, cache->temporario, ARQ_CSAI);
+    if (cache->prefixo[0] != '\0') {
+        char origem[TAM_CAMINHO];
+        combinaCaminho(origem, cache->prefixo, ARQ_CSAI);
+        if (!copiaArquivo(origem, caminho, cache->tamPrefixo)) {
+            printf("ERRO: Nao foi possivel ler a saida do cache (%s)\n", origem);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    fflush(stdout);
+    int fd = open(caminho, O_WRONLY | O_CREAT | O_APPEND, 0666);
+    if (fd >= 0) {
+        cache->saidaOriginal = dup(STDOUT_FILENO);
+    }
+    if (fd < 0 || cache->saidaOriginal < 0 || dup2(fd, STDOUT_FILENO) < 0) {
+        printf("ERRO: Nao foi possivel capturar a saida no cache (%s)\n", caminho);
+        exit(EXIT_FAILURE);
+    }
+    close(fd);
+}
+
+int pulaQuadro(tCache *cache) {
+    if (cache == NULL) {
+        return 0;
+    }
+    cache->qtdQuadros++;
+    if (cache->qtdPulados == 0) {
+        return 0;
+    }
+    cache->qtdPulados--;
+    return 1;
+}
+
+void marcaFimEntrada(tCache *cache) {
+    if (cache == NULL || cache->fimEntrada >= 0) {
+        return;
+    }
+    fflush(stdout);
+    cache->fimEntrada = lseek(STDOUT_FILENO, 0, SEEK_END);
+    cache->quadrosEntrada = cache->qtdQuadros;
+}
+
+void registraCache(tCache *cache) {
+    fflush(stdout);
+    long tamSaida = lseek(STDOUT_FILENO, 0, SEEK_END);
+    dup2(cache->saidaOriginal, STDOUT_FILENO);
+    close(cache->saidaOriginal);
+    cache->saidaOriginal = -1;
+
+    char origem[TAM_CAMINHO];
+    char destino[TAM_CAMINHO];
+    combinaCaminho(origem, cache->temporario, ARQ_CSAI);
+    if (!copiaArquivo(origem, NULL, -1)) {
+        printf("ERRO: Nao foi possivel ler a saida do cache (%s)\n", origem);
+        exit(EXIT_FAILURE);
+    }
+
+    const char *arquivos[] = { CCH_ARQUIVOS };
+    int i;
+    for (i = 0; i < (int) (sizeof(arquivos) / sizeof(arquivos[0])); i++) {
+        sprintf(origem, "%s%s", cache->caminhoSaida, arquivos[i]);
+        sprintf(destino, "%s%s", cache->temporario, arquivos[i]);
+        if (access(origem, F_OK) == 0 && !copiaArquivo(origem, destino, -1)) {
+            printf("ERRO: Nao foi possivel copiar o arquivo para o cache (%s)\n", destino);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    unsigned long tam = cache->tamMovimentos;
+    char tipo = CCH_TIP_E;
+    long fim = cache->fimEntrada;
+    long long qtdQuadros = cache->quadrosEntrada;
+    if (cache->fimEntrada < 0) {
+        // o jogo acabou antes dos movimentos: so os bytes que ele chegou a ler importam
+        tam = ftell(cache->entrada);
+        tipo = CCH_TIP_F;
+        fim = tamSaida;
+        qtdQuadros = cache->qtdQuadros;
+    }
+    char textoChave[33];
+    tChaveCache chave = criaChaveCache();
+    acrescentaChaveCache(&chave, cache->movimentos, tam);
+    formataChaveCache(chave, textoChave);
+
+    // outra execucao pode ter publicado a mesma entrada antes; o conteudo e o mesmo
+    char nome[128];
+    sprintf(nome, "/%s-%lu-%c-%ld-%lld", textoChave, tam, tipo, fim, qtdQuadros);
+    combinaCaminho(destino, cache->caminho, nome);
+    if (rename(cache->temporario, destino) != 0) {
+        removeDiretorio(cache->temporario);
+    }
+}
+
+void liberaCache(tCache *cache) {
+    if (cache->saidaOriginal >= 0) {
+        close(cache->saidaOriginal);
+    }
+    fclose(cache->entrada);
+    free(cache->movimentos);
+    free(cache);
+}
+
+int copiaArquivo(const char origem[], const char destino[], long limite) {
+    FILE *arqOrigem = fopen(origem, "rb");
+    if (arqOrigem == NULL) {
+        return 0;
+    }
+    FILE *arqDestino = destino == NULL ? stdout : fopen(destino, "wb");
+    if (arqDestino == NULL) {
+        fclose(arqOrigem);
+        return 0;
+    }
+
+    char bloco[1 << 16];
+    int sucesso = 1;
+    while (limite != 0) {
+        size_t pedidos = limite < 0 || limite > (long) sizeof(bloco) ? sizeof(bloco) : (size_t) limite;
+        size_t lidos = fread(bloco, 1, pedidos, arqOrigem);
+        if (lidos == 0) {
+            // um limite alem do fim do arquivo indica uma entrada corrompida
+            sucesso = limite < 0 && !ferror(arqOrigem);
+            break;
+        }
+        if (fwrite(bloco, 1, lidos, arqDestino) != lidos) {
+            sucesso = 0;
+            break;
+        }
+        if (limite > 0) {
+            limite -= lidos;
+        }
+    }
+    fclose(arqOrigem);
+    if (destino == NULL ? fflush(stdout) != 0 : fclose(arqDestino) != 0) {
+        sucesso = 0;
+    }
+
+    return sucesso;
+}
+
+void removeDiretorio(const char caminho[]) {
+    DIR *dir = opendir(caminho);
+    if (dir == NULL) {
+        return;
+    }
+    char arquivo[TAM_CAMINHO];
+    struct dirent *entrada;
+    while ((entrada = readdir(dir)) != NULL) {
+        if (strcmp(entrada->d_name, ".") != 0 && strcmp(entrada->d_name, "..") != 0 &&
+            strlen(caminho) + strlen(entrada->d_name) + 1 < TAM_CAMINHO) {
+            strcpy(arquivo, caminho);
+            strcat(arquivo, "/");
+            strcat(arquivo, entrada->d_name);
+            unlink(arquivo);
+        }
+    }
+    closedir(dir);
+    rmdir(caminho);
+}
+// FIM CACHE
+
+// OPCOES
+tOpcoes leOpcoes(int argc, char const *argv[]) {
+    tOpcoes opcoes = { 0 };
+    opcoes.limiteMov = 10000;
+    opcoes.politica = MC_POL_A;
+    opcoes.semente = 1;
+    opcoes.largura = 128;
+    opcoes.fps = AOV_FPS;
+
+    // cada modo usa apenas parte das opcoes; as demais seriam ignoradas em silencio, e sao rejeitadas
+    static const tRegraOpcao regras[] = {
+        { "--serie", 0, OPC_REPRODUCAO },
+        { "--montecarlo", OPC_MONTECARLO, OPC_MONTECARLO },
+        { "--threads", 0, OPC_MONTECARLO | OPC_OTIMIZA | OPC_AGREGA },
+        { "--limite", 0, OPC_MONTECARLO | OPC_AUTOPILOTO | OPC_OTIMIZA },
+        { "--politica", 0, OPC_MONTECARLO },
+        { "--semente", 0, OPC_MONTECARLO | OPC_REPRODUCAO },
+        { "--autopiloto", OPC_AUTOPILOTO, OPC_AUTOPILOTO },
+        { "--otimiza", OPC_OTIMIZA, OPC_OTIMIZA },
+        { "--feixe", 0, OPC_OTIMIZA },
+        { "--deltas", 0, OPC_REPRODUCAO },
+        { "--chave", 0, OPC_REPRODUCAO },
+        { "--reconstroi", OPC_RECONSTROI, OPC_RECONSTROI },
+        { "--ao-vivo", 0, OPC_REPRODUCAO },
+        { "--fps", 0, OPC_REPRODUCAO },
+        { "--servidor", OPC_SERVIDOR, OPC_SERVIDOR },
+        { "--infinito", 0, OPC_REPRODUCAO },
+        { "--heatmap-vivo", 0, OPC_REPRODUCAO },
+        { "--eventos", 0, OPC_REPRODUCAO },
+        { "--cache", 0, OPC_REPRODUCAO },
+        { "--indice", OPC_INDICE, OPC_INDICE },
+        { "--quadros", OPC_QUADROS, OPC_QUADROS },
+        { "--agrega", OPC_AGREGA, OPC_AGREGA },
+        { "--percentil", 0, OPC_AGREGA },
+        { "--regioes", 0, OPC_REPRODUCAO | OPC_AGREGA },
+    };
+    int qtdRegras = sizeof(regras) / sizeof(regras[0]);
+    int informadas[sizeof(regras) / sizeof(regras[0])] = { 0 };
+    int informouSemente = 0;
+    int informouFps = 0;
+
+    int i;
+    int k;
+    for (i = 2; i < argc; i++) {
+        for (k = 0; k < qtdRegras; k++) {
+            if (strcmp(argv[i], regras[k].texto) == 0) {
+                informadas[k] = 1;
+            }
+        }
+
+        if (strcmp(argv[i], "--serie") == 0 && i + 1 < argc) {
+            opcoes.intervaloSerie = atoi(argv[++i]);
+            if (opcoes.intervaloSerie <= 0) {
+                printf("ERRO: O intervalo da serie do heatmap deve ser positivo (%s)\n", argv[i]);
+                exit(EXIT_FAILURE);
+            }
+        }
+        else if (strcmp(argv[i], "--montecarlo") == 0 && i + 1 < argc) {
+            opcoes.qtdJogosMC = atoll(argv[++i]);
+            if (opcoes.qtdJogosMC <= 0) {
+                printf("ERRO: O numero de jogos da simulacao deve ser positivo (%s)\n", argv[i]);
+                exit(EXIT_FAILURE);
+            }
+        }
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            opcoes.qtdThreads = atoi(argv[++i]);
+            if (opcoes.qtdThreads <= 0) {
+                printf("ERRO: O numero de threads deve ser positivo (%s)\n", argv[i]);
+                exit(EXIT_FAILURE);
+            }
+        }
+        else if (strcmp(argv[i], "--limite") == 0 && i + 1 < argc) {
+            opcoes.limiteMov = atoi(argv[++i]);
+            if (opcoes.limiteMov <= 0) {
+                printf("ERRO: O limite de movimentos deve ser positivo (%s)\n", argv[i]);
+                exit(EXIT_FAILURE);
+            }
+        }
+        else if (strcmp(argv[i], "--politica") == 0 && i + 1 < argc) {
+            i++;
+            if (strcmp(argv[i], "aleatoria") == 0) {
+                opcoes.politica = MC_POL_A;
+            }
+            else if (strcmp(argv[i], "cautelosa") == 0) {
+                opcoes.politica = MC_POL_C;
+            }
+            else {
+                printf("ERRO: Politica desconhecida (%s)\n", argv[i]);
+                exit(EXIT_FAILURE);
+            }
+        }
+        else if (strcmp(argv[i], "--semente") == 0 && i + 1 < argc) {
+            opcoes.semente = strtoull(argv[++i], NULL, 10);
+            informouSemente = 1;
+        }
+        else if (strcmp(argv[i], "--autopiloto") == 0) {
+            opcoes.autopiloto = 1;
+        }
+        else if (strcmp(argv[i], "--otimiza") == 0) {
+            opcoes.otimiza = 1;
+        }
+        else if (strcmp(argv[i], "--feixe") == 0 && i + 1 < argc) {
+            opcoes.largura = atoi(argv[++i]);
+            if (opcoes.largura <= 0) {
+                printf("ERRO: A largura do feixe deve ser positiva (%s)\n", argv[i]);
+                exit(EXIT_FAILURE);
+            }
+        }
+        else if (strcmp(argv[i], "--deltas") == 0) {
+            opcoes.deltas = 1;
+        }
+        else if (strcmp(argv[i], "--chave") == 0 && i + 1 < argc) {
+            opcoes.intervaloChave = atoi(argv[++i]);
+            if (opcoes.intervaloChave <= 0) {
+                printf("ERRO: O intervalo dos quadros-chave deve ser positivo (%s)\n", argv[i]);
+                exit(EXIT_FAILURE);
+            }
+        }
+        else if (strcmp(argv[i], "--reconstroi") == 0) {
+            opcoes.reconstroi = 1;
+        }
+        else if (strcmp(argv[i], "--ao-vivo") == 0) {
+            opcoes.aoVivo = 1;
+        }
+        else if (strcmp(argv[i], "--fps") == 0 && i + 1 < argc) {
+            opcoes.fps = atoi(argv[++i]);
+            informouFps = 1;
+            if (opcoes.fps <= 0) {
+                printf("ERRO: A taxa de quadros deve ser positiva (%s)\n", argv[i]);
+                exit(EXIT_FAILURE);
+            }
+        }
+        else if (strcmp(argv[i], "--servidor") == 0 && i + 1 < argc) {
+            opcoes.caminhoSocket = argv[++i];
+        }
+        else if (strcmp(argv[i], "--infinito") == 0) {
+            opcoes.infinito = 1;
+        }
+        else if (strcmp(argv[i], "--heatmap-vivo") == 0) {
+            opcoes.heatmapVivo = 1;
+        }
+        else if (strcmp(argv[i], "--eventos") == 0) {
+            opcoes.eventos = 1;
+        }
+        else if (strcmp(argv[i], "--cache") == 0 && i + 1 < argc) {
+            opcoes.caminhoCache = argv[++i];
+        }
+        else if (strcmp(argv[i], "--indice") == 0 && i + 1 < argc) {
+            opcoes.intervaloIndice = atoi(argv[++i]);
+            if (opcoes.intervaloIndice <= 0) {
+                printf("ERRO: O intervalo do indice deve ser positivo (%s)\n", argv[i]);
+                exit(EXIT_FAILURE);
+            }
+        }
+        else if (strcmp(argv[i], "--quadros") == 0 && i + 1 < argc) {
+            int lidos = sscanf(argv[++i], "%lld-%lld", &opcoes.primeiroQuadro, &opcoes.ultimoQuadro);
+            if (lidos == 1) {
+                opcoes.ultimoQuadro = opcoes.primeiroQuadro;
+            }
+            if (lidos < 1 || opcoes.primeiroQuadro <= 0 || opcoes.ultimoQuadro < opcoes.primeiroQuadro) {
+                printf("ERRO: Os quadros devem ser um movimento A ou um intervalo A-B, com 0 < A <= B (%s)\n", argv[i]);
+                exit(EXIT_FAILURE);
+            }
+        }
+        else if (strcmp(argv[i], "--agrega") == 0) {
+            opcoes.agrega = 1;
+        }
+        else if (strcmp(argv[i], "--percentil") == 0 && i + 1 < argc) {
+            opcoes.percentil = atof(argv[++i]);
+            if (!(opcoes.percentil > 0 && opcoes.percentil <= 100)) {
+                printf("ERRO: O percentil deve estar entre 0 (exclusive) e 100 (%s)\n", argv[i]);
+                exit(EXIT_FAILURE);
+            }
+        }
+        else if (strcmp(argv[i], "--regioes") == 0 && i + 1 < argc) {
+            opcoes.caminhoRegioes = argv[++i];
+        }
+        else {
+            printf("ERRO: Opcao desconhecida ou incompleta (%s)\n", argv[i]);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    // um unico modo; sem nenhuma opcao de modo, a reproducao
+    int modo = 0;
+    const char *textoModo = NULL;
+    for (k = 0; k < qtdRegras; k++) {
+        if (!informadas[k] || regras[k].modo == 0) {
+            continue;
+        }
+        if (modo != 0) {
+            printf("ERRO: As opcoes %s e %s escolhem modos diferentes\n", textoModo, regras[k].texto);
+            exit(EXIT_FAILURE);
+        }
+        modo = regras[k].modo;
+        textoModo = regras[k].texto;
+    }
+    if (modo == 0) {
+        modo = OPC_REPRODUCAO;
+    }
+    for (k = 0; k < qtdRegras; k++) {
+        if (!informadas[k] || (regras[k].modos & modo)) {
+            continue;
+        }
+        if (textoModo != NULL) {
+            printf("ERRO: A opcao %s nao vale junto com %s\n", regras[k].texto, textoModo);
+        }
+        else {
+            printf("ERRO: A opcao %s nao vale na reproducao\n", regras[k].texto);
+        }
+        exit(EXIT_FAILURE);
+    }
+
+    // na reproducao, algumas opcoes so completam outras
+    if (opcoes.aoVivo && opcoes.deltas) {
+        printf("ERRO: A animacao ao vivo nao imprime quadros delta\n");
+        exit(EXIT_FAILURE);
+    }
+    if (opcoes.intervaloChave > 0 && !opcoes.deltas) {
+        printf("ERRO: A opcao --chave so vale junto com --deltas\n");
+        exit(EXIT_FAILURE);
+    }
+    if (modo == OPC_REPRODUCAO && informouFps && !opcoes.aoVivo) {
+        printf("ERRO: A opcao --fps so vale junto com --ao-vivo\n");
+        exit(EXIT_FAILURE);
+    }
+    if (modo == OPC_REPRODUCAO && informouSemente && !opcoes.infinito) {
+        printf("ERRO: Na reproducao, a opcao --semente so vale junto com --infinito\n");
+        exit(EXIT_FAILURE);
+    }
+    if (opcoes.caminhoCache != NULL && (opcoes.aoVivo || opcoes.heatmapVivo)) {
+        printf("ERRO: O cache nao guarda a animacao ao vivo nem o heatmap vivo (%s)\n", opcoes.caminhoCache);
+        exit(EXIT_FAILURE);
+    }
+    if (opcoes.caminhoCache != NULL && opcoes.caminhoRegioes != NULL) {
+        printf("ERRO: O cache nao guarda o relatorio de regioes (%s)\n", opcoes.caminhoRegioes);
+        exit(EXIT_FAILURE);
+    }
+
+    return opcoes;
+}
+// FIM OPCOES
+
+// BIBLIOTECA
+const char *jsrVersao(void) {
+    return JSR_VERSAO;
+}
+
+jsrJogo *jsrCriaJogo(const char mapa[], size_t tamanho) {
+    FILE *arq = fmemopen((char *) mapa, tamanho, "r");
+    if (arq == NULL) {
+        return NULL;
+    }
+    tMapa *lido = leMapaArquivo(arq);
+    fclose(arq);
+    if (lido == NULL) {
+        return NULL;
+    }
+
+    jsrJogo *motor = malloc(sizeof(jsrJogo));
+    if (motor == NULL) {
+        free(lido);
+        return NULL;
+    }
+    motor->jogo = criaJogo(lido);
+    motor->exportador = NULL;
+    motor->textoResumo = NULL;
+    motor->tamResumo = 0;
+    motor->integral = NULL;
+    motor->movIntegral = 0;
+    if (motor->jogo.heatmap == NULL) {
+        liberaJogo(motor->jogo);
+        free(motor);
+        return NULL;
+    }
+
+    return motor;
+}
+
+int jsrDefineSaida(jsrJogo *motor, const char diretorio[], int intervaloSerie) {
+    // o diretorio precisa comportar o nome de arquivo mais longo, o de inicializacao
+    if (motor->jogo.caminhoSaida != NULL || adquireQtdMovimentos(motor->jogo.estatisticas) > 0 ||
+        intervaloSerie < 0 || strlen(diretorio) + strlen(ARQ_INIC) + 1 >= TAM_CAMINHO) {
+        return -1;
+    }
+
+    char *caminhoSaida = malloc(TAM_CAMINHO);
+    if (caminhoSaida == NULL) {
+        return -1;
+    }
+    strcpy(caminhoSaida, diretorio);
+    // ARQ_STTS nao comeca com barra: o diretorio de saida sempre termina nela, como DIR_SAID
+    if (diretorio[0] == '\0' || diretorio[strlen(diretorio) - 1] != '/') {
+        strcat(caminhoSaida, "/");
+    }
+
+    // sem memoria para alguma parte, o jogo continua sem saida
+    tJogo jogo = motor->jogo;
+    jogo.caminhoSaida = caminhoSaida;
+    tExportador *exportador = inicializaExportador(caminhoSaida);
+    if (exportador != NULL) {
+        jogo = habilitaExportador(jogo, exportador);
+    }
+    if (intervaloSerie > 0) {
+        jogo = habilitaSerie(jogo, intervaloSerie);
+    }
+    if (exportador == NULL || (intervaloSerie > 0 && jogo.sujas == NULL) || exportaInicializacao(jogo) != 0) {
+        encerraExportador(exportador);
+        liberaSujas(jogo.sujas);
+        free(caminhoSaida);
+        return -1;
+    }
+
+    motor->jogo = jogo;
+    motor->exportador = exportador;
+    return 0;
+}
+
+int jsrDefineInfinito(jsrJogo *motor, unsigned long long semente) {
+    if (motor->jogo.partida.infinito != NULL || adquireQtdMovimentos(motor->jogo.estatisticas) > 0) {
+        return -1;
+    }
+
+    motor->jogo = habilitaInfinito(motor->jogo, semente);
+    return motor->jogo.partida.infinito != NULL ? 0 : -1;
+}
+
+int jsrDefineResumo(jsrJogo *motor) {
+    if (motor->jogo.resumo != NULL || adquireQtdMovimentos(motor->jogo.estatisticas) > 0) {
+        return -1;
+    }
+
+    motor->jogo.resumo = open_memstream(&motor->textoResumo, &motor->tamResumo);
+    return motor->jogo.resumo != NULL ? 0 : -1;
+}
+
+int jsrDefineEventos(jsrJogo *motor) {
+    if (motor->jogo.caminhoSaida == NULL || motor->jogo.gravaEventos || adquireQtdMovimentos(motor->jogo.estatisticas) > 0) {
+        return -1;
+    }
+
+    motor->jogo = habilitaEventos(motor->jogo);
+    return 0;
+}
+
+int jsrDefineHeatmapVivo(jsrJogo *motor) {
+    if (motor->jogo.caminhoSaida == NULL || motor->jogo.heatmap->vivo != NULL) {
+        return -1;
+    }
+
+    return habilitaHeatmapVivo(&motor->jogo);
+}
+
+int jsrRegistraTratador(jsrJogo *motor, jsrTratador tratador, void *contexto) {
+    motor->jogo = registraTratador(motor->jogo, (tTratadorEvento) tratador, contexto);
+    return 0;
+}
+
+int jsrJoga(jsrJogo *motor, const char movimentos[], int qtd) {
+    int i;
+    for (i = 0; i < qtd && !acabou(motor->jogo); i++) {
+        motor->jogo = fazRodada(motor->jogo, movimentos[i]);
+    }
+
+    return i;
+}
+
+void jsrConsulta(const jsrJogo *motor, jsrEstado *estado) {
+    const tJogo *jogo = &motor->jogo;
+    const tCobra *cobra = adquireCobra(&jogo->partida);
+    tPosicao cab = adquireCabeca(cobra);
+
+    estado->nLinhas = adquireLinhas(jogo->mapa);
+    estado->mColunas = adquireColunas(jogo->mapa);
+    estado->estado = jogo->partida.estado;
+    estado->pontuacao = jogo->partida.pontuacao;
+    estado->qtdMovimentos = adquireQtdMovimentos(jogo->estatisticas);
+    estado->qtdComida = adquireQtdComida(&jogo->partida);
+    estado->tamanho = adquireTamanho(cobra);
+    estado->cabecaI = adquireI(cab);
+    estado->cabecaJ = adquireJ(cab);
+}
+
+size_t jsrArtefato(const jsrJogo *motor, int artefato, char buffer[], size_t capacidade) {
+    const tJogo *jogo = &motor->jogo;
+    int n = adquireLinhas(jogo->mapa);
+    int m = adquireColunas(jogo->mapa);
+
+    // os artefatos sao escritos pelas mesmas funcoes que escrevem os arquivos
+    char *texto = NULL;
+    size_t tam = 0;
+    FILE *arq = open_memstream(&texto, &tam);
+    if (arq == NULL) {
+        if (capacidade > 0) {
+            buffer[0] = '\0';
+        }
+        return 0;
+    }
+
+    switch (artefato) {
+        case JSR_ART_TABULEIRO:
+            escreveMapa(arq, jogo->mapa, &jogo->partida);
+            escrevePlacar(arq, jogo->partida.pontuacao, jogo->partida.estado);
+            break;
+
+        case JSR_ART_INICIALIZACAO: {
+            tPartida inicial = inicializaPartida(jogo->mapa);
+            if (inicial.cobra.corpo.vet == NULL) {
+                break;
+            }
+            char tabuleiro[TAM_MAPA][TAM_MAPA];
+            char plano[TAM_MAPA * TAM_MAPA];
+            desenhaTabuleiro(jogo->mapa, &inicial, tabuleiro);
+
+            int i;
+            for (i = 0; i < n; i++) {
+                memcpy(plano + i * m, tabuleiro[i], m);
+            }
+            tQuadroInicial quadro = { n, m, plano, adquireCabeca(adquireCobra(&inicial)) };
+            escreveInicializacao(arq, &quadro);
+            liberaPartida(&inicial);
+            break;
+        }
+
+        case JSR_ART_RESUMO:
+            if (jogo->resumo != NULL) {
+                fflush(jogo->resumo);
+                fwrite(motor->textoResumo, 1, motor->tamResumo, arq);
+            }
+            break;
+
+        case JSR_ART_ESTATISTICAS:
+            escreveEstatisticas(arq, jogo->estatisticas);
+            break;
+
+        case JSR_ART_HEATMAP:
+            escreveHeatmap(arq, n, m, jogo->heatmap);
+            break;
+
+        case JSR_ART_RANKING:
+            escreveRanking(arq, n, m, jogo->heatmap);
+            break;
+    }
+    fclose(arq);
+
+    if (capacidade > 0) {
+        size_t copiados = tam < capacidade ? tam : capacidade - 1;
+        memcpy(buffer, texto, copiados);
+        buffer[copiados] = '\0';
+    }
+    free(texto);
+
+    return tam;
+}
+
+long long jsrSomaRegiao(jsrJogo *motor, int i1, int j1, int i2, int j2) {
+    // atualizar a tabela a cada movimento custaria o mapa inteiro; ela e reconstruida so quando consultada apos movimentos
+    long long qtdMov = adquireQtdMovimentos(motor->jogo.estatisticas);
+    if (motor->integral == NULL) {
+        motor->integral = inicializaIntegral(adquireLinhas(motor->jogo.mapa), adquireColunas(motor->jogo.mapa), motor->jogo.heatmap);
+        if (motor->integral == NULL) {
+            return -1;
+        }
+        motor->movIntegral = qtdMov;
+    }
+    else if (motor->movIntegral != qtdMov) {
+        constroiIntegral(motor->integral, motor->jogo.heatmap);
+        motor->movIntegral = qtdMov;
+    }
+
+    return somaRegiao(motor->integral, i1, j1, i2, j2);
+}
+
+int jsrLiberaJogo(jsrJogo *motor) {
+    if (motor == NULL) {
+        return 0;
+    }
+
+    int exportado = exportaJogo(motor->jogo);
+    if (motor->jogo.caminhoSaida != NULL && motor->jogo.heatmap->incompleto) {
+        exportado = -1;
+    }
+    if (motor->jogo.resumo != NULL) {
+        fclose(motor->jogo.resumo);
+    }
+    free(motor->textoResumo);
+    liberaJogo(motor->jogo);
+    if (encerraExportador(motor->exportador) != 0) {
+        exportado = -1;
+    }
+    liberaIntegral(motor->integral);
+    free(motor);
+    return exportado;
+}
+
+const tJogo *adquireJogo(const jsrJogo *motor) {
+    return &motor->jogo;
+}
+
+jsrJogo *abreJogo(char caminhoBase[], int intervaloSerie) {
+    char caminhoMapa[TAM_CAMINHO];
+    combinaCaminho(caminhoMapa, caminhoBase, ARQ_MAPA);
+    FILE *arq = fopen(caminhoMapa, "r");
+
+    if (arq == NULL){
+        printf("ERRO: O arquivo de configuração do mapa (%s) nao foi encontrado\n", caminhoMapa);
+        exit(EXIT_FAILURE);
+    }
+
+    // a linha de comando entrega o mapa a API como qualquer outro cliente: em memoria
+    fseek(arq, 0, SEEK_END);
+    long tam = ftell(arq);
+    rewind(arq);
+    char *texto = malloc(tam > 0 ? tam : 1);
+    if (texto == NULL) {
+        printf("ERRO: Memoria insuficiente para o mapa\n");
+        exit(EXIT_FAILURE);
+    }
+    tam = fread(texto, 1, tam, arq);
+    fclose(arq);
+
+    jsrJogo *motor = jsrCriaJogo(texto, tam);
+    free(texto);
+    if (motor == NULL) {
+        printf("ERRO: O arquivo de configuração do mapa (%s) e invalido\n", caminhoMapa);
+        exit(EXIT_FAILURE);
+    }
+
+    char caminhoSaida[TAM_CAMINHO];
+    combinaCaminho(caminhoSaida, caminhoBase, DIR_SAID);
+    if (jsrDefineSaida(motor, caminhoSaida, intervaloSerie) != 0) {
+        printf("ERRO: O diretorio de saida (%s) e longo demais, inacessivel ou faltou memoria para a saida\n", caminhoSaida);
+        exit(EXIT_FAILURE);
+    }
+
+    return motor;
+}
+
+int jsrAgregaHeatmaps(const char *const arquivos[], int qtd, int qtdThreads, double percentil, jsrAgregado *agregado) {
+    if (qtd <= 0 || !(percentil >= 0 && percentil <= 100)) {
+        return -1;
+    }
+
+    int invalido = agregaHeatmaps(arquivos, qtd, qtdThreads, percentil, (tAgregado *)agregado);
+    return invalido == AGR_SEM_MEMORIA ? -2 : invalido + 1;
+}
+
+void jsrLiberaAgregado(jsrAgregado *agregado) {
+    liberaAgregado((tAgregado *)agregado);
+}
+// FIM BIBLIOTECA
+
+// AGREGADOR
+void agregaEntrada(char caminhoBase[], int qtdThreads, double percentil, const tRegiao regioes[], int qtdRegioes) {
+    int capacidade = 64;
+    int qtd = 0;
+    char **arquivos = malloc(capacidade * sizeof(char *));
+    if (arquivos == NULL) {
+        printf("ERRO: Memoria insuficiente para a agregacao\n");
+        exit(EXIT_FAILURE);
+    }
+
+    // um caminho por linha; linhas vazias sao ignoradas
+    char linha[TAM_CAMINHO];
+    while (fgets(linha, sizeof(linha), stdin) != NULL) {
+        linha[strcspn(linha, "\r\n")] = '\0';
+        if (linha[0] == '\0') {
+            continue;
+        }
+
+        if (qtd == capacidade) {
+            capacidade *= 2;
+            char **maior = realloc(arquivos, capacidade * sizeof(char *));
+            if (maior == NULL) {
+                printf("ERRO: Memoria insuficiente para a agregacao\n");
+                exit(EXIT_FAILURE);
+            }
+            arquivos = maior;
+        }
+        arquivos[qtd] = malloc(strlen(linha) + 1);
+        if (arquivos[qtd] == NULL) {
+            printf("ERRO: Memoria insuficiente para a agregacao\n");
+            exit(EXIT_FAILURE);
+        }
+        strcpy(arquivos[qtd++], linha);
+    }
+    if (qtd == 0) {
+        printf("ERRO: Nenhum heatmap foi informado na entrada padrao\n");
+        exit(EXIT_FAILURE);
+    }
+
+    tAgregado agregado;
+    int invalido = agregaHeatmaps((const char *const *)arquivos, qtd, qtdThreads, percentil, &agregado);
+    if (invalido == AGR_SEM_MEMORIA) {
+        printf("ERRO: Memoria insuficiente para a agregacao\n");
+        exit(EXIT_FAILURE);
+    }
+    if (invalido >= 0) {
+        printf("ERRO: O heatmap (%s) e invalido ou tem dimensoes diferentes das do primeiro\n", arquivos[invalido]);
+        exit(EXIT_FAILURE);
+    }
+
+    char caminhoSaida[TAM_CAMINHO];
+    combinaCaminho(caminhoSaida, caminhoBase, DIR_SAID);
+    exportaAgregado(&agregado, regioes, qtdRegioes, caminhoSaida);
+
+    liberaAgregado(&agregado);
+    int i;
+    for (i = 0; i < qtd; i++) {
+        free(arquivos[i]);
+    }
+    free(arquivos);
+}
+
+int agregaHeatmaps(const char *const arquivos[], int qtdArquivos, int qtdThreads, double percentil, tAgregado *agregado) {
+    // as dimensoes do primeiro arquivo valem para todos
+    long long *contagens = malloc(TAM_MAPA * TAM_MAPA * sizeof(long long));
+    if (contagens == NULL) {
+        return AGR_SEM_MEMORIA;
+    }
+    int nLinhas, mColunas;
+    int lido = leHeatmapArquivo(arquivos[0], &nLinhas, &mColunas, contagens);
+    free(contagens);
+    if (lido != 0) {
+        return lido == AGR_SEM_MEMORIA ? AGR_SEM_MEMORIA : 0;
+    }
+
+    if (qtdThreads <= 0) {
+        qtdThreads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    }
+    if (qtdThreads <= 0) {
+        qtdThreads = 1;
+    }
+    if (qtdThreads > qtdArquivos) {
+        qtdThreads = qtdArquivos;
+    }
+
+    int nCelulas = nLinhas * mColunas;
+    memset(agregado, 0, sizeof(tAgregado));
+    agregado->nLinhas = nLinhas;
+    agregado->mColunas = mColunas;
+    agregado->qtdHeatmaps = qtdArquivos;
+    agregado->soma = malloc(nCelulas * sizeof(long long));
+    agregado->maximo = malloc(nCelulas * sizeof(long long));
+    agregado->media = malloc(nCelulas * sizeof(double));
+    long long *somas = malloc((size_t)qtdThreads * nCelulas * sizeof(long long));
+    long long *maximos = malloc((size_t)qtdThreads * nCelulas * sizeof(long long));
+    long long *valores = NULL;
+    if (percentil > 0) {
+        agregado->percentil = malloc(nCelulas * sizeof(long long));
+        valores = malloc((size_t)nCelulas * qtdArquivos * sizeof(long long));
+    }
+    tTrabalhadorAg *trabalhadores = malloc(qtdThreads * sizeof(tTrabalhadorAg));
+    pthread_t *threads = malloc(qtdThreads * sizeof(pthread_t));
+    if (agregado->soma == NULL || agregado->maximo == NULL || agregado->media == NULL || somas == NULL || maximos == NULL ||
+        (percentil > 0 && (agregado->percentil == NULL || valores == NULL)) || trabalhadores == NULL || threads == NULL) {
+        liberaAgregado(agregado);
+        free(somas);
+        free(maximos);
+        free(valores);
+        free(trabalhadores);
+        free(threads);
+        return AGR_SEM_MEMORIA;
+    }
+
+    // distribui os arquivos, e depois as linhas, igualmente entre as threads
+    int primeiroArquivo = 0;
+    int primeiraLinha = 0;
+    int t;
+    for (t = 0; t < qtdThreads; t++) {
+        trabalhadores[t].arquivos = arquivos;
+        trabalhadores[t].qtdArquivos = qtdArquivos;
+        trabalhadores[t].primeiroArquivo = primeiroArquivo;
+        trabalhadores[t].fimArquivos = primeiroArquivo + qtdArquivos / qtdThreads + (t < qtdArquivos % qtdThreads);
+        primeiroArquivo = trabalhadores[t].fimArquivos;
+        trabalhadores[t].primeiraLinha = primeiraLinha;
+        trabalhadores[t].fimLinhas = primeiraLinha + nLinhas / qtdThreads + (t < nLinhas % qtdThreads);
+        primeiraLinha = trabalhadores[t].fimLinhas;
+        trabalhadores[t].id = t;
+        trabalhadores[t].qtdThreads = qtdThreads;
+        trabalhadores[t].somas = somas;
+        trabalhadores[t].maximos = maximos;
+        trabalhadores[t].valores = valores;
+        trabalhadores[t].invalido = -1;
+        trabalhadores[t].semMemoria = 0;
+        trabalhadores[t].percentil = percentil;
+        trabalhadores[t].agregado = agregado;
+    }
+
+    // o trabalho de uma thread que nao pode ser criada e feito na propria thread
+    int paralelo[qtdThreads];
+    for (t = 0; t < qtdThreads; t++) {
+        paralelo[t] = pthread_create(&threads[t], NULL, executaLeituraAg, &trabalhadores[t]) == 0;
+        if (!paralelo[t]) {
+            executaLeituraAg(&trabalhadores[t]);
+        }
+    }
+
+    // os blocos estao em ordem: o primeiro invalido e o da primeira thread que achou algum
+    int invalido = -1;
+    int semMemoria = 0;
+    for (t = 0; t < qtdThreads; t++) {
+        if (paralelo[t]) {
+            pthread_join(threads[t], NULL);
+        }
+        if (invalido < 0) {
+            invalido = trabalhadores[t].invalido;
+        }
+        semMemoria |= trabalhadores[t].semMemoria;
+    }
+    if (semMemoria) {
+        invalido = AGR_SEM_MEMORIA;
+    }
+
+    if (invalido == -1) {
+        for (t = 0; t < qtdThreads; t++) {
+            paralelo[t] = pthread_create(&threads[t], NULL, executaReducaoAg, &trabalhadores[t]) == 0;
+            if (!paralelo[t]) {
+                executaReducaoAg(&trabalhadores[t]);
+            }
+        }
+        for (t = 0; t < qtdThreads; t++) {
+            if (paralelo[t]) {
+                pthread_join(threads[t], NULL);
+            }
+        }
+    }
+    else {
+        liberaAgregado(agregado);
+    }
+
+    free(somas);
+    free(maximos);
+    free(valores);
+    free(trabalhadores);
+    free(threads);
+    return invalido;
+}
+
+void *executaLeituraAg(void *arg) {
+    tTrabalhadorAg *trabalhador = arg;
+    const tAgregado *agregado = trabalhador->agregado;
+    int nCelulas = agregado->nLinhas * agregado->mColunas;
+    long long *soma = trabalhador->somas + (size_t)trabalhador->id * nCelulas;
+    long long *maximo = trabalhador->maximos + (size_t)trabalhador->id * nCelulas;
+    // os contadores nunca sao negativos: zero e o maximo de nenhum arquivo
+    memset(soma, 0, nCelulas * sizeof(long long));
+    memset(maximo, 0, nCelulas * sizeof(long long));
+
+    long long *contagens = malloc(TAM_MAPA * TAM_MAPA * sizeof(long long));
+    if (contagens == NULL) {
+        trabalhador->semMemoria = 1;
+        return NULL;
+    }
+
+    int a;
+    for (a = trabalhador->primeiroArquivo; a < trabalhador->fimArquivos; a++) {
+        int nLinhas, mColunas;
+        int lido = leHeatmapArquivo(trabalhador->arquivos[a], &nLinhas, &mColunas, contagens);
+        if (lido == AGR_SEM_MEMORIA) {
+            trabalhador->semMemoria = 1;
+            break;
+        }
+        if (lido != 0 || nLinhas != agregado->nLinhas || mColunas != agregado->mColunas) {
+            trabalhador->invalido = a;
+            break;
+        }
+
+        int c;
+        for (c = 0; c < nCelulas; c++) {
+            soma[c] += contagens[c];
+            if (contagens[c] > maximo[c]) {
+                maximo[c] = contagens[c];
+            }
+        }
+        if (trabalhador->valores != NULL) {
+            for (c = 0; c < nCelulas; c++) {
+                trabalhador->valores[(size_t)c * trabalhador->qtdArquivos + a] = contagens[c];
+            }
+        }
+    }
+
+    free(contagens);
+    return NULL;
+}
+
+void *executaReducaoAg(void *arg) {
+    tTrabalhadorAg *trabalhador = arg;
+    tAgregado *agregado = trabalhador->agregado;
+    int nCelulas = agregado->nLinhas * agregado->mColunas;
+    int qtdArquivos = trabalhador->qtdArquivos;
+
+    // o posto mais proximo: o menor valor que ao menos percentil% dos arquivos nao ultrapassam
+    double alvo = trabalhador->percentil * qtdArquivos / 100.0;
+    int posto = (int)alvo;
+    if (posto < alvo) {
+        posto++;
+    }
+    if (posto < 1) {
+        posto = 1;
+    }
+    if (posto > qtdArquivos) {
+        posto = qtdArquivos;
+    }
+
+    int c;
+    for (c = trabalhador->primeiraLinha * agregado->mColunas; c < trabalhador->fimLinhas * agregado->mColunas; c++) {
+        long long soma = 0;
+        long long maximo = 0;
+        int t;
+        for (t = 0; t < trabalhador->qtdThreads; t++) {
+            soma += trabalhador->somas[(size_t)t * nCelulas + c];
+            if (trabalhador->maximos[(size_t)t * nCelulas + c] > maximo) {
+                maximo = trabalhador->maximos[(size_t)t * nCelulas + c];
+            }
+        }
+        agregado->soma[c] = soma;
+        agregado->maximo[c] = maximo;
+        agregado->media[c] = (double)soma / qtdArquivos;
+
+        if (agregado->percentil != NULL) {
+            long long *valores = trabalhador->valores + (size_t)c * qtdArquivos;
+            qsort(valores, qtdArquivos, sizeof(long long), comparaValorAg);
+            agregado->percentil[c] = valores[posto - 1];
+        }
+    }
+
+    return NULL;
+}
+
+int comparaValorAg(const void *v1, const void *v2) {
+    long long valor1 = *(const long long *)v1;
+    long long valor2 = *(const long long *)v2;
+    return (valor1 > valor2) - (valor1 < valor2);
+}
+
+int leHeatmapArquivo(const char caminho[], int *nLinhas, int *mColunas, long long contagens[]) {
+    FILE *arq = fopen(caminho, "rb");
+    if (arq == NULL) {
+        return -1;
+    }
+    struct stat info;
+    if (fstat(fileno(arq), &info) != 0 || !S_ISREG(info.st_mode)) {
+        fclose(arq);
+        return -1;
+    }
+
+    // um '\0' a mais termina o texto
+    unsigned char *dados = malloc(info.st_size + 1);
+    if (dados == NULL) {
+        fclose(arq);
+        return AGR_SEM_MEMORIA;
+    }
+    size_t tam = fread(dados, 1, info.st_size, arq);
+    fclose(arq);
+    dados[tam] = '\0';
+
+    // o formato e reconhecido pela assinatura; sem nenhuma, e texto
+    int lido;
+    if (tam >= sizeof(HMV_ASSN) && memcmp(dados, HMV_ASSN, sizeof(HMV_ASSN)) == 0) {
+        lido = leHeatmapVivo(dados, tam, nLinhas, mColunas, contagens);
+    }
+    else if (tam >= strlen(SER_ASSN) && memcmp(dados, SER_ASSN, strlen(SER_ASSN)) == 0) {
+        lido = leHeatmapSerie(dados, tam, nLinhas, mColunas, contagens);
+    }
+    else {
+        lido = leHeatmapTexto((const char *)dados, nLinhas, mColunas, contagens);
+    }
+
+    free(dados);
+    return lido;
+}
+
+int leHeatmapTexto(const char texto[], int *nLinhas, int *mColunas, long long contagens[]) {
+    int n = 0;
+    int m = 0;
+    int j = 0;
+    const char *p = texto;
+    while (1) {
+        if (*p == ' ') {
+            p++;
+            continue;
+        }
+        if (*p == '\n' || *p == '\0') {
+            // a ultima linha pode nao terminar em '\n'; todas tem as colunas da primeira
+            if (j > 0 || *p == '\n') {
+                if (j == 0 || (n > 0 && j != m)) {
+                    return -1;
+                }
+                m = j;
+                n++;
+                j = 0;
+            }
+            if (*p++ == '\0') {
+                break;
+            }
+            continue;
+        }
+
+        if (*p < '0' || *p > '9' || n == TAM_MAPA || j == TAM_MAPA) {
+            return -1;
+        }
+        char *fim;
+        errno = 0;
+        long long valor = strtoll(p, &fim, 10);
+        if (errno != 0) {
+            return -1;
+        }
+        contagens[n * m + j++] = valor;
+        p = fim;
+    }
+
+    if (n == 0) {
+        return -1;
+    }
+    *nLinhas = n;
+    *mColunas = m;
+    return 0;
+}
+
+int leHeatmapVivo(const unsigned char dados[], size_t tam, int *nLinhas, int *mColunas, long long contagens[]) {
+    tCabecalhoVivo cabecalho;
+    if (tam < sizeof(cabecalho)) {
+        return -1;
+    }
+    memcpy(&cabecalho, dados, sizeof(cabecalho));
+
+    if (memcmp(cabecalho.assinatura, HMV_ASSN, sizeof(HMV_ASSN)) != 0 || cabecalho.nLinhas < 1 || cabecalho.nLinhas > TAM_MAPA ||
+        cabecalho.mColunas < 1 || cabecalho.mColunas > TAM_MAPA) {
+        return -1;
+    }
+    size_t nCelulas = cabecalho.nLinhas * cabecalho.mColunas;
+    if (tam != sizeof(cabecalho) + nCelulas * sizeof(unsigned long long)) {
+        return -1;
+    }
+
+    memcpy(contagens, dados + sizeof(cabecalho), nCelulas * sizeof(unsigned long long));
+    *nLinhas = cabecalho.nLinhas;
+    *mColunas = cabecalho.mColunas;
+    return 0;
+}
+
+int leHeatmapSerie(const unsigned char dados[], size_t tam, int *nLinhas, int *mColunas, long long contagens[]) {
+    const unsigned char *p = dados + strlen(SER_ASSN);
+    const unsigned char *fim = dados + tam;
+    unsigned long n, m, intervalo;
+    if (leVarint(&p, fim, &n) != 0 || leVarint(&p, fim, &m) != 0 || leVarint(&p, fim, &intervalo) != 0 ||
+        n < 1 || n > TAM_MAPA || m < 1 || m > TAM_MAPA) {
+        return -1;
+    }
+    unsigned long nCelulas = n * m;
+    memset(contagens, 0, nCelulas * sizeof(long long));
+
+    // cada snapshot: varint(movimento) varint(qtd) e qtd pares varint(distancia da celula anterior) varint(incremento)
+    while (p < fim) {
+        unsigned long movimento, qtd;
+        if (leVarint(&p, fim, &movimento) != 0 || leVarint(&p, fim, &qtd) != 0) {
+            return -1;
+        }
+
+        unsigned long celula = 0;
+        unsigned long k;
+        for (k = 0; k < qtd; k++) {
+            unsigned long distancia, incremento;
+            if (leVarint(&p, fim, &distancia) != 0 || leVarint(&p, fim, &incremento) != 0 || distancia >= nCelulas - celula) {
+                return -1;
+            }
+            celula += distancia;
+            contagens[celula] += incremento;
+        }
+    }
+
+    *nLinhas = (int)n;
+    *mColunas = (int)m;
+    return 0;
+}
+
+void exportaAgregado(const tAgregado *agregado, const tRegiao regioes[], int qtdRegioes, char caminhoSaida[]) {
+    int nLinhas = agregado->nLinhas;
+    int mColunas = agregado->mColunas;
+
+    // a media, o maximo e o percentil, no mesmo leiaute de ARQ_HMAP
+    char *nomes[3] = { ARQ_HMMD, ARQ_HMMX, ARQ_HMPC };
+    const long long *valores[3] = { NULL, agregado->maximo, agregado->percentil };
+    int qtdArquivos = agregado->percentil != NULL ? 3 : 2;
+    int k;
+    for (k = 0; k < qtdArquivos; k++) {
+        char caminho[TAM_CAMINHO];
+        combinaCaminho(caminho, caminhoSaida, nomes[k]);
+        FILE *arq = fopen(caminho, "w");
+        if (arq == NULL) {
+            printf("ERRO: Nao foi possivel criar o arquivo do agregado (%s)\n", caminho);
+            exit(EXIT_FAILURE);
+        }
+
+        int i;
+        for (i = 0; i < nLinhas; i++) {
+            int j;
+            for (j = 0; j < mColunas; j++) {
+                if (valores[k] == NULL) {
+                    fprintf(arq, "%.2f", agregado->media[i * mColunas + j]);
+                }
+                else {
+                    fprintf(arq, "%lld", valores[k][i * mColunas + j]);
+                }
+                if (j < mColunas - 1)
+                    fprintf(arq, "%c", ' ');
+            }
+            fprintf(arq, "%c", '\n');
+        }
+        fclose(arq);
+    }
+
+    // a soma sai em ARQ_HMAP e ARQ_RANK, como o heatmap de um unico jogo
+    tHeatmap *heatmap = inicializaHeatmap(nLinhas * mColunas);
+    int c;
+    for (c = 0; heatmap != NULL && c < nLinhas * mColunas; c++) {
+        somaAcessos(heatmap, c, agregado->soma[c]);
+    }
+    if (heatmap == NULL || heatmap->incompleto) {
+        printf("ERRO: Memoria insuficiente para a agregacao\n");
+        exit(EXIT_FAILURE);
+    }
+    exportaHeatmap(nLinhas, mColunas, heatmap, caminhoSaida);
+    exportaRanking(nLinhas, mColunas, heatmap, caminhoSaida);
+    if (regioes != NULL) {
+        exportaRegioes(nLinhas, mColunas, heatmap, regioes, qtdRegioes, caminhoSaida);
+    }
+    liberaHeatmap(heatmap);
+}
+
+void liberaAgregado(tAgregado *agregado) {
+    free(agregado->soma);
+    free(agregado->maximo);
+    free(agregado->media);
+    free(agregado->percentil);
+}
+// FIM AGREGADOR
+
+// SERVIDOR
+void executaServidor(const char caminhoSocket[]) {
+    struct sockaddr_un endereco;
+    memset(&endereco, 0, sizeof(endereco));
+    endereco.sun_family = AF_UNIX;
+    if (strlen(caminhoSocket) >= sizeof(endereco.sun_path)) {
+        printf("ERRO: O caminho do socket e longo demais (%s)\n", caminhoSocket);
+        exit(EXIT_FAILURE);
+    }
+    strcpy(endereco.sun_path, caminhoSocket);
+
+    tServidor *servidor = calloc(1, sizeof(tServidor));
+    if (servidor == NULL) {
+        printf("ERRO: Memoria insuficiente para o servidor\n");
+        exit(EXIT_FAILURE);
+    }
+
+    // SIGINT e SIGTERM chegam pelo signalfd, dentro do laco de eventos, e nao interrompem um comando no meio
+    sigset_t sinais;
+    sigemptyset(&sinais);
+    sigaddset(&sinais, SIGINT);
+    sigaddset(&sinais, SIGTERM);
+    sigprocmask(SIG_BLOCK, &sinais, NULL);
+    signal(SIGPIPE, SIG_IGN);
+
+    servidor->fdSinal = signalfd(-1, &sinais, SFD_NONBLOCK);
+    servidor->fdEscuta = socket(AF_UNIX, SOCK_STREAM, 0);
+    servidor->epoll = epoll_create1(0);
+    if (servidor->fdSinal < 0 || servidor->fdEscuta < 0 || servidor->epoll < 0) {
+        printf("ERRO: Nao foi possivel criar o servidor (%s)\n", strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+
+    unlink(caminhoSocket);
+    if (bind(servidor->fdEscuta, (struct sockaddr *) &endereco, sizeof(endereco)) < 0 || listen(servidor->fdEscuta, SOMAXCONN) < 0) {
+        printf("ERRO: Nao foi possivel escutar em %s (%s)\n", caminhoSocket, strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+    fcntl(servidor->fdEscuta, F_SETFL, fcntl(servidor->fdEscuta, F_GETFL) | O_NONBLOCK);
+
+    struct epoll_event evento;
+    evento.events = EPOLLIN;
+    evento.data.ptr = &servidor->fdEscuta;
+    epoll_ctl(servidor->epoll, EPOLL_CTL_ADD, servidor->fdEscuta, &evento);
+    evento.data.ptr = &servidor->fdSinal;
+    epoll_ctl(servidor->epoll, EPOLL_CTL_ADD, servidor->fdSinal, &evento);
+
+    printf("Servidor escutando em %s\n", caminhoSocket);
+    fflush(stdout);
+
+    struct epoll_event eventos[SRV_EVENTOS];
+    int ativo = 1;
+    while (ativo) {
+        int qtd = epoll_wait(servidor->epoll, eventos, SRV_EVENTOS, -1);
+        if (qtd < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            printf("ERRO: Falha no laco de eventos (%s)\n", strerror(errno));
+            exit(EXIT_FAILURE);
+        }
+
+        int i;
+        for (i = 0; i < qtd; i++) {
+            void *origem = eventos[i].data.ptr;
+            if (origem == &servidor->fdSinal) {
+                ativo = 0;
+                continue;
+            }
+            if (origem == &servidor->fdEscuta) {
+                aceitaSessoes(servidor);
+                continue;
+            }
+
+            tSessao *sessao = origem;
+            if (eventos[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+                leSessao(servidor, sessao);
+            }
+            else if (eventos[i].events & EPOLLOUT) {
+                // com a saida enviada, retoma os comandos retidos pelo limite de SRV_SAIDA_MAX
+                if (escreveSessao(servidor, sessao) && sessao->qtdSaida == 0) {
+                    leSessao(servidor, sessao);
+                }
+            }
+        }
+    }
+
+    while (servidor->qtdSessoes > 0) {
+        fechaSessao(servidor, servidor->sessoes[servidor->qtdSessoes - 1]);
+    }
+    int i;
+    for (i = 0; i < servidor->qtdCache; i++) {
+        free(servidor->cache[i].mapa);
+    }
+    close(servidor->fdEscuta);
+    close(servidor->fdSinal);
+    close(servidor->epoll);
+    unlink(caminhoSocket);
+    free(servidor->sessoes);
+    free(servidor);
+
+    printf("Servidor encerrado\n");
+}
+
+void aceitaSessoes(tServidor *servidor) {
+    for (;;) {
+        int fd = accept(servidor->fdEscuta, NULL, NULL);
+        if (fd < 0) {
+            // EAGAIN: nao ha mais conexoes pendentes; demais erros (ex.: EMFILE) sao tentados no proximo evento
+            return;
+        }
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+
+        tSessao *sessao = malloc(sizeof(tSessao));
+        if (sessao == NULL) {
+            close(fd);
+            return;
+        }
+        sessao->fd = fd;
+        sessao->mapa = NULL;
+        sessao->possuiMapa = 0;
+        sessao->partida.cobra.corpo.vet = NULL;
+        sessao->qtdMov = 0;
+        sessao->encerra = 0;
+        sessao->fimEntrada = 0;
+        sessao->falha = 0;
+        sessao->qtdEntrada = 0;
+        sessao->qtdSaida = 0;
+        sessao->capSaida = 0;
+        sessao->saida = NULL;
+
+        if (servidor->qtdSessoes == servidor->capSessoes) {
+            int capSessoes = servidor->capSessoes ? 2 * servidor->capSessoes : 64;
+            tSessao **sessoes = realloc(servidor->sessoes, capSessoes * sizeof(tSessao *));
+            if (sessoes == NULL) {
+                // recusa apenas a nova conexao; as sessoes abertas seguem intactas
+                free(sessao);
+                close(fd);
+                return;
+            }
+            servidor->capSessoes = capSessoes;
+            servidor->sessoes = sessoes;
+        }
+        sessao->indice = servidor->qtdSessoes;
+        servidor->sessoes[servidor->qtdSessoes++] = sessao;
+
+        struct epoll_event evento;
+        evento.events = EPOLLIN;
+        evento.data.ptr = sessao;
+        epoll_ctl(servidor->epoll, EPOLL_CTL_ADD, fd, &evento);
+    }
+}
+
+void fechaSessao(tServidor *servidor, tSessao *sessao) {
+    epoll_ctl(servidor->epoll, EPOLL_CTL_DEL, sessao->fd, NULL);
+    close(sessao->fd);
+
+    // remove em O(1), trazendo a ultima sessao para o lugar da fechada
+    tSessao *ultima = servidor->sessoes[--servidor->qtdSessoes];
+    servidor->sessoes[sessao->indice] = ultima;
+    ultima->indice = sessao->indice;
+
+    if (sessao->possuiMapa) {
+        free((tMapa *) sessao->mapa);
+    }
+    liberaPartida(&sessao->partida);
+    free(sessao->saida);
+    free(sessao);
+}
+
+void leSessao(tServidor *servidor, tSessao *sessao) {
+    // acima de SRV_SAIDA_MAX a sessao para de ler: o restante fica no socket ate o cliente receber as respostas
+    while (!sessao->fimEntrada && sessao->qtdSaida < SRV_SAIDA_MAX) {
+        if (sessao->qtdEntrada == SRV_ENTRADA) {
+            processaEntrada(servidor, sessao);
+            if (sessao->qtdSaida >= SRV_SAIDA_MAX) {
+                break;
+            }
+            if (sessao->qtdEntrada == SRV_ENTRADA) {
+                respondeSessao(sessao, "ERRO Comando longo demais\n");
+                sessao->encerra = 1;
+                break;
+            }
+        }
+
+        ssize_t lidos = read(sessao->fd, sessao->entrada + sessao->qtdEntrada, SRV_ENTRADA - sessao->qtdEntrada);
+        if (lidos > 0) {
+            sessao->qtdEntrada += lidos;
+            continue;
+        }
+        if (lidos < 0 && errno == EINTR) {
+            continue;
+        }
+        if (lidos < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        }
+        if (lidos < 0) {
+            fechaSessao(servidor, sessao);
+            return;
+        }
+
+        // fim da conexao: uma ultima linha sem '\n' ainda e um comando
+        if (sessao->qtdEntrada > 0 && sessao->qtdEntrada < SRV_ENTRADA) {
+            sessao->entrada[sessao->qtdEntrada++] = '\n';
+        }
+        sessao->fimEntrada = 1;
+    }
+
+    processaEntrada(servidor, sessao);
+    // com o envio encerrado, a sessao fecha quando todos os comandos recebidos tiverem sido processados
+    if (sessao->fimEntrada && sessao->qtdSaida < SRV_SAIDA_MAX) {
+        sessao->encerra = 1;
+    }
+    escreveSessao(servidor, sessao);
+}
+
+void processaEntrada(tServidor *servidor, tSessao *sessao) {
+    int inicio = 0;
+    while (!sessao->encerra && sessao->qtdSaida < SRV_SAIDA_MAX) {
+        char *linha = sessao->entrada + inicio;
+        char *fimLinha = memchr(linha, '\n', sessao->qtdEntrada - inicio);
+        if (fimLinha == NULL) {
+            break;
+        }
+        *fimLinha = '\0';
+        if (fimLinha > linha && fimLinha[-1] == '\r') {
+            fimLinha[-1] = '\0';
+        }
+        int proximo = fimLinha + 1 - sessao->entrada;
+
+        if (strncmp(linha, "M ", 2) == 0) {
+            jogaSessao(sessao, linha + 2);
+        }
+        else if (strncmp(linha, "MAPA ", 5) == 0) {
+            int possuiMapa;
+            tMapa *mapa = carregaMapa(servidor, linha + 5, &possuiMapa);
+            if (mapa == NULL) {
+                respondeSessao(sessao, "ERRO Mapa inexistente ou invalido (%s)\n", linha + 5);
+            }
+            else {
+                iniciaSessao(sessao, mapa, possuiMapa);
+            }
+        }
+        else if (strncmp(linha, "INLINE ", 7) == 0) {
+            int n, m;
+            if (sscanf(linha + 7, "%d %d", &n, &m) != 2 || n <= 0 || n > TAM_MAPA || m <= 0 || m > TAM_MAPA) {
+                respondeSessao(sessao, "ERRO Dimensoes do mapa invalidas\n");
+                inicio = proximo;
+                continue;
+            }
+
+            // o mapa so e lido quando suas n linhas tiverem chegado
+            int fimMapa = proximo;
+            int k;
+            for (k = 0; k < n; k++) {
+                char *quebra = memchr(sessao->entrada + fimMapa, '\n', sessao->qtdEntrada - fimMapa);
+                if (quebra == NULL) {
+                    break;
+                }
+                fimMapa = quebra + 1 - sessao->entrada;
+            }
+            if (k < n) {
+                *fimLinha = '\n';
+                break;
+            }
+
+            // o leitor de arquivo de mapa e reaproveitado sobre o cabecalho e as linhas ja recebidas
+            *fimLinha = '\n';
+            FILE *arq = fmemopen(linha + 7, sessao->entrada + fimMapa - (linha + 7), "r");
+            tMapa *mapa = arq != NULL ? leMapaArquivo(arq) : NULL;
+            if (arq != NULL) {
+                fclose(arq);
+            }
+            if (mapa == NULL) {
+                respondeSessao(sessao, "ERRO Mapa invalido\n");
+            }
+            else {
+                iniciaSessao(sessao, mapa, 1);
+            }
+            proximo = fimMapa;
+        }
+        else if (strcmp(linha, "NOVO") == 0) {
+            if (sessao->mapa == NULL) {
+                respondeSessao(sessao, "ERRO Nenhum mapa carregado\n");
+            }
+            else {
+                iniciaSessao(sessao, sessao->mapa, sessao->possuiMapa);
+            }
+        }
+        else if (strcmp(linha, "FIM") == 0) {
+            sessao->encerra = 1;
+        }
+        else if (linha[0] != '\0') {
+            respondeSessao(sessao, "ERRO Comando desconhecido (%s)\n", linha);
+        }
+        inicio = proximo;
+    }
+
+    sessao->qtdEntrada -= inicio;
+    memmove(sessao->entrada, sessao->entrada + inicio, sessao->qtdEntrada);
+}
+
+void jogaSessao(tSessao *sessao, const char movimentos[]) {
+    if (sessao->mapa == NULL) {
+        respondeSessao(sessao, "ERRO Nenhum mapa carregado\n");
+        return;
+    }
+
+    int i;
+    for (i = 0; movimentos[i] != '\0'; i++) {
+        char movimento = movimentos[i];
+        if (movimento == ' ') {
+            continue;
+        }
+        if (sessao->partida.estado != JOG_EST_C) {
+            respondeSessao(sessao, "ERRO O jogo ja acabou\n");
+            return;
+        }
+        if (movimento != MOV_CBRCT && movimento != MOV_CBRHO && movimento != MOV_CBRAH) {
+            respondeSessao(sessao, "ERRO Movimento invalido (%c)\n", movimento);
+            return;
+        }
+
+        tRegistro registro = fazMovimentoRegistrado(sessao->mapa, &sessao->partida, movimento);
+        sessao->qtdMov++;
+        respondeSessao(sessao, "R %lld %lld %d %c\n", sessao->qtdMov, sessao->partida.pontuacao, sessao->partida.estado,
+                       registro.devorado == CEL_VAZIA ? '.' : registro.devorado);
+    }
+}
+
+void iniciaSessao(tSessao *sessao, const tMapa *mapa, int possuiMapa) {
+    if (sessao->possuiMapa && sessao->mapa != mapa) {
+        free((tMapa *) sessao->mapa);
+    }
+    sessao->mapa = mapa;
+    sessao->possuiMapa = possuiMapa;
+    liberaPartida(&sessao->partida);
+    sessao->partida = inicializaPartida(mapa);
+    if (sessao->partida.cobra.corpo.vet == NULL) {
+        sessao->falha = 1;
+        sessao->encerra = 1;
+        return;
+    }
+    sessao->qtdMov = 0;
+    respondeSessao(sessao, "OK %d %d %d\n", mapa->nLinhas, mapa->mColunas, mapa->qtdComida);
+}
+
+void respondeSessao(tSessao *sessao, const char *formato, ...) {
+    va_list args;
+    while (!sessao->falha) {
+        int livre = sessao->capSaida - sessao->qtdSaida;
+        va_start(args, formato);
+        int tam = vsnprintf(sessao->saida + sessao->qtdSaida, livre, formato, args);
+        va_end(args);
+        if (tam < livre) {
+            sessao->qtdSaida += tam;
+            return;
+        }
+
+        int capSaida = sessao->capSaida ? 2 * sessao->capSaida : 4096;
+        while (capSaida - sessao->qtdSaida <= tam) {
+            capSaida *= 2;
+        }
+        char *saida = realloc(sessao->saida, capSaida);
+        if (saida == NULL) {
+            // so esta sessao e perdida: ela deixa de processar comandos e e fechada em escreveSessao
+            sessao->falha = 1;
+            sessao->encerra = 1;
+            return;
+        }
+        sessao->capSaida = capSaida;
+        sessao->saida = saida;
+    }
+}
+
+int escreveSessao(tServidor *servidor, tSessao *sessao) {
+    if (sessao->falha) {
+        fechaSessao(servidor, sessao);
+        return 0;
+    }
+
+    int enviados = 0;
+    while (enviados < sessao->qtdSaida) {
+        ssize_t qtd = send(sessao->fd, sessao->saida + enviados, sessao->qtdSaida - enviados, MSG_NOSIGNAL);
+        if (qtd > 0) {
+            enviados += qtd;
+            continue;
+        }
+        if (qtd < 0 && errno == EINTR) {
+            continue;
+        }
+        if (qtd < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        }
+        fechaSessao(servidor, sessao);
+        return 0;
+    }
+    sessao->qtdSaida -= enviados;
+    memmove(sessao->saida, sessao->saida + enviados, sessao->qtdSaida);
+
+    if (sessao->qtdSaida == 0 && sessao->encerra) {
+        fechaSessao(servidor, sessao);
+        return 0;
+    }
+
+    // enquanto houver saida pendente, a sessao espera por EPOLLOUT e deixa de ler novos comandos
+    struct epoll_event evento;
+    evento.events = sessao->qtdSaida > 0 ? EPOLLOUT : EPOLLIN;
+    evento.data.ptr = sessao;
+    epoll_ctl(servidor->epoll, EPOLL_CTL_MOD, sessao->fd, &evento);
+    return 1;
+}
+
+tMapa *carregaMapa(tServidor *servidor, char caminho[], int *possuiMapa) {
+    int i;
+    for (i = 0; i < servidor->qtdCache; i++) {
+        if (strcmp(servidor->cache[i].caminho, caminho) == 0) {
+            *possuiMapa = 0;
+            return servidor->cache[i].mapa;
+        }
+    }
+
+    if (strlen(caminho) + strlen(ARQ_MAPA) >= TAM_CAMINHO) {
+        return NULL;
+    }
+    char caminhoMapa[TAM_CAMINHO];
+    combinaCaminho(caminhoMapa, caminho, ARQ_MAPA);
+    FILE *arq = fopen(caminhoMapa, "r");
+    if (arq == NULL) {
+        return NULL;
+    }
+    tMapa *mapa = leMapaArquivo(arq);
+    fclose(arq);
+    if (mapa == NULL) {
+        return NULL;
+    }
+
+    *possuiMapa = servidor->qtdCache == SRV_CACHE;
+    if (!*possuiMapa) {
+        strcpy(servidor->cache[servidor->qtdCache].caminho, caminho);
+        servidor->cache[servidor->qtdCache++].mapa = mapa;
+    }
+    return mapa;
+}
+// FIM SERVIDOR
+
+// OTIMIZADOR
+long avaliaPartidaOt(const tOtimizador *ot, const tPartida *partida) {
+    const tMapa *mapa = ot->mapa;
+    int n = adquireLinhas(mapa);
+    int m = adquireColunas(mapa);
+    tPosicao cab = adquireCabeca(&partida->cobra);
+
+    // distancia de manhattan, considerando a volta pelas bordas, ate o item restante mais proximo
+    int menor = n + m;
+    int k;
+    for (k = 0; k < mapa->qtdItens; k++) {
+        if (foiConsumido(partida, k)) {
+            continue;
+        }
+
+        int dI = abs(adquireI(mapa->itens[k]) - adquireI(cab));
+        int dJ = abs(adquireJ(mapa->itens[k]) - adquireJ(cab));
+        int dist = (dI < n - dI ? dI : n - dI) + (dJ < m - dJ ? dJ : m - dJ);
+        if (dist < menor) {
+            menor = dist;
+        }
+    }
+
+    return (long)partida->pontuacao * (n + m + 1) + (n + m - menor);
+}
+
+void *executaTrabalhadorOt(void *arg) {
+    static const char movimentos[] = { MOV_CBRCT, MOV_CBRHO, MOV_CBRAH };
+    tTrabalhadorOt *trabalhador = arg;
+    tOtimizador *ot = trabalhador->ot;
+
+    for (;;) {
+        pthread_barrier_wait(&ot->inicio);
+        if (ot->termina) {
+            break;
+        }
+
+        // cada thread expande uma fatia contigua do feixe
+        int ini = (int)((long)ot->qtdFeixe * trabalhador->id / ot->qtdThreads);
+        int fim = (int)((long)ot->qtdFeixe * (trabalhador->id + 1) / ot->qtdThreads);
+        int i;
+        for (i = ini; i < fim; i++) {
+            int mv;
+            for (mv = 0; mv < 3; mv++) {
+                tPartida *filho = &ot->filhos[3 * i + mv];
+                clonaPartida(ot->mapa, filho, &ot->feixe[i]);
+                fazMovimento(ot->mapa, filho, movimentos[mv]);
+
+                ot->valores[3 * i + mv] = filho->estado == JOG_EST_C ? avaliaPartidaOt(ot, filho) : -1;
+            }
+        }
+
+        pthread_barrier_wait(&ot->fim);
+    }
+
+    return NULL;
+}
+
+int comparaFilhoOt(const void *f1, const void *f2) {
+    const tFilhoOt *filho1 = f1;
+    const tFilhoOt *filho2 = f2;
+    if (filho1->valor != filho2->valor) {
+        return filho1->valor > filho2->valor ? -1 : 1;
+    }
+    return filho1->indice - filho2->indice;
+}
+
+void otimizaJogo(char caminhoBase[], int largura, int limiteMov, int qtdThreads) {
+    static const char movimentos[] = { MOV_CBRCT, MOV_CBRHO, MOV_CBRAH };
+    tJogo jogo = inicializaJogo(caminhoBase);
+
+    tOtimizador *ot = malloc(sizeof(tOtimizador));
+    if (ot == NULL) {
+        printf("%s\n", "ERRO: Memoria insuficiente para o otimizador");
+        exit(EXIT_FAILURE);
+    }
+    ot->mapa = jogo.mapa;
+    ot->largura = largura;
+    ot->feixe = malloc(largura * sizeof(tPartida));
+    ot->filhos = malloc(3 * largura * sizeof(tPartida));
+    ot->valores = malloc(3 * largura * sizeof(long));
+    tFilhoOt *ordem = malloc(3 * largura * sizeof(tFilhoOt));
+    // os corpos dos estados do feixe e dos filhos ficam num unico bloco, apos o qual cada estado recebe so copias
+    int capCorpo = adquireLinhas(jogo.mapa) * adquireColunas(jogo.mapa);
+    tPosicao *corpos = malloc(4 * largura * capCorpo * sizeof(tPosicao));
+    int i;
+
+    // tabela de transposicao da camada: os hashes dos estados ja aceitos no proximo feixe
+    int capVistos = 1;
+    while (capVistos < 2 * largura) {
+        capVistos *= 2;
+    }
+    unsigned long long *vistos = malloc(capVistos * sizeof(unsigned long long));
+    long qtdRepetidos = 0;
+
+    // a historia guarda, por camada, de onde veio cada estado do feixe
+    long capHistoria = (long)largura * 64;
+    tPassoOt *historia = malloc(capHistoria * sizeof(tPassoOt));
+    long *inicioCamada = malloc((limiteMov + 2) * sizeof(long));
+    char *melhores = malloc(limiteMov + 1);
+
+    if (ot->feixe == NULL || ot->filhos == NULL || ot->valores == NULL || ordem == NULL || corpos == NULL
+        || vistos == NULL || historia == NULL || inicioCamada == NULL || melhores == NULL) {
+        printf("%s\n", "ERRO: Memoria insuficiente para o otimizador");
+        exit(EXIT_FAILURE);
+    }
+    for (i = 0; i < largura; i++) {
+        ot->feixe[i].cobra.corpo = inicializaFila(corpos + (long)i * capCorpo, capCorpo);
+    }
+    for (i = 0; i < 3 * largura; i++) {
+        ot->filhos[i].cobra.corpo = inicializaFila(corpos + (long)(largura + i) * capCorpo, capCorpo);
+    }
+
+    // a raiz e o estado inicial do jogo
+    clonaPartida(ot->mapa, &ot->feixe[0], &jogo.partida);
+    ot->qtdFeixe = 1;
+    inicioCamada[0] = 0;
+    inicioCamada[1] = 0;
+
+    // a melhor sequencia e identificada pela camada, pelo pai e pelo ultimo movimento
+    long long melhorPontuacao = 0;
+    int melhorCamada = 0;
+    int melhorPai = 0;
+    char melhorMov = '\0';
+    int melhorEstado = JOG_EST_C;
+
+    if (qtdThreads <= 0) {
+        qtdThreads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    }
+    if (qtdThreads <= 0) {
+        qtdThreads = 1;
+    }
+    ot->qtdThreads = qtdThreads;
+    ot->termina = 0;
+    pthread_barrier_init(&ot->inicio, NULL, qtdThreads + 1);
+    pthread_barrier_init(&ot->fim, NULL, qtdThreads + 1);
+
+    tTrabalhadorOt *trabalhadores = malloc(qtdThreads * sizeof(tTrabalhadorOt));
+    pthread_t *threads = malloc(qtdThreads * sizeof(pthread_t));
+    if (trabalhadores == NULL || threads == NULL) {
+        printf("%s\n", "ERRO: Memoria insuficiente para o otimizador");
+        exit(EXIT_FAILURE);
+    }
+    int t;
+    for (t = 0; t < qtdThreads; t++) {
+        trabalhadores[t].ot = ot;
+        trabalhadores[t].id = t;
+        if (pthread_create(&threads[t], NULL, executaTrabalhadorOt, &trabalhadores[t]) != 0) {
+            printf("%s\n", "ERRO: Nao foi possivel criar as threads do otimizador");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    int camada;
+    for (camada = 0; camada < limiteMov && ot->qtdFeixe > 0; camada++) {
+        pthread_barrier_wait(&ot->inicio);
+        pthread_barrier_wait(&ot->fim);
+
+        // filhos terminais disputam a melhor sequencia; os vivos, o proximo feixe
+        int qtdVivos = 0;
+        for (i = 0; i < 3 * ot->qtdFeixe; i++) {
+            const tPartida *filho = &ot->filhos[i];
+            if (ot->valores[i] >= 0) {
+                ordem[qtdVivos].valor = ot->valores[i];
+                ordem[qtdVivos].indice = i;
+                qtdVivos++;
+            }
+            else if (filho->pontuacao > melhorPontuacao) {
+                melhorPontuacao = filho->pontuacao;
+                melhorCamada = camada;
+                melhorPai = i / 3;
+                melhorMov = movimentos[i % 3];
+                melhorEstado = filho->estado;
+            }
+        }
+
+        qsort(ordem, qtdVivos, sizeof(tFilhoOt), comparaFilhoOt);
+
+        // estados repetidos so ocupariam o feixe com a mesma continuacao; fica o de melhor avaliacao
+        memset(vistos, 0, capVistos * sizeof(unsigned long long));
+        int qtdProx = 0;
+        for (i = 0; i < qtdVivos && qtdProx < largura; i++) {
+            unsigned long long hash = adquireHash(&ot->filhos[ordem[i].indice]);
+            int pos = (int)(hash & (capVistos - 1));
+            while (vistos[pos] != 0 && vistos[pos] != hash) {
+                pos = (pos + 1) & (capVistos - 1);
+            }
+            if (vistos[pos] == hash && hash != 0) {
+                qtdRepetidos++;
+                continue;
+            }
+            vistos[pos] = hash;
+            ordem[qtdProx++] = ordem[i];
+        }
+
+        if (inicioCamada[camada + 1] + qtdProx > capHistoria) {
+            capHistoria = 2 * capHistoria + qtdProx;
+            historia = realloc(historia, capHistoria * sizeof(tPassoOt));
+            if (historia == NULL) {
+                printf("%s\n", "ERRO: Memoria insuficiente para o otimizador");
+                exit(EXIT_FAILURE);
+            }
+        }
+
+        for (i = 0; i < qtdProx; i++) {
+            int filho = ordem[i].indice;
+            clonaPartida(ot->mapa, &ot->feixe[i], &ot->filhos[filho]);
+            historia[inicioCamada[camada + 1] + i].pai = filho / 3;
+            historia[inicioCamada[camada + 1] + i].movimento = movimentos[filho % 3];
+        }
+        ot->qtdFeixe = qtdProx;
+        inicioCamada[camada + 2] = inicioCamada[camada + 1] + qtdProx;
+    }
+
+    ot->termina = 1;
+    pthread_barrier_wait(&ot->inicio);
+    for (t = 0; t < qtdThreads; t++) {
+        pthread_join(threads[t], NULL);
+    }
+
+    // o feixe que sobreviveu ao limite tambem disputa a melhor sequencia
+    for (i = 0; i < ot->qtdFeixe; i++) {
+        if (ot->feixe[i].pontuacao > melhorPontuacao) {
+            tPassoOt passo = historia[inicioCamada[camada] + i];
+            melhorPontuacao = ot->feixe[i].pontuacao;
+            melhorCamada = camada - 1;
+            melhorPai = passo.pai;
+            melhorMov = passo.movimento;
+            melhorEstado = JOG_EST_C;
+        }
+    }
+
+    // reconstroi a melhor sequencia pela historia
+    int qtdMelhores = melhorMov == '\0' ? 0 : melhorCamada + 1;
+    if (qtdMelhores > 0) {
+        melhores[melhorCamada] = melhorMov;
+        int idx = melhorPai;
+        int k;
+        for (k = melhorCamada; k > 0; k--) {
+            tPassoOt passo = historia[inicioCamada[k] + idx];
+            melhores[k - 1] = passo.movimento;
+            idx = passo.pai;
+        }
+    }
+
+    char caminhoOtim[TAM_CAMINHO];
+    combinaCaminho(caminhoOtim, jogo.caminhoSaida, ARQ_OTIM);
+    FILE *arq = fopen(caminhoOtim, "w");
+    fprintf(arq, "Melhor pontuacao: %lld\n", melhorPontuacao);
+    fprintf(arq, "Numero de movimentos: %d\n", qtdMelhores);
+    fprintf(arq, "Estado final: %s\n", melhorEstado == JOG_EST_V ? "vitoria" : melhorEstado == JOG_EST_D ? "derrota" : "limite de movimentos");
+    fprintf(arq, "Largura do feixe: %d\n", largura);
+    fprintf(arq, "Estados repetidos descartados: %ld\n", qtdRepetidos);
+    fclose(arq);
+
+    char caminhoMvot[TAM_CAMINHO];
+    combinaCaminho(caminhoMvot, jogo.caminhoSaida, ARQ_MVOT);
+    arq = fopen(caminhoMvot, "w");
+    for (i = 0; i < qtdMelhores; i++) {
+        fprintf(arq, "%c\n", melhores[i]);
+    }
+    fclose(arq);
+
+    pthread_barrier_destroy(&ot->inicio);
+    pthread_barrier_destroy(&ot->fim);
+    free(trabalhadores);
+    free(threads);
+    free(historia);
+    free(inicioCamada);
+    free(melhores);
+    free(ordem);
+    free(vistos);
+    free(corpos);
+    free(ot->feixe);
+    free(ot->filhos);
+    free(ot->valores);
+    free(ot);
+    liberaJogo(jogo);
+}
+// FIM OTIMIZADOR
+
+// AUTOPILOTO
+tBusca *inicializaBusca(int nLinhas, int mColunas) {
+    int nCelulas = nLinhas * mColunas;
+    int nEstados = nCelulas * 4;
+
+    tBusca *busca = malloc(sizeof(tBusca));
+    if (busca == NULL) {
+        printf("%s\n", "ERRO: Memoria insuficiente para o autopiloto");
+        exit(EXIT_FAILURE);
+    }
+
+    busca->nLinhas = nLinhas;
+    busca->mColunas = mColunas;
+    busca->nPalavras = (nEstados + 63) / 64;
+    busca->visitados = malloc(busca->nPalavras * sizeof(unsigned long long));
+    busca->fronteira = malloc(busca->nPalavras * sizeof(unsigned long long));
+    busca->proxima = malloc(busca->nPalavras * sizeof(unsigned long long));
+    busca->pai = malloc(nEstados * sizeof(int));
+    busca->movimentoPai = malloc(nEstados * sizeof(char));
+    busca->restante = calloc(nCelulas, sizeof(int));
+    busca->caminho = malloc(nEstados * sizeof(char));
+    busca->tamCaminho = 0;
+
+    if (busca->visitados == NULL || busca->fronteira == NULL || busca->proxima == NULL || busca->pai == NULL
+        || busca->movimentoPai == NULL || busca->restante == NULL || busca->caminho == NULL) {
+        printf("%s\n", "ERRO: Memoria insuficiente para o autopiloto");
+        exit(EXIT_FAILURE);
+    }
+
+    return busca;
+}
+
+int buscaComida(tBusca *busca, const tMapa *mapa, const tPartida *partida) {
+    static const char movimentos[] = { MOV_CBRCT, MOV_CBRHO, MOV_CBRAH };
+    int m = busca->mColunas;
+
+    memset(busca->visitados, 0, busca->nPalavras * sizeof(unsigned long long));
+    memset(busca->fronteira, 0, busca->nPalavras * sizeof(unsigned long long));
+
+    // a k-esima parte do corpo desocupa sua celula apos (tamanho - k) movimentos
+    const tFila *corpo = &partida->cobra.corpo;
+    int tam = adquireTam(corpo);
+    int k;
+    for (k = 0; k < tam; k++) {
+        tPosicao parte = consultaElem(corpo, k);
+        busca->restante[adquireCelula(mapa, parte)] = tam - k;
+    }
+
+    tPosicao cab = adquireCabeca(&partida->cobra);
+    int origem = (adquireCelula(mapa, cab)) * 4 + adquireDirecao(&partida->cobra);
+    busca->visitados[origem / 64] |= 1ULL << (origem % 64);
+    busca->fronteira[origem / 64] |= 1ULL << (origem % 64);
+
+    int alvo = -1;
+    int t;
+    int haFronteira = 1;
+    for (t = 0; alvo < 0 && haFronteira; t++) {
+        memset(busca->proxima, 0, busca->nPalavras * sizeof(unsigned long long));
+        haFronteira = 0;
+
+        int w;
+        for (w = 0; w < busca->nPalavras && alvo < 0; w++) {
+            unsigned long long bits = busca->fronteira[w];
+            while (bits != 0 && alvo < 0) {
+                int estado = w * 64 + __builtin_ctzll(bits);
+                bits &= bits - 1;
+
+                int cel = estado / 4;
+                tPosicao pos = inicializaPosicao(cel / m, cel % m);
+
+                int mv;
+                for (mv = 0; mv < 3; mv++) {
+                    int direcao = giraDirecao(estado % 4, movimentos[mv]);
+                    tPosicao dest = transformaPosicaoValida(mapa, avancaNaDirecao(pos, direcao), direcao);
+                    int celDest = adquireCelula(mapa, dest);
+                    char ch = adquireCelPartida(mapa, partida, dest);
+
+                    if (ch == CEL_PARED || busca->restante[celDest] > t + 1) {
+                        continue;
+                    }
+
+                    int prox = celDest * 4 + direcao;
+                    if (busca->visitados[prox / 64] & (1ULL << (prox % 64))) {
+                        continue;
+                    }
+                    busca->visitados[prox / 64] |= 1ULL << (prox % 64);
+                    busca->proxima[prox / 64] |= 1ULL << (prox % 64);
+                    busca->pai[prox] = estado;
+                    busca->movimentoPai[prox] = movimentos[mv];
+                    haFronteira = 1;
+
+                    if (ch == CEL_COMID || ch == CEL_DINHR) {
+                        alvo = prox;
+                        break;
+                    }
+                }
+            }
+        }
+
+        unsigned long long *aux = busca->fronteira;
+        busca->fronteira = busca->proxima;
+        busca->proxima = aux;
+    }
+
+    for (k = 0; k < tam; k++) {
+        tPosicao parte = consultaElem(corpo, k);
+        busca->restante[adquireCelula(mapa, parte)] = 0;
+    }
+
+    // reconstroi o caminho de tras para frente
+    busca->tamCaminho = alvo < 0 ? 0 : t;
+    int estado = alvo;
+    for (k = busca->tamCaminho - 1; k >= 0; k--) {
+        busca->caminho[k] = busca->movimentoPai[estado];
+        estado = busca->pai[estado];
+    }
+
+    return busca->tamCaminho;
+}
+
+void liberaBusca(tBusca *busca) {
+    free(busca->visitados);
+    free(busca->fronteira);
+    free(busca->proxima);
+    free(busca->pai);
+    free(busca->movimentoPai);
+    free(busca->restante);
+    free(busca->caminho);
+    free(busca);
+}
+
+void jogaAutopiloto(char caminhoBase[], int limiteMov) {
+    static const char movimentos[] = { MOV_CBRCT, MOV_CBRHO, MOV_CBRAH };
+
+    tJogo jogo = inicializaJogo(caminhoBase);
+    tBusca *busca = inicializaBusca(adquireLinhas(jogo.mapa), adquireColunas(jogo.mapa));
+
+    char caminhoMovs[TAM_CAMINHO];
+    combinaCaminho(caminhoMovs, jogo.caminhoSaida, ARQ_MOVS);
+    FILE *arq = fopen(caminhoMovs, "w");
+
+    int passo = 0;
+    int mov;
+    for (mov = 0; mov < limiteMov && !acabou(jogo); mov++) {
+        // refaz a busca quando o caminho acaba ou deixa de ser seguro
+        if (passo >= busca->tamCaminho || !ehMovimentoSeguro(jogo.mapa, &jogo.partida, busca->caminho[passo])) {
+            buscaComida(busca, jogo.mapa, &jogo.partida);
+            passo = 0;
+        }
+
+        char movimento;
+        if (passo < busca->tamCaminho) {
+            movimento = busca->caminho[passo++];
+        }
+        else {
+            // sem comida alcancavel, sobrevive enquanto possivel
+            movimento = MOV_CBRCT;
+            int i;
+            for (i = 0; i < 3; i++) {
+                if (ehMovimentoSeguro(jogo.mapa, &jogo.partida, movimentos[i])) {
+                    movimento = movimentos[i];
+                    break;
+                }
+            }
+        }
+
+        avancaJogo(&jogo, movimento);
+        fprintf(arq, "%c\n", movimento);
+    }
+
+    fclose(arq);
+    liberaBusca(busca);
+    liberaJogo(jogo);
+}
+// FIM AUTOPILOTO
+
+// MONTECARLO
+void simulaMonteCarlo(char caminhoBase[], long long qtdJogos, int qtdThreads, int limiteMov, int politica, unsigned long long semente) {
+    tJogo modelo = inicializaJogo(caminhoBase);
+
+    if (qtdThreads <= 0) {
+        qtdThreads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    }
+    if (qtdThreads <= 0) {
+        qtdThreads = 1;
+    }
+    if (qtdThreads > qtdJogos) {
+        qtdThreads = (int)qtdJogos;
+    }
+
+    tTrabalhadorMC *trabalhadores = malloc(qtdThreads * sizeof(tTrabalhadorMC));
+    pthread_t *threads = malloc(qtdThreads * sizeof(pthread_t));
+    if (trabalhadores == NULL || threads == NULL) {
+        printf("%s\n", "ERRO: Memoria insuficiente para a simulacao de Monte Carlo");
+        exit(EXIT_FAILURE);
+    }
+
+    // distribui os jogos igualmente entre as threads
+    long long primeiroJogo = 0;
+    int t;
+    for (t = 0; t < qtdThreads; t++) {
+        trabalhadores[t].modelo = &modelo;
+        trabalhadores[t].qtdJogos = qtdJogos / qtdThreads + (t < qtdJogos % qtdThreads);
+        trabalhadores[t].politica = politica;
+        trabalhadores[t].semente = semente;
+        trabalhadores[t].primeiroJogo = primeiroJogo;
+        primeiroJogo += trabalhadores[t].qtdJogos;
+        trabalhadores[t].resultado = inicializaResultadoMC(&modelo, limiteMov);
+
+        if (pthread_create(&threads[t], NULL, executaTrabalhadorMC, &trabalhadores[t]) != 0) {
+            printf("%s\n", "ERRO: Nao foi possivel criar as threads da simulacao de Monte Carlo");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    tResultadoMC total = inicializaResultadoMC(&modelo, limiteMov);
+    for (t = 0; t < qtdThreads; t++) {
+        pthread_join(threads[t], NULL);
+        mesclaResultadoMC(&total, &trabalhadores[t].resultado);
+        liberaResultadoMC(&trabalhadores[t].resultado);
+    }
+
+    exportaMonteCarlo(&total, modelo.caminhoSaida);
+
+    liberaResultadoMC(&total);
+    free(trabalhadores);
+    free(threads);
+    liberaJogo(modelo);
+}
+
+void *executaTrabalhadorMC(void *arg) {
+    tTrabalhadorMC *trabalhador = arg;
+    const tJogo *modelo = trabalhador->modelo;
+    tPosicao cab = adquireCabeca(adquireCobraInicial(modelo->mapa));
+    int celCab = adquireCelula(modelo->mapa, cab);
+
+    tLote *lote = malloc(sizeof(tLote));
+    tPosicao *corpos = malloc(LOT_TAM * adquireLinhas(modelo->mapa) * adquireColunas(modelo->mapa) * sizeof(tPosicao));
+    if (lote == NULL || corpos == NULL) {
+        printf("%s\n", "ERRO: Memoria insuficiente para a simulacao de Monte Carlo");
+        exit(EXIT_FAILURE);
+    }
+    tSujas *sujas[LOT_TAM];
+    tAleatorio geradores[LOT_TAM];
+    char movimentos[LOT_TAM] = { 0 };
+    int k;
+    for (k = 0; k < LOT_TAM; k++) {
+        sujas[k] = inicializaSujas(adquireLinhas(modelo->mapa) * adquireColunas(modelo->mapa));
+        if (sujas[k] == NULL) {
+            printf("%s\n", "ERRO: Memoria insuficiente para a simulacao de Monte Carlo");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    // o mapa e compartilhado; os jogos avancam juntos, e a posicao de um jogo que acaba recebe o proximo
+    int qtd = trabalhador->qtdJogos < LOT_TAM ? (int)trabalhador->qtdJogos : LOT_TAM;
+    int emJogo[LOT_TAM];
+    long long proximo = 0;
+    inicializaLote(lote, modelo, qtd, sujas, corpos);
+    for (k = 0; k < qtd; k++) {
+        geradores[k] = inicializaAleatorio(trabalhador->semente + (unsigned long long)(trabalhador->primeiroJogo + proximo++));
+        marcaSuja(sujas[k], celCab);
+        emJogo[k] = 1;
+    }
+
+    while (contaAtivos(lote) > 0) {
+        for (k = 0; k < qtd; k++) {
+            if (lote->ativo[k]) {
+                movimentos[k] = escolheMovimentoMC(lote->mapa, &lote->jogos[k].partida, trabalhador->politica, &geradores[k]);
+            }
+        }
+        avancaLote(lote, movimentos);
+
+        for (k = 0; k < qtd; k++) {
+            if (!emJogo[k] || (lote->ativo[k] && adquireQtdMovimentos(lote->jogos[k].estatisticas) < trabalhador->resultado.limiteMov)) {
+                continue;
+            }
+
+            registraJogoMC(&trabalhador->resultado, &lote->jogos[k]);
+            lote->ativo[k] = 0;
+            emJogo[k] = 0;
+            if (proximo < trabalhador->qtdJogos) {
+                reiniciaNoLote(lote, k, modelo);
+                geradores[k] = inicializaAleatorio(trabalhador->semente + (unsigned long long)(trabalhador->primeiroJogo + proximo++));
+                marcaSuja(sujas[k], celCab);
+                emJogo[k] = 1;
+            }
+        }
+    }
+
+    for (k = 0; k < LOT_TAM; k++) {
+        liberaSujas(sujas[k]);
+    }
+    free(corpos);
+    free(lote);
+    return NULL;
+}
+
+char escolheMovimentoMC(const tMapa *mapa, const tPartida *partida, int politica, tAleatorio *gerador) {
+    static const char movimentos[] = { MOV_CBRCT, MOV_CBRHO, MOV_CBRAH };
+
+    if (politica == MC_POL_C) {
+        char seguros[3];
+        int qtdSeguros = 0;
+        int i;
+        for (i = 0; i < 3; i++) {
+            if (ehMovimentoSeguro(mapa, partida, movimentos[i])) {
+                seguros[qtdSeguros++] = movimentos[i];
+            }
+        }
+
+        if (qtdSeguros > 0) {
+            return seguros[sorteia(gerador, qtdSeguros)];
+        }
+    }
+
+    return movimentos[sorteia(gerador, 3)];
+}
+
+tResultadoMC inicializaResultadoMC(const tJogo *modelo, int limiteMov) {
+    tResultadoMC resultado = { 0 };
+    resultado.limiteMov = limiteMov;
+    resultado.nLinhas = adquireLinhas(modelo->mapa);
+    resultado.mColunas = adquireColunas(modelo->mapa);
+    resultado.qtdComida = adquireQtdComidaInicial(modelo->mapa);
+    resultado.qtdComidaInalcancavel = modelo->mapa->qtdComidaInalcancavel;
+
+    // a maior pontuacao possivel e a soma de todas as comidas e dinheiros do mapa
+    int k;
+    for (k = 0; k < modelo->mapa->qtdItens; k++) {
+        char cel = adquireCel(modelo->mapa, modelo->mapa->itens[k]);
+        resultado.maxPontuacao += cel == CEL_COMID ? JOG_PNT_C : JOG_PNT_D;
+    }
+
+    resultado.histPontuacao = calloc(resultado.maxPontuacao + 1, sizeof(long long));
+    resultado.histMovimentos = calloc(limiteMov + 1, sizeof(long long));
+    resultado.heatmap = calloc(resultado.nLinhas * resultado.mColunas, sizeof(long long));
+    if (resultado.histPontuacao == NULL || resultado.histMovimentos == NULL || resultado.heatmap == NULL) {
+        printf("%s\n", "ERRO: Memoria insuficiente para a simulacao de Monte Carlo");
+        exit(EXIT_FAILURE);
+    }
+
+    return resultado;
+}
+
+void registraJogoMC(tResultadoMC *resultado, const tJogo *jogo) {
+    const tCobra *cbr = adquireCobra(&jogo->partida);
+
+    int fim = MC_FIM_L;
+    if (jogo->partida.estado == JOG_EST_V) {
+        fim = MC_FIM_V;
+    }
+    else if (jogo->partida.estado == JOG_EST_D) {
+        fim = adquireDevorado(cbr) == CEL_PARED ? MC_FIM_P : MC_FIM_C;
+    }
+    else if (restaSoInalcancavel(jogo->mapa, &jogo->partida)) {
+        fim = MC_FIM_I;
+    }
+
+    resultado->qtdJogos++;
+    resultado->qtdFins[fim]++;
+    resultado->histPontuacao[jogo->partida.pontuacao]++;
+    resultado->histMovimentos[adquireQtdMovimentos(jogo->estatisticas)]++;
+    acumulaSujas(jogo->sujas, resultado->heatmap);
+}
+
+void mesclaResultadoMC(tResultadoMC *destino, const tResultadoMC *origem) {
+    destino->qtdJogos += origem->qtdJogos;
+
+    int i;
+    for (i = 0; i < MC_QTD_FINS; i++) {
+        destino->qtdFins[i] += origem->qtdFins[i];
+    }
+    for (i = 0; i <= destino->maxPontuacao; i++) {
+        destino->histPontuacao[i] += origem->histPontuacao[i];
+    }
+    for (i = 0; i <= destino->limiteMov; i++) {
+        destino->histMovimentos[i] += origem->histMovimentos[i];
+    }
+    for (i = 0; i < destino->nLinhas * destino->mColunas; i++) {
+        destino->heatmap[i] += origem->heatmap[i];
+    }
+}
+
+void liberaResultadoMC(tResultadoMC *resultado) {
+    free(resultado->histPontuacao);
+    free(resultado->histMovimentos);
+    free(resultado->heatmap);
+}
+
+int adquirePercentil(const long long hist[], int tam, long long total, double fracao) {
+    long long acumulado = 0;
+    int i;
+    for (i = 0; i < tam; i++) {
+        acumulado += hist[i];
+        if (acumulado > 0 && acumulado >= fracao * total) {
+            return i;
+        }
+    }
+    return tam - 1;
+}
+
+void exportaMonteCarlo(const tResultadoMC *resultado, char caminhoSaida[]) {
+    char caminhoMntc[TAM_CAMINHO];
+    combinaCaminho(caminhoMntc, caminhoSaida, ARQ_MNTC);
+    FILE *arq = fopen(caminhoMntc, "w");
+
+    long long total = resultado->qtdJogos;
+    // as causas anteriores a MC_FIM_I sao sempre impressas; ela, so quando o mapa tem comida inalcancavel
+    const char *fins[MC_FIM_I] = { "Vitorias", "Mortes por colisao com parede", "Mortes por colisao com o corpo", "Jogos interrompidos pelo limite de movimentos" };
+
+    fprintf(arq, "Numero de jogos: %lld\n", total);
+    int i;
+    for (i = 0; i < MC_FIM_I; i++) {
+        fprintf(arq, "%s: %lld (%.2f%%)\n", fins[i], resultado->qtdFins[i], 100.0 * resultado->qtdFins[i] / total);
+    }
+    // so os mapas com comida inalcancavel tem jogos que nao podem ser vencidos
+    if (resultado->qtdComidaInalcancavel > 0) {
+        fprintf(arq, "Comida inalcancavel no mapa: %d de %d\n", resultado->qtdComidaInalcancavel, resultado->qtdComida);
+        fprintf(arq, "Jogos encerrados por so restar comida inalcancavel: %lld (%.2f%%)\n", resultado->qtdFins[MC_FIM_I],
+            100.0 * resultado->qtdFins[MC_FIM_I] / total);
+    }
+
+    // resumo das distribuicoes
+    const long long *hists[2] = { resultado->histPontuacao, resultado->histMovimentos };
+    int tams[2] = { resultado->maxPontuacao + 1, resultado->limiteMov + 1 };
+    const char *nomes[2] = { "Pontuacao final", "Movimentos sobrevividos" };
+    int h;
+    for (h = 0; h < 2; h++) {
+        double soma = 0;
+        for (i = 0; i < tams[h]; i++) {
+            soma += (double)i * hists[h][i];
+        }
+        fprintf(arq, "%s - media: %.2f, minimo: %d, p10: %d, p50: %d, p90: %d, maximo: %d\n", nomes[h], soma / total,
+            adquirePercentil(hists[h], tams[h], total, 0.0), adquirePercentil(hists[h], tams[h], total, 0.1),
+            adquirePercentil(hists[h], tams[h], total, 0.5), adquirePercentil(hists[h], tams[h], total, 0.9),
+            adquirePercentil(hists[h], tams[h], total, 1.0));
+    }
+
+    fprintf(arq, "%s\n", "Distribuicao da pontuacao final:");
+    for (i = 0; i <= resultado->maxPontuacao; i++) {
+        if (resultado->histPontuacao[i] > 0) {
+            fprintf(arq, "%d - %lld\n", i, resultado->histPontuacao[i]);
+        }
+    }
+
+    fprintf(arq, "%s\n", "Distribuicao dos movimentos sobrevividos:");
+    // faixas semiabertas de mesma largura, a ultima contendo o limite
+    int largura = (resultado->limiteMov + MC_FAIXAS) / MC_FAIXAS;
+    for (i = 0; i <= resultado->limiteMov; i += largura) {
+        long long qtd = 0;
+        int k;
+        for (k = i; k < i + largura && k <= resultado->limiteMov; k++) {
+            qtd += resultado->histMovimentos[k];
+        }
+        fprintf(arq, "[%d, %d) - %lld\n", i, i + largura, qtd);
+    }
+
+    fclose(arq);
+
+    // exporta o heatmap agregado no mesmo formato de ARQ_HMAP
+    char caminhoHeatmap[TAM_CAMINHO];
+    combinaCaminho(caminhoHeatmap, caminhoSaida, ARQ_HMMC);
+    arq = fopen(caminhoHeatmap, "w");
+
+    for (i = 0; i < resultado->nLinhas; i++) {
+        int j;
+        for (j = 0; j < resultado->mColunas; j++) {
+            fprintf(arq, "%lld", resultado->heatmap[i * resultado->mColunas + j]);
+            if (j < resultado->mColunas - 1)
+                fprintf(arq, "%c", ' ');
+        }
+        fprintf(arq, "%c", '\n');
+    }
+
+    fclose(arq);
+}
+// FIM MONTECARLO
+
+// AOVIVO
+tAoVivo *inicializaAoVivo(const tJogo *jogo, int fps) {
+    int n = adquireLinhas(jogo->mapa);
+    int m = adquireColunas(jogo->mapa);
+
+    tAoVivo *aoVivo = malloc(sizeof(tAoVivo));
+    if (aoVivo != NULL) {
+        aoVivo->tela = inicializaTela(jogo->mapa, 0);
+        aoVivo->sujas = malloc(n * m * sizeof(tPosicao));
+        aoVivo->marcadas = calloc(TAM_MAPA, sizeof(*aoVivo->marcadas));
+        // cada celula ocupa no maximo "\033[LLL;CCCH" e o glifo; o tabuleiro inicial, uma quebra de linha a mais
+        aoVivo->buffer = malloc(n * m * 16 + 256);
+    }
+    if (aoVivo == NULL || aoVivo->sujas == NULL || aoVivo->marcadas == NULL || aoVivo->buffer == NULL) {
+        printf("ERRO: Memoria insuficiente para o modo ao vivo\n");
+        exit(EXIT_FAILURE);
+    }
+
+    aoVivo->fps = fps;
+    aoVivo->qtdSujas = 0;
+    aoVivo->inicio = adquireSegundos();
+    aoVivo->proximoQuadro = aoVivo->inicio + 1.0 / fps;
+    aoVivo->tamQuadro = 0;
+
+    // limpa a tela e esconde o cursor uma unica vez, desenhando o tabuleiro completo
+    desenhaTabuleiro(jogo->mapa, &jogo->partida, aoVivo->tela->quadro);
+    printf("\033[2J\033[H\033[?25l");
+    int i;
+    for (i = 0; i < n; i++) {
+        fwrite(aoVivo->tela->quadro[i], 1, m, stdout);
+        printf("%c", '\n');
+    }
+
+    // sem a thread escritora, o proprio jogo escreve cada quadro
+    sem_init(&aoVivo->livre, 0, 1);
+    sem_init(&aoVivo->pronto, 0, 0);
+    aoVivo->emThread = pthread_create(&aoVivo->thread, NULL, executaAoVivo, aoVivo) == 0;
+    if (!aoVivo->emThread) {
+        sem_destroy(&aoVivo->livre);
+        sem_destroy(&aoVivo->pronto);
+    }
+    desenhaAoVivo(aoVivo, jogo);
+
+    return aoVivo;
+}
+
+void registraAoVivo(tAoVivo *aoVivo, const tJogo *jogo) {
+    tPosicao alteradas[aoVivo->tela->nLinhas * aoVivo->tela->mColunas + 4];
+    int qtdAlteradas = atualizaTela(aoVivo->tela, jogo, alteradas);
+
+    int k;
+    for (k = 0; k < qtdAlteradas; k++) {
+        tPosicao pos = alteradas[k];
+        if (!aoVivo->marcadas[adquireI(pos)][adquireJ(pos)]) {
+            aoVivo->marcadas[adquireI(pos)][adquireJ(pos)] = 1;
+            aoVivo->sujas[aoVivo->qtdSujas++] = pos;
+        }
+    }
+
+    // o jogo nao espera pelo terminal: os movimentos se acumulam ate o proximo quadro aceito pela thread escritora
+    double agora = adquireSegundos();
+    if (agora >= aoVivo->proximoQuadro && desenhaAoVivo(aoVivo, jogo)) {
+        aoVivo->proximoQuadro = agora + 1.0 / aoVivo->fps;
+    }
+}
+
+int desenhaAoVivo(tAoVivo *aoVivo, const tJogo *jogo) {
+    if (!aoVivo->emThread) {
+        fwrite(aoVivo->buffer, 1, montaAoVivo(aoVivo, jogo), stdout);
+        fflush(stdout);
+        return 1;
+    }
+
+    if (sem_trywait(&aoVivo->livre) != 0) {
+        return 0;
+    }
+    aoVivo->tamQuadro = montaAoVivo(aoVivo, jogo);
+    sem_post(&aoVivo->pronto);
+
+    return 1;
+}
+
+int montaAoVivo(tAoVivo *aoVivo, const tJogo *jogo) {
+    char *curr = aoVivo->buffer;
+
+    int k;
+    for (k = 0; k < aoVivo->qtdSujas; k++) {
+        tPosicao pos = aoVivo->sujas[k];
+        curr += sprintf(curr, "\033[%d;%dH%c", adquireI(pos) + 1, adquireJ(pos) + 1, aoVivo->tela->quadro[adquireI(pos)][adquireJ(pos)]);
+        aoVivo->marcadas[adquireI(pos)][adquireJ(pos)] = 0;
+    }
+    aoVivo->qtdSujas = 0;
+
+    long long qtdMov = adquireQtdMovimentos(jogo->estatisticas);
+    double decorrido = adquireSegundos() - aoVivo->inicio;
+    curr += sprintf(curr, "\033[%d;1H\033[KPontuacao: %lld | Tamanho: %d | Movimentos: %lld | Mov/s: %.0f",
+        aoVivo->tela->nLinhas + 2, jogo->partida.pontuacao, adquireTamanho(&jogo->partida.cobra),
+        qtdMov, decorrido > 0 ? qtdMov / decorrido : 0.0);
+
+    return curr - aoVivo->buffer;
+}
+
+void *executaAoVivo(void *arg) {
+    tAoVivo *aoVivo = arg;
+
+    while (1) {
+        sem_wait(&aoVivo->pronto);
+        if (aoVivo->tamQuadro < 0) {
+            break;
+        }
+        fwrite(aoVivo->buffer, 1, aoVivo->tamQuadro, stdout);
+        fflush(stdout);
+        sem_post(&aoVivo->livre);
+    }
+
+    return NULL;
+}
+
+void encerraAoVivo(tAoVivo *aoVivo, const tJogo *jogo) {
+    // espera o quadro em escrita e encerra a thread; o ultimo quadro nunca e descartado
+    if (aoVivo->emThread) {
+        sem_wait(&aoVivo->livre);
+        aoVivo->tamQuadro = -1;
+        sem_post(&aoVivo->pronto);
+        pthread_join(aoVivo->thread, NULL);
+        sem_destroy(&aoVivo->livre);
+        sem_destroy(&aoVivo->pronto);
+        aoVivo->emThread = 0;
+    }
+    desenhaAoVivo(aoVivo, jogo);
+
+    // devolve o cursor abaixo da linha de status
+    printf("\033[%d;1H\033[?25h", aoVivo->tela->nLinhas + 3);
+    imprimePlacar(jogo->partida.pontuacao, jogo->partida.estado);
+
+    free(aoVivo->tela);
+    free(aoVivo->sujas);
+    free(aoVivo->marcadas);
+    free(aoVivo->buffer);
+    free(aoVivo);
+}
+
+double adquireSegundos() {
+    struct timespec agora;
+    clock_gettime(CLOCK_MONOTONIC, &agora);
+
+    return agora.tv_sec + agora.tv_nsec / 1e9;
+}
+// FIM AOVIVO
+
+// TELA
+tTela *inicializaTela(const tMapa *mapa, int intervaloChave) {
+    tTela *tela = malloc(sizeof(tTela));
+    if (tela == NULL) {
+        printf("ERRO: Memoria insuficiente para a tela\n");
+        exit(EXIT_FAILURE);
+    }
+
+    tela->nLinhas = adquireLinhas(mapa);
+    tela->mColunas = adquireColunas(mapa);
+    tela->intervaloChave = intervaloChave;
+
+    return tela;
+}
+
+void imprimeQuadro(tTela *tela, const tJogo *jogo, char comando) {
+    long long qtdMov = adquireQtdMovimentos(jogo->estatisticas);
+    if (qtdMov == 0 || (tela->intervaloChave > 0 && qtdMov % tela->intervaloChave == 0)) {
+        imprimeQuadroChave(tela, jogo, comando);
+    }
+    else {
+        imprimeQuadroDelta(tela, jogo, comando);
+    }
+}
+
+void imprimeQuadroChave(tTela *tela, const tJogo *jogo, char comando) {
+    desenhaTabuleiro(jogo->mapa, &jogo->partida, tela->quadro);
+
+    printf("Q %lld %c %lld %d %d %d\n", adquireQtdMovimentos(jogo->estatisticas), comando,
+        jogo->partida.pontuacao, jogo->partida.estado, tela->nLinhas, tela->mColunas);
+    int i;
+    for (i = 0; i < tela->nLinhas; i++) {
+        fwrite(tela->quadro[i], 1, tela->mColunas, stdout);
+        printf("%c", '\n');
+    }
+}
+
+void imprimeQuadroDelta(tTela *tela, const tJogo *jogo, char comando) {
+    tPosicao alteradas[tela->nLinhas * tela->mColunas + 4];
+    int qtdAlteradas = atualizaTela(tela, jogo, alteradas);
+
+    printf("D %lld %c %lld %d %d\n", adquireQtdMovimentos(jogo->estatisticas), comando,
+        jogo->partida.pontuacao, jogo->partida.estado, qtdAlteradas);
+    int k;
+    for (k = 0; k < qtdAlteradas; k++) {
+        tPosicao pos = alteradas[k];
+        printf("%d %d %c\n", adquireI(pos), adquireJ(pos), tela->quadro[adquireI(pos)][adquireJ(pos)]);
+    }
+}
+
+int atualizaTela(tTela *tela, const tJogo *jogo, tPosicao alteradas[]) {
+    const tPartida *partida = &jogo->partida;
+    const tFila *corpo = &partida->cobra.corpo;
+    const tRegistro *registro = &jogo->ultimoRegistro;
+
+    // celulas que o ultimo movimento pode ter alterado: a cauda que saiu, a cabeca anterior e a nova,
+    // a comida renascida no modo infinito e, se a cobra morreu, todo o corpo
+    tPosicao candidatas[tela->nLinhas * tela->mColunas + 4];
+    int qtdCandidatas = 0;
+    if (!registro->cresceu) {
+        candidatas[qtdCandidatas++] = registro->cauda;
+    }
+    if (partida->infinito != NULL && registro->devorado == CEL_COMID && partida->infinito->renascida >= 0) {
+        int mColunas = adquireColunas(jogo->mapa);
+        candidatas[qtdCandidatas++] = inicializaPosicao(partida->infinito->renascida / mColunas, partida->infinito->renascida % mColunas);
+    }
+    if (adquireEstado(&partida->cobra) == CBR_EST_M) {
+        int k;
+        for (k = 0; k < adquireTam(corpo); k++) {
+            candidatas[qtdCandidatas++] = consultaElem(corpo, k);
+        }
+    }
+    else {
+        if (adquireTam(corpo) > 1) {
+            candidatas[qtdCandidatas++] = consultaElem(corpo, 1);
+        }
+        candidatas[qtdCandidatas++] = consultaElem(corpo, 0);
+    }
+
+    // so entram as celulas cujo glifo mudou; repetidas mudam apenas na primeira vez
+    int qtdAlteradas = 0;
+    int k;
+    for (k = 0; k < qtdCandidatas; k++) {
+        tPosicao pos = candidatas[k];
+        char glifo = adquireGlifo(jogo->mapa, partida, pos);
+        if (tela->quadro[adquireI(pos)][adquireJ(pos)] != glifo) {
+            tela->quadro[adquireI(pos)][adquireJ(pos)] = glifo;
+            alteradas[qtdAlteradas++] = pos;
+        }
+    }
+
+    return qtdAlteradas;
+}
+
+char adquireGlifo(const tMapa *mapa, const tPartida *partida, tPosicao pos) {
+    const tFila *corpo = &partida->cobra.corpo;
+
+    if (adquireEstado(&partida->cobra) == CBR_EST_M) {
+        int k;
+        for (k = 0; k < adquireTam(corpo); k++) {
+            if (comparaPos(consultaElem(corpo, k), pos)) {
+                return CEL_CBRCM;
+            }
+        }
+        return adquireCelPartida(mapa, partida, pos);
+    }
+
+    if (comparaPos(adquireCabeca(&partida->cobra), pos)) {
+        switch (adquireDirecao(&partida->cobra)) {
+            case CBR_DIR_N:
+                return CEL_CBRCC;
+
+            case CBR_DIR_L:
+                return CEL_CBRCD;
+
+            case CBR_DIR_S:
+                return CEL_CBRCB;
+
+            default:
+                return CEL_CBRCE;
+        }
+    }
+    if (adquireTam(corpo) > 1 && comparaPos(consultaElem(corpo, 1), pos)) {
+        return CEL_CBRCO;
+    }
+
+    return adquireCelPartida(mapa, partida, pos);
+}
+
+void reconstroiQuadros(FILE *entrada) {
+    static char quadro[TAM_MAPA][TAM_MAPA];
+    int nLinhas = 0;
+    int mColunas = 0;
+
+    char tipo;
+    while (fscanf(entrada, " %c", &tipo) == 1) {
+        long long movimento, pontuacao;
+        int estado;
+        char comando;
+
+        if (tipo == 'Q') {
+            if (fscanf(entrada, "%lld %c %lld %d %d %d%*c", &movimento, &comando, &pontuacao, &estado, &nLinhas, &mColunas) != 6
+                || nLinhas <= 0 || nLinhas > TAM_MAPA || mColunas <= 0 || mColunas > TAM_MAPA) {
+                printf("ERRO: Quadro-chave invalido\n");
+                exit(EXIT_FAILURE);
+            }
+
+            int i;
+            for (i = 0; i < nLinhas; i++) {
+                if (fread(quadro[i], 1, mColunas, entrada) != (size_t)mColunas) {
+                    printf("ERRO: Quadro-chave incompleto\n");
+                    exit(EXIT_FAILURE);
+                }
+                fscanf(entrada, "%*c");
+            }
+        }
+        else if (tipo == 'D' && mColunas > 0) {
+            int qtd;
+            if (fscanf(entrada, "%lld %c %lld %d %d", &movimento, &comando, &pontuacao, &estado, &qtd) != 5) {
+                printf("ERRO: Quadro delta invalido\n");
+                exit(EXIT_FAILURE);
+            }
+
+            int k;
+            for (k = 0; k < qtd; k++) {
+                int i, j;
+                // o glifo pode ser um espaco, entao e lido logo apos o separador
+                if (fscanf(entrada, "%d %d%*c", &i, &j) != 2 || i < 0 || i >= nLinhas || j < 0 || j >= mColunas) {
+                    printf("ERRO: Celula invalida no quadro delta do movimento %lld\n", movimento);
+                    exit(EXIT_FAILURE);
+                }
+                quadro[i][j] = fgetc(entrada);
+            }
+        }
+        else {
+            printf("ERRO: Quadro desconhecido (%c)\n", tipo);
+            exit(EXIT_FAILURE);
+        }
+
+        // o movimento 0 nao aparece na saida normal
+        if (movimento == 0) {
+            continue;
+        }
+
+        printf("%c", '\n');
+        printf("Estado do jogo apos o movimento '%c':\n", comando);
+        int i;
+        for (i = 0; i < nLinhas; i++) {
+            fwrite(quadro[i], 1, mColunas, stdout);
+            printf("%c", '\n');
+        }
+        imprimePlacar(pontuacao, estado);
+    }
+}
+// FIM TELA
+
+// LOTE
+void inicializaLote(tLote *lote, const tJogo *modelo, int qtd, tSujas *sujas[], tPosicao corpos[]) {
+    // as posicoes alem de qtd ficam zeradas e inativas
+    memset(lote, 0, offsetof(tLote, jogos));
+    lote->qtd = qtd;
+    lote->mapa = modelo->mapa;
+
+    int capCorpo = adquireLinhas(modelo->mapa) * adquireColunas(modelo->mapa);
+    int k;
+    for (k = 0; k < qtd; k++) {
+        lote->jogos[k].sujas = sujas != NULL ? sujas[k] : NULL;
+        lote->jogos[k].partida.cobra.corpo = inicializaFila(corpos + (long)k * capCorpo, capCorpo);
+        reiniciaNoLote(lote, k, modelo);
+    }
+}
+
+void reiniciaNoLote(tLote *lote, int k, const tJogo *modelo) {
+    tJogo *jogo = &lote->jogos[k];
+    tSujas *sujas = jogo->sujas;
+    tFila corpo = jogo->partida.cobra.corpo;
+    *jogo = *modelo;
+    jogo->heatmap = NULL;
+    jogo->sujas = sujas;
+    jogo->partida.cobra.corpo = corpo;
+    clonaPartida(jogo->mapa, &jogo->partida, &modelo->partida);
+    jogo->estatisticas = inicializaEstatisticas();
+
+    tPosicao cab = adquireCabeca(&jogo->partida.cobra);
+    lote->cabecaI[k] = adquireI(cab);
+    lote->cabecaJ[k] = adquireJ(cab);
+    lote->direcao[k] = adquireDirecao(&jogo->partida.cobra);
+    lote->pontuacao[k] = jogo->partida.pontuacao;
+    lote->qtdComida[k] = jogo->partida.qtdComida;
+    lote->ativo[k] = jogo->partida.estado == JOG_EST_C && !restaSoInalcancavel(jogo->mapa, &jogo->partida);
+}
+
+void avancaLote(tLote *lote, const char movimentos[]) {
+    switch (lote->mapa->lado) {
+#define LOT_CASO_AVANCA(L) case L: avancaLote##L(lote, movimentos); break;
+        MAP_LADOS(LOT_CASO_AVANCA)
+#undef LOT_CASO_AVANCA
+        default:
+            avancaLoteDimensoes(lote, movimentos, lote->mapa->nLinhas, lote->mapa->mColunas);
+            break;
+    }
+}
+
+MAP_LADOS(LOT_DEFINE_AVANCA)
+
+__inline__ void avancaLoteDimensoes(tLote *lote, const char movimentos[], int nLinhas, int mColunas) {
+    const tMapa *mapa = lote->mapa;
+    int n = nLinhas;
+    int m = mColunas;
+    int k;
+
+    // direcao e proxima celula de todos os jogos de uma vez, como giraDirecao, avancaNaDirecao e a
+    // volta pelas bordas de transformaPosicaoValida; jogos inativos ficam parados
+    int destI[LOT_TAM], destJ[LOT_TAM];
+    for (k = 0; k < LOT_TAM; k++) {
+        int giro = (movimentos[k] == MOV_CBRHO) - (movimentos[k] == MOV_CBRAH);
+        int dir = (lote->direcao[k] + giro + 4) & 3;
+        dir = lote->ativo[k] ? dir : lote->direcao[k];
+        lote->direcao[k] = dir;
+
+        int i = lote->cabecaI[k] + lote->ativo[k] * ((dir == CBR_DIR_S) - (dir == CBR_DIR_N));
+        int j = lote->cabecaJ[k] + lote->ativo[k] * ((dir == CBR_DIR_L) - (dir == CBR_DIR_O));
+        destI[k] = i + n * ((i < 0) - (i >= n));
+        destJ[k] = j + m * ((j < 0) - (j >= m));
+    }
+
+    // tuneis, corpo e itens sao proprios de cada jogo
+    for (k = 0; k < lote->qtd; k++) {
+        lote->devorado[k] = CEL_VAZIA;
+        lote->morreu[k] = 0;
+        if (!lote->ativo[k]) {
+            continue;
+        }
+
+        tPosicao posDest = inicializaPosicao(destI[k], destJ[k]);
+        if (mapa->vet[posDest] == CEL_TUNEL) {
+            posDest = transformaPosicaoDimensoes(mapa, posDest, lote->direcao[k], n, m);
+            destI[k] = adquireI(posDest);
+            destJ[k] = adquireJ(posDest);
+        }
+
+        tPartida *partida = &lote->jogos[k].partida;
+        lote->devorado[k] = moveNaPartida(mapa, partida, lote->direcao[k], posDest);
+        lote->morreu[k] = adquireEstado(&partida->cobra) == CBR_EST_M;
+        lote->cabecaI[k] = destI[k];
+        lote->cabecaJ[k] = destJ[k];
+    }
+
+    // pontuacao e estado de todos os jogos de uma vez, como pontuaPartida; o jogo em que so resta
+    // comida inalcancavel tambem para, como em restaSoInalcancavel
+    int inalcancavel = mapa->qtdComidaInalcancavel;
+    int movera[LOT_TAM];
+    for (k = 0; k < LOT_TAM; k++) {
+        int dinheiro = lote->devorado[k] == CEL_DINHR;
+        int comida = lote->devorado[k] == CEL_COMID;
+        movera[k] = lote->ativo[k];
+        lote->pontuacao[k] += lote->ativo[k] * (dinheiro * JOG_PNT_D + comida * JOG_PNT_C);
+        lote->qtdComida[k] -= lote->ativo[k] * comida;
+        lote->ativo[k] = lote->ativo[k] & !lote->morreu[k] & (lote->qtdComida[k] != 0) & (lote->qtdComida[k] != inalcancavel);
+    }
+
+    // devolve o estado a cada jogo e contabiliza a rodada
+    for (k = 0; k < lote->qtd; k++) {
+        if (!movera[k]) {
+            continue;
+        }
+
+        tJogo *jogo = &lote->jogos[k];
+        jogo->partida.pontuacao = lote->pontuacao[k];
+        jogo->partida.qtdComida = lote->qtdComida[k];
+        if (lote->morreu[k]) {
+            jogo->partida.estado = JOG_EST_D;
+        }
+        else if (lote->qtdComida[k] == 0) {
+            jogo->partida.estado = JOG_EST_V;
+        }
+        contabilizaRodada(jogo);
+    }
+}
+
+int contaAtivos(const tLote *lote) {
+    int qtd = 0;
+    int k;
+    for (k = 0; k < LOT_TAM; k++) {
+        qtd += lote->ativo[k];
+    }
+
+    return qtd;
+}
+// FIM LOTE
+
+// JOGO
+tJogo inicializaJogo(char caminhoBase[]) {
+    tJogo jogo = criaJogo(leMapa(caminhoBase));
+
+    jogo.caminhoSaida = malloc(TAM_CAMINHO);
+    if (jogo.heatmap == NULL || jogo.caminhoSaida == NULL) {
+        printf("ERRO: Memoria insuficiente para o jogo\n");
+        exit(EXIT_FAILURE);
+    }
+
+    // faz o o caminho de output
+    combinaCaminho(jogo.caminhoSaida, caminhoBase, DIR_SAID);
+
+    return jogo;
+}
+
+tJogo criaJogo(const tMapa *mapa) {
+    tJogo jogo;
+    jogo.mapa = mapa;
+    jogo.partida = inicializaPartida(jogo.mapa);
+    jogo.estatisticas = inicializaEstatisticas();
+    jogo.sujas = NULL;
+    jogo.caminhoSaida = NULL;
+    jogo.intervaloSerie = 0;
+    jogo.gravaEventos = 0;
+    jogo.diario = NULL;
+    memset(&jogo.ultimoRegistro, 0, sizeof(jogo.ultimoRegistro));
+    jogo.exportador = NULL;
+    jogo.resumo = NULL;
+    jogo.tratador = NULL;
+    jogo.contexto = NULL;
+
+    jogo.heatmap = NULL;
+    if (jogo.partida.cobra.corpo.vet != NULL) {
+        jogo.heatmap = inicializaHeatmap(adquireLinhas(jogo.mapa) * adquireColunas(jogo.mapa));
+    }
+
+    // a celula inicial da cabeca conta como visitada
+    if (jogo.heatmap != NULL) {
+        tPosicao cab = adquireCabeca(adquireCobra(&jogo.partida));
+        incrementaHeatmap(jogo.heatmap, adquireCelula(jogo.mapa, cab));
+    }
+
+    return jogo;
+}
+
+int acabou(tJogo jogo) {
+    return jogo.partida.estado != JOG_EST_C;
+}
+
+tJogo fazRodada(tJogo jogo, char movimento) {
+    jogo.ultimoRegistro = fazMovimentoRegistrado(jogo.mapa, &jogo.partida, movimento);
+    contabilizaRodada(&jogo);
+    if (jogo.diario != NULL && jogo.partida.infinito == NULL) {
+        empilhaRegistro(jogo.diario, jogo.ultimoRegistro);
+    }
+
+    const tCobra *cbr = adquireCobra(&jogo.partida);
+    emiteEvento(jogo, adquireQtdMovimentos(jogo.estatisticas), cbr, movimento);
+
+    if (jogo.intervaloSerie > 0 && adquireQtdMovimentos(jogo.estatisticas) % jogo.intervaloSerie == 0) {
+        exportaSnapshotHeatmap(jogo);
+    }
+
+    return jogo;
+}
+
+void avancaJogo(tJogo *jogo, char movimento) {
+    fazMovimento(jogo->mapa, &jogo->partida, movimento);
+    contabilizaRodada(jogo);
+}
+
+void contabilizaRodada(tJogo *jogo) {
+    switch (jogo->mapa->lado) {
+#define JOG_CASO_CONTABILIZA(L) case L: contabilizaRodada##L(jogo); break;
+        MAP_LADOS(JOG_CASO_CONTABILIZA)
+#undef JOG_CASO_CONTABILIZA
+        default:
+            contabilizaRodadaDimensoes(jogo, jogo->mapa->mColunas);
+            break;
+    }
+}
+
+MAP_LADOS(JOG_DEFINE_CONTABILIZA)
+
+__inline__ void contabilizaRodadaDimensoes(tJogo *jogo, unsigned int mColunas) {
+    // atualiza o heatmap
+    tPosicao cab = adquireCabeca(&jogo->partida.cobra);
+    int celula = adquireCelulaDimensoes(cab, mColunas);
+    if (jogo->heatmap != NULL) {
+        incrementaHeatmap(jogo->heatmap, celula);
+    }
+    if (jogo->sujas != NULL) {
+        marcaSuja(jogo->sujas, celula);
+    }
+
+    jogo->estatisticas = atualizaEstatisticas(jogo->estatisticas, &jogo->partida.cobra);
+    if (jogo->heatmap != NULL) {
+        publicaMovimentos(jogo->heatmap, adquireQtdMovimentos(jogo->estatisticas));
+    }
+}
+void emiteEvento(tJogo jogo, long long currMov, const tCobra *cobra, char movimento) {
+    char devorado = adquireDevorado(cobra);
+
+    tTarefa tarefa = { EXP_TRF_R };
+    if (jogo.gravaEventos) {
+        tarefa.tipo = EXP_TRF_V;
+    }
+    if (adquireEstado(cobra) == CBR_EST_M) {
+        tarefa.evento.tipo = devorado == CEL_PARED ? EVT_PAREDE : EVT_CORPO;
+    }
+    else if (devorado == CEL_DINHR) {
+        tarefa.evento.tipo = EVT_DINHEIRO;
+    }
+    else if (devorado == CEL_COMID) {
+        tarefa.evento.tipo = jogo.partida.estado == JOG_EST_V ? EVT_VITORIA : EVT_COMIDA;
+    }
+    else {
+        // nenhum evento relevante
+        return;
+    }
+    tarefa.evento.movimento = currMov;
+    tarefa.evento.pontuacao = jogo.partida.pontuacao;
+    tarefa.evento.tamanho = adquireTamanho(cobra);
+    tarefa.evento.comando = movimento;
+
+    if (jogo.tratador != NULL) {
+        jogo.tratador(&tarefa.evento, jogo.contexto);
+    }
+    if (jogo.resumo != NULL) {
+        escreveResumo(jogo.resumo, &tarefa.evento);
+    }
+    if (jogo.caminhoSaida != NULL) {
+        despachaTarefa(jogo.exportador, jogo.caminhoSaida, tarefa);
+    }
+}
+
+int exportaInicializacao(tJogo jogo) {
+    if (jogo.caminhoSaida == NULL) {
+        return 0;
+    }
+
+    tQuadroInicial *quadro = malloc(sizeof(tQuadroInicial));
+    int n = adquireLinhas(jogo.mapa);
+    int m = adquireColunas(jogo.mapa);
+    if (quadro != NULL) {
+        quadro->tabuleiro = malloc(n * m);
+    }
+    if (quadro == NULL || quadro->tabuleiro == NULL) {
+        free(quadro);
+        return -1;
+    }
+
+    char tabuleiro[TAM_MAPA][TAM_MAPA];
+    desenhaTabuleiro(jogo.mapa, &jogo.partida, tabuleiro);
+
+    int i;
+    for (i = 0; i < n; i++) {
+        memcpy(quadro->tabuleiro + i * m, tabuleiro[i], m);
+    }
+    quadro->nLinhas = n;
+    quadro->mColunas = m;
+    quadro->cabeca = adquireCabeca(adquireCobra(&jogo.partida));
+
+    tTarefa tarefa = { EXP_TRF_I };
+    tarefa.quadro = quadro;
+    return despachaTarefa(jogo.exportador, jogo.caminhoSaida, tarefa);
+}
+
+int exportaJogo(tJogo jogo) {
+    if (jogo.caminhoSaida == NULL) {
+        return 0;
+    }
+
+    // garante que a serie termine no heatmap final
+    int exportado = 0;
+    if (jogo.intervaloSerie > 0 && jogo.sujas->qtd > 0) {
+        exportado = exportaSnapshotHeatmap(jogo);
+    }
+
+    tQuadroFinal *quadro = malloc(sizeof(tQuadroFinal));
+    if (quadro != NULL) {
+        quadro->heatmap = clonaHeatmap(jogo.heatmap);
+    }
+    if (quadro == NULL || quadro->heatmap == NULL) {
+        free(quadro);
+        return -1;
+    }
+
+    quadro->nLinhas = adquireLinhas(jogo.mapa);
+    quadro->mColunas = adquireColunas(jogo.mapa);
+    quadro->estatisticas = jogo.estatisticas;
+    quadro->caminhoSaida = NULL;
+
+    tTarefa tarefa = { EXP_TRF_F };
+    tarefa.quadro = quadro;
+    if (despachaTarefa(jogo.exportador, jogo.caminhoSaida, tarefa) != 0) {
+        exportado = -1;
+    }
+    return exportado;
+}
+
+tJogo habilitaSerie(tJogo jogo, int intervalo) {
+    jogo.sujas = inicializaSujas(adquireLinhas(jogo.mapa) * adquireColunas(jogo.mapa));
+    if (jogo.sujas == NULL) {
+        return jogo;
+    }
+    jogo.intervaloSerie = intervalo;
+
+    // o snapshot do movimento 0 contem a celula inicial da cabeca
+    tPosicao cab = adquireCabeca(adquireCobra(&jogo.partida));
+    marcaSuja(jogo.sujas, adquireCelula(jogo.mapa, cab));
+
+    char caminhoSeri[TAM_CAMINHO];
+    combinaCaminho(caminhoSeri, jogo.caminhoSaida, ARQ_SERI);
+    FILE *arq = fopen(caminhoSeri, "wb");
+    if (arq == NULL) {
+        liberaSujas(jogo.sujas);
+        jogo.sujas = NULL;
+        jogo.intervaloSerie = 0;
+        return jogo;
+    }
+
+    fprintf(arq, "%s", SER_ASSN);
+    escreveVarint(arq, adquireLinhas(jogo.mapa));
+    escreveVarint(arq, adquireColunas(jogo.mapa));
+    escreveVarint(arq, intervalo);
+    int escrito = escreveSnapshot(jogo.sujas, arq, 0);
+
+    fclose(arq);
+
+    if (escrito != 0) {
+        liberaSujas(jogo.sujas);
+        jogo.sujas = NULL;
+        jogo.intervaloSerie = 0;
+    }
+    return jogo;
+}
+
+tJogo habilitaExportador(tJogo jogo, tExportador *exportador) {
+    jogo.exportador = exportador;
+    return jogo;
+}
+
+tJogo habilitaInfinito(tJogo jogo, unsigned long long semente) {
+    jogo.partida.infinito = inicializaInfinito(jogo.mapa, semente);
+    return jogo;
+}
+
+tJogo habilitaDiario(tJogo jogo) {
+    jogo.diario = inicializaDiario();
+    return jogo;
+}
+
+tJogo habilitaEventos(tJogo jogo) {
+    jogo.gravaEventos = 1;
+    return jogo;
+}
+
+tJogo registraTratador(tJogo jogo, tTratadorEvento tratador, void *contexto) {
+    jogo.tratador = tratador;
+    jogo.contexto = contexto;
+    return jogo;
+}
+
+int habilitaHeatmapVivo(tJogo *jogo) {
+    char caminhoVivo[TAM_CAMINHO];
+    combinaCaminho(caminhoVivo, jogo->caminhoSaida, ARQ_HMVV);
+    if (mapeiaHeatmap(jogo->heatmap, caminhoVivo, adquireLinhas(jogo->mapa), adquireColunas(jogo->mapa)) != 0) {
+        return -1;
+    }
+
+    publicaMovimentos(jogo->heatmap, adquireQtdMovimentos(jogo->estatisticas));
+    return 0;
+}
+
+int exportaSnapshotHeatmap(tJogo jogo) {
+    tQuadroSerie *quadro = malloc(sizeof(tQuadroSerie));
+    if (quadro != NULL) {
+        quadro->incrementos = malloc((jogo.sujas->qtd + 1) * sizeof(tIncremento));
+    }
+    if (quadro == NULL || quadro->incrementos == NULL) {
+        free(quadro);
+        return -1;
+    }
+
+    quadro->movimento = adquireQtdMovimentos(jogo.estatisticas);
+    quadro->qtd = extraiIncrementos(jogo.sujas, quadro->incrementos);
+
+    tTarefa tarefa = { EXP_TRF_S };
+    tarefa.quadro = quadro;
+    return despachaTarefa(jogo.exportador, jogo.caminhoSaida, tarefa);
+}
+
+tJogo desfazRodada(tJogo jogo) {
+    retrocedeJogo(&jogo);
+    return jogo;
+}
+
+void retrocedeJogo(tJogo *jogo) {
+    // a comida renascida e o conjunto de celulas vazias do modo infinito nao voltam atras
+    if (jogo->diario == NULL || jogo->diario->qtd == 0 || jogo->partida.infinito != NULL) {
+        return;
+    }
+
+    tRegistro registro = desempilhaRegistro(jogo->diario);
+    jogo->estatisticas = desfazEstatisticas(jogo->estatisticas, &jogo->partida.cobra);
+    if (jogo->heatmap != NULL) {
+        decrementaHeatmap(jogo->heatmap, registro.celula);
+        publicaMovimentos(jogo->heatmap, adquireQtdMovimentos(jogo->estatisticas));
+    }
+    desfazMovimento(jogo->mapa, &jogo->partida, &registro);
+}
+
+void liberaJogo(tJogo jogo) {
+    liberaSujas(jogo.sujas);
+    liberaInfinito(jogo.partida.infinito);
+    liberaPartida(&jogo.partida);
+    liberaDiario(jogo.diario);
+    liberaHeatmap(jogo.heatmap);
+    free(jogo.caminhoSaida);
+    free((tMapa *) jogo.mapa);
+}
+
+void imprimeJogo(tJogo jogo) {
+    imprimeMapa(jogo.mapa, &jogo.partida);
+    imprimePlacar(jogo.partida.pontuacao, jogo.partida.estado);
+}
+
+void imprimePlacar(long long pontuacao, int estado) {
+    escrevePlacar(stdout, pontuacao, estado);
+}
+
+void escrevePlacar(FILE *arq, long long pontuacao, int estado) {
+    fprintf(arq, "Pontuacao: %lld\n", pontuacao);
+
+    if (estado == JOG_EST_C) {
+        return;
+    }
+
+    switch (estado) {
+        case JOG_EST_V:
+            fprintf(arq, "%s", "Voce venceu!\n");
+            break;
+        
+        case JOG_EST_D:
+            fprintf(arq, "%s", "Game over!\n");
+            break;
+    }
+
+    fprintf(arq, "Pontuacao final: %lld\n", pontuacao);
+}
+// FIM JOGO
+
+// EXPORTADOR
+tExportador *inicializaExportador(char caminhoSaida[]) {
+    tExportador *exportador = malloc(sizeof(tExportador));
+    if (exportador == NULL) {
+        return NULL;
+    }
+
+    exportador->inicio = 0;
+    exportador->fim = 0;
+    exportador->resumo = NULL;
+    exportador->eventos = NULL;
+    exportador->falhou = 0;
+    strcpy(exportador->caminhoSaida, caminhoSaida);
+    sem_init(&exportador->itens, 0, 0);
+    sem_init(&exportador->livres, 0, EXP_CAP);
+
+    if (pthread_create(&exportador->thread, NULL, executaExportador, exportador) != 0) {
+        sem_destroy(&exportador->itens);
+        sem_destroy(&exportador->livres);
+        free(exportador);
+        return NULL;
+    }
+
+    return exportador;
+}
+
+void enviaTarefa(tExportador *exportador, tTarefa tarefa) {
+    sem_wait(&exportador->livres);
+
+    exportador->fila[exportador->fim % EXP_CAP] = tarefa;
+    exportador->fim++;
+
+    sem_post(&exportador->itens);
+}
+
+int despachaTarefa(tExportador *exportador, char caminhoSaida[], tTarefa tarefa) {
+    if (exportador != NULL) {
+        enviaTarefa(exportador, tarefa);
+        return 0;
+    }
+
+    FILE *resumo = NULL;
+    FILE *eventos = NULL;
+    int processado = processaTarefa(caminhoSaida, &resumo, &eventos, &tarefa);
+    if (resumo != NULL) {
+        fclose(resumo);
+    }
+    if (eventos != NULL) {
+        fclose(eventos);
+    }
+    return processado;
+}
+
+int processaTarefa(char caminhoSaida[], FILE **resumo, FILE **eventos, tTarefa *tarefa) {
+    char caminho[TAM_CAMINHO];
+    int processado = 0;
+
+    switch (tarefa->tipo) {
+        case EXP_TRF_R:
+        case EXP_TRF_V:
+            if (*resumo == NULL) {
+                combinaCaminho(caminho, caminhoSaida, ARQ_RESM);
+                *resumo = fopen(caminho, "a");
+            }
+            if (*resumo != NULL) {
+                escreveResumo(*resumo, &tarefa->evento);
+            }
+            else {
+                processado = -1;
+            }
+            if (tarefa->tipo == EXP_TRF_V) {
+                if (*eventos == NULL) {
+                    combinaCaminho(caminho, caminhoSaida, ARQ_EVTS);
+                    *eventos = fopen(caminho, "ab");
+                }
+                if (*eventos != NULL) {
+                    escreveEvento(*eventos, &tarefa->evento);
+                }
+                else {
+                    processado = -1;
+                }
+            }
+            break;
+
+        case EXP_TRF_I: {
+            tQuadroInicial *quadro = tarefa->quadro;
+            combinaCaminho(caminho, caminhoSaida, ARQ_INIC);
+            FILE *arq = fopen(caminho, "w");
+            if (arq != NULL) {
+                escreveInicializacao(arq, quadro);
+                fclose(arq);
+            }
+            else {
+                processado = -1;
+            }
+            free(quadro->tabuleiro);
+            free(quadro);
+            break;
+        }
+
+        case EXP_TRF_S: {
+            tQuadroSerie *quadro = tarefa->quadro;
+            combinaCaminho(caminho, caminhoSaida, ARQ_SERI);
+            FILE *arq = fopen(caminho, "ab");
+            if (arq != NULL) {
+                escreveIncrementos(arq, quadro->movimento, quadro->incrementos, quadro->qtd);
+                fclose(arq);
+            }
+            else {
+                processado = -1;
+            }
+
+            free(quadro->incrementos);
+            free(quadro);
+            break;
+        }
+
+        case EXP_TRF_F: {
+            tQuadroFinal *quadro = tarefa->quadro;
+            quadro->caminhoSaida = caminhoSaida;
+
+            // o jogo acabou: o resumo esta completo
+            if (*resumo != NULL) {
+                fclose(*resumo);
+                *resumo = NULL;
+            }
+            if (*eventos != NULL) {
+                fclose(*eventos);
+                *eventos = NULL;
+            }
+
+            // o ranking, que ordena o heatmap, e escrito em paralelo com o heatmap e as estatisticas
+            pthread_t ranking;
+            int paralelo = pthread_create(&ranking, NULL, executaRanking, quadro) == 0;
+            if (!paralelo) {
+                executaRanking(quadro);
+            }
+            if (exportaEstatisticas(quadro->estatisticas, caminhoSaida) != 0) {
+                processado = -1;
+            }
+            if (exportaHeatmap(quadro->nLinhas, quadro->mColunas, quadro->heatmap, caminhoSaida) != 0) {
+                processado = -1;
+            }
+            if (paralelo) {
+                pthread_join(ranking, NULL);
+            }
+            if (quadro->rankingExportado != 0) {
+                processado = -1;
+            }
+
+            liberaHeatmap(quadro->heatmap);
+            free(quadro);
+            break;
+        }
+    }
+    return processado;
+}
+
+void *executaExportador(void *arg) {
+    tExportador *exportador = arg;
+
+    for (;;) {
+        sem_wait(&exportador->itens);
+
+        tTarefa tarefa = exportador->fila[exportador->inicio % EXP_CAP];
+        exportador->inicio++;
+
+        sem_post(&exportador->livres);
+
+        if (tarefa.tipo == EXP_TRF_E) {
+            break;
+        }
+        if (processaTarefa(exportador->caminhoSaida, &exportador->resumo, &exportador->eventos, &tarefa) != 0) {
+            exportador->falhou = 1;
+        }
+    }
+
+    if (exportador->resumo != NULL) {
+        fclose(exportador->resumo);
+        exportador->resumo = NULL;
+    }
+    if (exportador->eventos != NULL) {
+        fclose(exportador->eventos);
+        exportador->eventos = NULL;
+    }
+
+    return NULL;
+}
+
+void *executaRanking(void *arg) {
+    tQuadroFinal *quadro = arg;
+    quadro->rankingExportado = exportaRanking(quadro->nLinhas, quadro->mColunas, quadro->heatmap, quadro->caminhoSaida);
+
+    return NULL;
+}
+
+void escreveResumo(FILE *arq, const tEvento *evento) {
+    fprintf(arq, "Movimento %lld (%c) ", evento->movimento, evento->comando);
+    switch (evento->tipo) {
+        case EVT_DINHEIRO:
+            fprintf(arq, "gerou dinheiro");
+            break;
+
+        case EVT_COMIDA:
+            fprintf(arq, "fez a cobra crescer para o tamanho %d", evento->tamanho);
+            break;
+
+        case EVT_VITORIA:
+            fprintf(arq, "fez a cobra crescer para o tamanho %d, terminando o jogo", evento->tamanho);
+            break;
+
+        default:
+            fprintf(arq, "resultou no fim de jogo por conta de colisao");
+            break;
+    }
+    fprintf(arq, "%c", '\n');
+}
+
+void escreveEvento(FILE *arq, const tEvento *evento) {
+    if (ftell(arq) == 0) {
+        fwrite(EVT_ASSN, 1, sizeof(EVT_ASSN), arq);
+    }
+    fwrite(evento, sizeof(tEvento), 1, arq);
+}
+
+void escreveInicializacao(FILE *arq, const tQuadroInicial *quadro) {
+    int i;
+    for (i = 0; i < quadro->nLinhas; i++) {
+        fwrite(quadro->tabuleiro + i * quadro->mColunas, 1, quadro->mColunas, arq);
+        fputc('\n', arq);
+    }
+    fprintf(arq, "A cobra comecara o jogo na linha %d e coluna %d\n", adquireI(quadro->cabeca) + 1, adquireJ(quadro->cabeca) + 1);
+}
+
+int encerraExportador(tExportador *exportador) {
+    if (exportador == NULL) {
+        return 0;
+    }
+
+    tTarefa tarefa = { EXP_TRF_E };
+    enviaTarefa(exportador, tarefa);
+    pthread_join(exportador->thread, NULL);
+
+    // apos o join, falhou ja pode ser lido sem sincronizacao
+    int encerrado = exportador->falhou ? -1 : 0;
+    sem_destroy(&exportador->itens);
+    sem_destroy(&exportador->livres);
+    free(exportador);
+    return encerrado;
+}
+// FIM EXPORTADOR
+
+// ESTATISTICAS
+tEstatisticas inicializaEstatisticas() {
+    tEstatisticas estatisticas = { 0, 0, 0, 0, 0, 0 };
+    return estatisticas;
+}
+
+long long adquireQtdMovimentos(tEstatisticas estatisticas) {
+    return estatisticas.qtdMov;
+}
+
+tEstatisticas atualizaEstatisticas(tEstatisticas estatisticas, const tCobra *cobra) {
+    estatisticas.qtdMov++;
+    switch (adquireDirecao(cobra)) {
+        case CBR_DIR_N:
+            estatisticas.qtdMovC++;
+            break;
+
+        case CBR_DIR_L:
+            estatisticas.qtdMovD++;
+            break;
+
+        case CBR_DIR_S:
+            estatisticas.qtdMovB++;
+            break;
+
+        case CBR_DIR_O:
+            estatisticas.qtdMovE++;
+            break;
+    }
+    
+    char devorado = adquireDevorado(cobra);
+    if (devorado != CEL_COMID && devorado != CEL_DINHR) {
+        estatisticas.qtdNPntMov++;
+    }
+
+    return estatisticas;
+}
+
+tEstatisticas desfazEstatisticas(tEstatisticas estatisticas, const tCobra *cobra) {
+    estatisticas.qtdMov--;
+    switch (adquireDirecao(cobra)) {
+        case CBR_DIR_N:
+            estatisticas.qtdMovC--;
+            break;
+
+        case CBR_DIR_L:
+            estatisticas.qtdMovD--;
+            break;
+
+        case CBR_DIR_S:
+            estatisticas.qtdMovB--;
+            break;
+
+        case CBR_DIR_O:
+            estatisticas.qtdMovE--;
+            break;
+    }
+    
+    char devorado = adquireDevorado(cobra);
+    if (devorado != CEL_COMID && devorado != CEL_DINHR) {
+        estatisticas.qtdNPntMov--;
+    }
+
+    return estatisticas;
+}
+
+int exportaEstatisticas(tEstatisticas estatisticas, char caminhoBase[]) {
+    char caminhoStts[TAM_CAMINHO];
+    combinaCaminho(caminhoStts, caminhoBase, ARQ_STTS);
+    FILE *arq = fopen(caminhoStts, "w");
+    if (arq == NULL) {
+        return -1;
+    }
+    escreveEstatisticas(arq, estatisticas);
+    fclose(arq);
+    return 0;
+}
+
+void escreveEstatisticas(FILE *arq, tEstatisticas estatisticas) {
+    fprintf(arq, "Numero de movimentos: %lld\n", estatisticas.qtdMov);
+    fprintf(arq, "Numero de movimentos sem pontuar: %lld\n", estatisticas.qtdNPntMov);
+    fprintf(arq, "Numero de movimentos para baixo: %lld\n", estatisticas.qtdMovB);
+    fprintf(arq, "Numero de movimentos para cima: %lld\n", estatisticas.qtdMovC);
+    fprintf(arq, "Numero de movimentos para esquerda: %lld\n", estatisticas.qtdMovE);
+    fprintf(arq, "Numero de movimentos para direita: %lld\n", estatisticas.qtdMovD);
+}
+// FIM ESTATISTICAS
+
+// PARTIDA
+tPartida inicializaPartida(const tMapa *mapa) {
+    tPartida partida;
+    int capacidade = mapa->nLinhas * mapa->mColunas;
+    partida.cobra = mapa->cobra;
+    partida.cobra.corpo = inicializaFila(malloc(capacidade * sizeof(tPosicao)), capacidade);
+    if (partida.cobra.corpo.vet != NULL) {
+        clonaFila(&partida.cobra.corpo, &mapa->cobra.corpo);
+    }
+    partida.qtdComida = mapa->qtdComida;
+    partida.pontuacao = 0;
+    partida.estado = JOG_EST_C;
+    memset(partida.consumidos, 0, sizeof(partida.consumidos));
+    partida.infinito = NULL;
+    partida.hash = partida.cobra.corpo.vet != NULL ? calculaHash(mapa, &partida) : 0;
+
+    return partida;
+}
+
+void liberaPartida(tPartida *partida) {
+    free(partida->cobra.corpo.vet);
+}
+
+void clonaPartida(const tMapa *mapa, tPartida *destino, const tPartida *origem) {
+    clonaCobra(&destino->cobra, &origem->cobra);
+    destino->qtdComida = origem->qtdComida;
+    destino->pontuacao = origem->pontuacao;
+    destino->estado = origem->estado;
+    destino->hash = origem->hash;
+    memcpy(destino->consumidos, origem->consumidos, ((mapa->qtdItens + 63) / 64) * sizeof(unsigned long long));
+    destino->infinito = NULL;
+}
+
+const tCobra *adquireCobra(const tPartida *partida) {
+    return &partida->cobra;
+}
+
+int adquireQtdComida(const tPartida *partida) {
+    return partida->qtdComida;
+}
+
+unsigned long long adquireHash(const tPartida *partida) {
+    return partida->hash;
+}
+
+unsigned long long calculaHash(const tMapa *mapa, const tPartida *partida) {
+    tPosicao cab = adquireCabeca(&partida->cobra);
+    unsigned long long hash = mapa->chaveCabeca[cab] ^ mapa->chaveDirecao[adquireDirecao(&partida->cobra)];
+
+    const tFila *cbrCorpo = &partida->cobra.corpo;
+    int i;
+    for (i = 0; i < adquireTam(cbrCorpo); i++) {
+        tPosicao parte = consultaElem(cbrCorpo, i);
+        hash ^= mapa->chaveCorpo[parte];
+    }
+
+    for (i = 0; i < mapa->qtdItens; i++) {
+        if (!foiConsumido(partida, i)) {
+            hash ^= mapa->chaveItem[i];
+        }
+    }
+
+    return hash;
+}
+
+int restaSoInalcancavel(const tMapa *mapa, const tPartida *partida) {
+    return partida->infinito == NULL && partida->qtdComida > 0 && partida->qtdComida == mapa->qtdComidaInalcancavel;
+}
+
+int foiConsumido(const tPartida *partida, int item) {
+    return (partida->consumidos[item / 64] >> (item % 64)) & 1;
+}
+
+char adquireCelPartida(const tMapa *mapa, const tPartida *partida, tPosicao pos) {
+    if (partida->infinito != NULL && temComidaRenascida(partida->infinito, adquireCelula(mapa, pos))) {
+        return CEL_COMID;
+    }
+
+    int item = mapa->itemDaCelula[pos];
+    if (item >= 0 && foiConsumido(partida, item)) {
+        return CEL_VAZIA;
+    }
+
+    return mapa->vet[pos];
+}
+
+void fazMovimento(const tMapa *mapa, tPartida *partida, char movimento) {
+    switch (mapa->lado) {
+#define PAR_CASO_MOVIMENTO(L) case L: fazMovimento##L(mapa, partida, movimento); break;
+        MAP_LADOS(PAR_CASO_MOVIMENTO)
+#undef PAR_CASO_MOVIMENTO
+        default:
+            fazMovimentoDimensoes(mapa, partida, movimento, mapa->nLinhas, mapa->mColunas);
+            break;
+    }
+}
+
+MAP_LADOS(PAR_DEFINE_MOVIMENTO)
+
+__inline__ void fazMovimentoDimensoes(const tMapa *mapa, tPartida *partida, char movimento, unsigned int nLinhas, unsigned int mColunas) {
+    int direcao = giraDirecao(adquireDirecao(&partida->cobra), movimento);
+    tPosicao posDest = avancaNaDirecao(adquireCabeca(&partida->cobra), direcao);
+    posDest = transformaPosicaoDimensoes(mapa, posDest, direcao, nLinhas, mColunas);
+
+    char cbrDevorou = moveNaPartida(mapa, partida, direcao, posDest);
+    pontuaPartida(partida, cbrDevorou);
+}
+
+char moveNaPartida(const tMapa *mapa, tPartida *partida, int direcao, tPosicao posDest) {
+    int dirAnterior = adquireDirecao(&partida->cobra);
+    partida->cobra.direcaoCabeca = direcao;
+
+    tPosicao cab = adquireCabeca(&partida->cobra);
+    tPosicao cauda = consultaElem(&partida->cobra.corpo, adquireTam(&partida->cobra.corpo) - 1);
+
+    // o item devorado sai do mapa
+    char cbrDevorou = adquireCelPartida(mapa, partida, posDest);
+    int celDest = adquireCelula(mapa, posDest);
+    if (partida->infinito != NULL && temComidaRenascida(partida->infinito, celDest)) {
+        devoraComidaRenascida(partida->infinito, celDest);
+    }
+    else if (cbrDevorou == CEL_COMID || cbrDevorou == CEL_DINHR) {
+        int item = mapa->itemDaCelula[posDest];
+        partida->consumidos[item / 64] |= 1ULL << (item % 64);
+        partida->hash ^= mapa->chaveItem[item];
+    }
+    int cresce = cresceAoDevorar(cbrDevorou);
+    moveCbr(&partida->cobra, posDest, cbrDevorou);
+
+    // a cabeca avanca, e a cauda so sai do lugar se a cobra nao cresceu
+    partida->hash ^= mapa->chaveCabeca[cab] ^ mapa->chaveCabeca[posDest]
+        ^ mapa->chaveDirecao[dirAnterior] ^ mapa->chaveDirecao[direcao]
+        ^ mapa->chaveCorpo[posDest];
+    if (!cresce) {
+        partida->hash ^= mapa->chaveCorpo[cauda];
+    }
+
+    // no modo infinito, as celulas vazias acompanham a cabeca e a cauda, e a comida devorada renasce
+    if (partida->infinito != NULL) {
+        ocupaCelula(partida->infinito, celDest);
+        if (!cresce && !comparaPos(cauda, posDest)) {
+            desocupaCelula(partida->infinito, adquireCelula(mapa, cauda));
+        }
+        // a comida renascida repoe a devorada, que pontuaPartida desconta
+        if (cbrDevorou == CEL_COMID && renasceComida(partida->infinito) >= 0) {
+            partida->qtdComida++;
+        }
+    }
+
+    return cbrDevorou;
+}
+
+void pontuaPartida(tPartida *partida, char devorado) {
+    // atualiza a pontuacao da partida
+    if (devorado == CEL_DINHR) {
+        partida->pontuacao += JOG_PNT_D;
+    }
+    else if (devorado == CEL_COMID) {
+        partida->pontuacao += JOG_PNT_C;
+        partida->qtdComida--;
+    }
+
+    // atualiza o estado da partida
+    if (adquireEstado(&partida->cobra) == CBR_EST_M) {
+        partida->estado = JOG_EST_D;
+    }
+    else if (partida->qtdComida == 0) {
+        partida->estado = JOG_EST_V;
+    }
+}
+
+tRegistro fazMovimentoRegistrado(const tMapa *mapa, tPartida *partida, char movimento) {
+    tRegistro registro;
+    registro.cauda = consultaElem(&partida->cobra.corpo, adquireTam(&partida->cobra.corpo) - 1);
+    registro.devoradoAnterior = adquireDevorado(&partida->cobra);
+    registro.direcaoAnterior = adquireDirecao(&partida->cobra);
+    registro.estadoAnterior = partida->estado;
+    long long pontuacaoAnterior = partida->pontuacao;
+    int tamanhoAnterior = adquireTamanho(&partida->cobra);
+
+    fazMovimento(mapa, partida, movimento);
+
+    tPosicao cab = adquireCabeca(&partida->cobra);
+    registro.celula = adquireCelula(mapa, cab);
+    registro.devorado = adquireDevorado(&partida->cobra);
+    registro.deltaPontuacao = partida->pontuacao - pontuacaoAnterior;
+    registro.cresceu = adquireTamanho(&partida->cobra) > tamanhoAnterior;
+
+    return registro;
+}
+
+void desfazMovimento(const tMapa *mapa, tPartida *partida, const tRegistro *registro) {
+    tFila *corpo = &partida->cobra.corpo;
+    tPosicao cab = consultaElem(corpo, 0);
+    int cresceu = registro->cresceu;
+
+    // a cabeca volta e, se a cobra nao cresceu, a cauda retorna ao fim do corpo
+    removeInicio(corpo);
+    if (!cresceu) {
+        insereFim(corpo, registro->cauda);
+    }
+    tPosicao cabAnterior = consultaElem(corpo, 0);
+
+    partida->hash ^= mapa->chaveCabeca[cab] ^ mapa->chaveCabeca[cabAnterior]
+        ^ mapa->chaveDirecao[adquireDirecao(&partida->cobra)] ^ mapa->chaveDirecao[(int)registro->direcaoAnterior]
+        ^ mapa->chaveCorpo[cab];
+    if (!cresceu) {
+        partida->hash ^= mapa->chaveCorpo[registro->cauda];
+    }
+
+    // o item devorado volta ao mapa; a comida renascida do modo infinito nao e um item
+    int item = mapa->itemDaCelula[cab];
+    if ((registro->devorado == CEL_COMID || registro->devorado == CEL_DINHR) && item >= 0) {
+        partida->consumidos[item / 64] &= ~(1ULL << (item % 64));
+        partida->hash ^= mapa->chaveItem[item];
+        if (registro->devorado == CEL_COMID) {
+            partida->qtdComida++;
+        }
+    }
+
+    partida->cobra.direcaoCabeca = registro->direcaoAnterior;
+    partida->cobra.devorado = registro->devoradoAnterior;
+    partida->cobra.estado = registro->estadoAnterior == JOG_EST_D ? CBR_EST_M : CBR_EST_V;
+    partida->pontuacao -= registro->deltaPontuacao;
+    partida->estado = registro->estadoAnterior;
+}
+
+int ehMovimentoSeguro(const tMapa *mapa, const tPartida *partida, char movimento) {
+    int direcao = giraDirecao(adquireDirecao(&partida->cobra), movimento);
+    tPosicao posDest = transformaPosicaoValida(mapa, avancaNaDirecao(adquireCabeca(&partida->cobra), direcao), direcao);
+
+    char cel = adquireCelPartida(mapa, partida, posDest);
+    if (cel == CEL_PARED) {
+        return 0;
+    }
+
+    // a cauda sai do lugar, a menos que a cobra cresca
+    const tFila *cbrCorpo = &partida->cobra.corpo;
+    int fim = cresceAoDevorar(cel) ? adquireTam(cbrCorpo) : adquireTam(cbrCorpo) - 1;
+    int i;
+    for (i = 0; i < fim; i++) {
+        if (comparaPos(consultaElem(cbrCorpo, i), posDest)) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+void desenhaTabuleiro(const tMapa *mapa, const tPartida *partida, char tabuleiro[TAM_MAPA][TAM_MAPA]) {
+    int i;
+    for (i = 0; i < mapa->nLinhas; i++) {
+        memcpy(tabuleiro[i], &mapa->vet[inicializaPosicao(i, 0)], mapa->mColunas);
+    }
+
+    // apaga os itens ja devorados
+    for (i = 0; i < mapa->qtdItens; i++) {
+        if (foiConsumido(partida, i)) {
+            tPosicao curr = mapa->itens[i];
+            tabuleiro[adquireI(curr)][adquireJ(curr)] = CEL_VAZIA;
+        }
+    }
+    // desenha as comidas renascidas do modo infinito
+    if (partida->infinito != NULL) {
+        for (i = 0; i < mapa->nLinhas * mapa->mColunas; i++) {
+            if (temComidaRenascida(partida->infinito, i)) {
+                tabuleiro[i / mapa->mColunas][i % mapa->mColunas] = CEL_COMID;
+            }
+        }
+    }
+
+    const tFila *cbrCorpo = &partida->cobra.corpo;
+    // caractere da celula que representa o pedaco do corpo da cobra
+    char cbrCh = adquireEstado(&partida->cobra) == CBR_EST_V ? CEL_CBRCO : CEL_CBRCM;
+    // desenha o corpo da cobra, nao a cabeca
+    for (i = adquireTam(cbrCorpo) - 1; i >= 0; i--) {
+        // posicao do pedaco do corpo da cobra
+        tPosicao curr = consultaElem(cbrCorpo, i);
+        tabuleiro[adquireI(curr)][adquireJ(curr)] = cbrCh;
+    }
+    // desenha a cabeca da cobra
+    if (adquireEstado(&partida->cobra) == CBR_EST_V) {
+        tPosicao curr = adquireCabeca(&partida->cobra);
+        switch (adquireDirecao(&partida->cobra)){
+            case CBR_DIR_N:
+                cbrCh = CEL_CBRCC;
+                break;
+
+            case CBR_DIR_L:
+                cbrCh = CEL_CBRCD;
+                break;
+
+            case CBR_DIR_S:
+                cbrCh = CEL_CBRCB;
+                break;
+
+            case CBR_DIR_O:
+                cbrCh = CEL_CBRCE;
+                break;
+        }
+        tabuleiro[adquireI(curr)][adquireJ(curr)] = cbrCh;
+    }
+}
+
+void imprimeMapa(const tMapa *mapa, const tPartida *partida) {
+    escreveMapa(stdout, mapa, partida);
+}
+
+void escreveMapa(FILE *arq, const tMapa *mapa, const tPartida *partida) {
+    char tabuleiro[TAM_MAPA][TAM_MAPA];
+    desenhaTabuleiro(mapa, partida, tabuleiro);
+
+    int i;
+    for (i = 0; i < mapa->nLinhas; i++) {
+        fwrite(tabuleiro[i], 1, mapa->mColunas, arq);
+        fputc('\n', arq);
+    }
+}
+
+void salvaPartida(const tPartida *partida, tPontoPartida *ponto, unsigned short corpo[]) {
+    const tFila *cbrCorpo = &partida->cobra.corpo;
+    memset(ponto, 0, sizeof(tPontoPartida));
+    ponto->pontuacao = partida->pontuacao;
+    ponto->hash = partida->hash;
+    ponto->qtdComida = partida->qtdComida;
+    ponto->tamCorpo = adquireTam(cbrCorpo);
+    ponto->estado = partida->estado;
+    ponto->estadoCobra = partida->cobra.estado;
+    ponto->direcaoCabeca = partida->cobra.direcaoCabeca;
+    ponto->devorado = partida->cobra.devorado;
+
+    int i;
+    for (i = 0; i < ponto->tamCorpo; i++) {
+        corpo[i] = consultaElem(cbrCorpo, i);
+    }
+}
+
+int restauraPartida(const tMapa *mapa, tPartida *partida, const tPontoPartida *ponto, const unsigned short corpo[],
+    const unsigned long long consumidos[]) {
+    if (ponto->tamCorpo < 1 || ponto->tamCorpo > partida->cobra.corpo.capacidade) {
+        return 0;
+    }
+
+    partida->cobra.corpo = inicializaFila(partida->cobra.corpo.vet, partida->cobra.corpo.capacidade);
+    int i;
+    for (i = 0; i < ponto->tamCorpo; i++) {
+        // uma posicao fora do tabuleiro nao seria desenhavel
+        if (corpo[i] >= (mapa->nLinhas + 2) * POS_LARGURA || !estaDentroLimite(mapa, corpo[i])) {
+            return 0;
+        }
+        insereFim(&partida->cobra.corpo, corpo[i]);
+    }
+    partida->cobra.direcaoCabeca = ponto->direcaoCabeca;
+    partida->cobra.devorado = ponto->devorado;
+    partida->cobra.estado = ponto->estadoCobra;
+    partida->qtdComida = ponto->qtdComida;
+    partida->pontuacao = ponto->pontuacao;
+    partida->estado = ponto->estado;
+    memset(partida->consumidos, 0, sizeof(partida->consumidos));
+    memcpy(partida->consumidos, consumidos, ((mapa->qtdItens + 63) / 64) * sizeof(unsigned long long));
+    partida->infinito = NULL;
+    partida->hash = calculaHash(mapa, partida);
+
+    return partida->hash == ponto->hash;
+}
+// FIM PARTIDA
+
+// INFINITO
+tInfinito *inicializaInfinito(const tMapa *mapa, unsigned long long semente) {
+    int nCelulas = mapa->nLinhas * mapa->mColunas;
+    tInfinito *infinito = malloc(sizeof(tInfinito));
+    if (infinito != NULL) {
+        infinito->livres = malloc(nCelulas * sizeof(int));
+        infinito->posicaoLivre = malloc(nCelulas * sizeof(int));
+        infinito->comida = calloc(nCelulas, sizeof(char));
+    }
+    if (infinito == NULL || infinito->livres == NULL || infinito->posicaoLivre == NULL || infinito->comida == NULL) {
+        liberaInfinito(infinito);
+        return NULL;
+    }
+
+    infinito->gerador = inicializaAleatorio(semente);
+    infinito->qtdLivres = 0;
+    infinito->renascida = -1;
+
+    int celula;
+    for (celula = 0; celula < nCelulas; celula++) {
+        infinito->posicaoLivre[celula] = -1;
+        if (adquireCel(mapa, inicializaPosicao(celula / mapa->mColunas, celula % mapa->mColunas)) == CEL_VAZIA) {
+            desocupaCelula(infinito, celula);
+        }
+    }
+
+    // a cobra inicial ocupa sua celula
+    const tFila *corpo = &mapa->cobra.corpo;
+    int i;
+    for (i = 0; i < adquireTam(corpo); i++) {
+        tPosicao parte = consultaElem(corpo, i);
+        ocupaCelula(infinito, adquireCelula(mapa, parte));
+    }
+
+    return infinito;
+}
+
+void ocupaCelula(tInfinito *infinito, int celula) {
+    int posicao = infinito->posicaoLivre[celula];
+    if (posicao < 0) {
+        return;
+    }
+
+    // a ultima celula livre assume o lugar da removida
+    int ultima = infinito->livres[--infinito->qtdLivres];
+    infinito->livres[posicao] = ultima;
+    infinito->posicaoLivre[ultima] = posicao;
+    infinito->posicaoLivre[celula] = -1;
+}
+
+void desocupaCelula(tInfinito *infinito, int celula) {
+    if (infinito->posicaoLivre[celula] >= 0) {
+        return;
+    }
+
+    infinito->posicaoLivre[celula] = infinito->qtdLivres;
+    infinito->livres[infinito->qtdLivres++] = celula;
+}
+
+int temComidaRenascida(const tInfinito *infinito, int celula) {
+    return infinito->comida[celula];
+}
+
+void devoraComidaRenascida(tInfinito *infinito, int celula) {
+    infinito->comida[celula] = 0;
+}
+
+int renasceComida(tInfinito *infinito) {
+    infinito->renascida = -1;
+    if (infinito->qtdLivres == 0) {
+        return -1;
+    }
+
+    int celula = infinito->livres[sorteia(&infinito->gerador, infinito->qtdLivres)];
+    ocupaCelula(infinito, celula);
+    infinito->comida[celula] = 1;
+    infinito->renascida = celula;
+
+    return celula;
+}
+
+void liberaInfinito(tInfinito *infinito) {
+    if (infinito == NULL) {
+        return;
+    }
+
+    free(infinito->livres);
+    free(infinito->posicaoLivre);
+    free(infinito->comida);
+    free(infinito);
+}
+// FIM INFINITO
+
+// DIARIO
+tDiario *inicializaDiario() {
+    tDiario *diario = malloc(sizeof(tDiario));
+    if (diario != NULL) {
+        diario->qtd = 0;
+        diario->capacidade = DIA_CAP_INICIAL;
+        diario->registros = malloc(DIA_CAP_INICIAL * sizeof(tRegistro));
+    }
+
+    if (diario == NULL || diario->registros == NULL) {
+        printf("ERRO: Memoria insuficiente para o diario de movimentos\n");
+        exit(EXIT_FAILURE);
+    }
+
+    return diario;
+}
+
+void empilhaRegistro(tDiario *diario, tRegistro registro) {
+    if (diario->qtd == diario->capacidade) {
+        diario->capacidade *= 2;
+        diario->registros = realloc(diario->registros, diario->capacidade * sizeof(tRegistro));
+        if (diario->registros == NULL) {
+            printf("ERRO: Memoria insuficiente para o diario de movimentos\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    diario->registros[diario->qtd++] = registro;
+}
+
+tRegistro desempilhaRegistro(tDiario *diario) {
+    return diario->registros[--diario->qtd];
+}
+
+void liberaDiario(tDiario *diario) {
+    if (diario == NULL) {
+        return;
+    }
+
+    free(diario->registros);
+    free(diario);
+}
+// FIM DIARIO
+
+// MAPA
+tMapa *leMapa(char caminhoBase[]) {
+    char caminhoMapa[TAM_CAMINHO];
+    combinaCaminho(caminhoMapa, caminhoBase, ARQ_MAPA);
+    FILE *arq = fopen(caminhoMapa, "r");
+
+    if (arq == NULL){
+        printf("ERRO: O arquivo de configuração do mapa (%s) nao foi encontrado\n", caminhoMapa);
+        exit(EXIT_FAILURE);
+    }
+
+    tMapa *mapa = leMapaArquivo(arq);
+    fclose(arq);
+
+    if (mapa == NULL) {
+        printf("ERRO: O arquivo de configuração do mapa (%s) e invalido\n", caminhoMapa);
+        exit(EXIT_FAILURE);
+    }
+
+    return mapa;
+}
+
+tMapa *leMapaArquivo(FILE *arq) {
+    int n, m;
+    if (fscanf(arq, "%d %d%*c", &n, &m) != 2 || n <= 0 || n > TAM_MAPA || m <= 0 || m > TAM_MAPA) {
+        return NULL;
+    }
+
+    // as matrizes seguem a struct no mesmo bloco, das de maior alinhamento para as de menor; depois dos itens,
+    // os buffers da cabeca da cobra inicial e dos tuneis
+    size_t qtdPosicoes = (size_t) (n + 2) * POS_LARGURA;
+    size_t qtdCelulas = (size_t) n * m;
+    tMapa *mapa = malloc(sizeof(tMapa) + qtdPosicoes * (2 * sizeof(unsigned long long) + sizeof(int) + sizeof(char))
+        + qtdCelulas * (sizeof(unsigned long long) + sizeof(tPosicao) + sizeof(char)) + (1 + MAP_TUNEIS) * sizeof(tPosicao));
+    if (mapa == NULL) {
+        return NULL;
+    }
+    mapa->chaveCorpo = (unsigned long long *) (mapa + 1);
+    mapa->chaveCabeca = mapa->chaveCorpo + qtdPosicoes;
+    mapa->chaveItem = mapa->chaveCabeca + qtdPosicoes;
+    mapa->itemDaCelula = (int *) (mapa->chaveItem + qtdCelulas);
+    mapa->itens = (tPosicao *) (mapa->itemDaCelula + qtdPosicoes);
+    tPosicao *cabecaInicial = mapa->itens + qtdCelulas;
+    mapa->tuneis = inicializaFila(cabecaInicial + 1, MAP_TUNEIS);
+    mapa->vet = (char *) (cabecaInicial + 1 + MAP_TUNEIS);
+    mapa->itemInalcancavel = mapa->vet + qtdPosicoes;
+    
+    int achouCobra = 0;
+    mapa->nLinhas = n;
+    mapa->mColunas = m;
+    mapa->lado = escolheLado(n, m);
+    mapa->qtdComida = 0;
+    mapa->qtdItens = 0;
+    memset(mapa->vet, CEL_FORA, qtdPosicoes);
+
+    int i;
+    for (i = 0; i < n; i++) {
+        int j;
+        for (j = 0; j < m; j++) {
+            char curr;
+            if (fscanf(arq, "%c", &curr) != 1) {
+                free(mapa);
+                return NULL;
+            }
+            tPosicao pos = inicializaPosicao(i, j);
+            mapa->vet[pos] = curr;
+            mapa->itemDaCelula[pos] = -1;
+
+            if (curr == CEL_VAZIA || curr == CEL_PARED) {
+                continue;
+            }
+
+            switch (curr) {
+                case CEL_CBRCB:
+                case CEL_CBRCC:
+                case CEL_CBRCD:
+                case CEL_CBRCE:
+                    // o mapa guarda apenas o tabuleiro; a cobra fica na tPartida
+                    mapa->cobra = inicializaCobra(cabecaInicial, 1, pos, curr);
+                    mapa->vet[pos] = CEL_VAZIA;
+                    achouCobra = 1;
+                    break;
+
+                case CEL_COMID:
+                    mapa->qtdComida++;
+                    mapa->itemDaCelula[pos] = mapa->qtdItens;
+                    mapa->itens[mapa->qtdItens++] = pos;
+                    break;
+
+                case CEL_DINHR:
+                    mapa->itemDaCelula[pos] = mapa->qtdItens;
+                    mapa->itens[mapa->qtdItens++] = pos;
+                    break;
+
+                case CEL_TUNEL:
+                    // o novo tunel ocupa o lugar do mais antigo
+                    enfileira(&mapa->tuneis, pos);
+                    if (adquireTam(&mapa->tuneis) > MAP_TUNEIS) {
+                        desenfileira(&mapa->tuneis);
+                    }
+                    break;
+            }
+        }
+        fscanf(arq, "%*c");
+    }
+
+    if (!achouCobra) {
+        free(mapa);
+        return NULL;
+    }
+
+    // sorteia as chaves de Zobrist na mesma ordem em toda execucao
+    tAleatorio gerador = inicializaAleatorio(MAP_SEM_ZOBRIST);
+    for (i = 0; i < n; i++) {
+        int j;
+        for (j = 0; j < m; j++) {
+            mapa->chaveCorpo[inicializaPosicao(i, j)] = sorteiaBits(&gerador);
+            mapa->chaveCabeca[inicializaPosicao(i, j)] = sorteiaBits(&gerador);
+        }
+    }
+    for (i = 0; i < 4; i++) {
+        mapa->chaveDirecao[i] = sorteiaBits(&gerador);
+    }
+    for (i = 0; i < mapa->qtdItens; i++) {
+        mapa->chaveItem[i] = sorteiaBits(&gerador);
+    }
+
+    analisaAlcance(mapa);
+    return mapa;
+}
+
+int adquireLinhas(const tMapa *mapa) {
+    return mapa->nLinhas;
+}
+
+int adquireColunas(const tMapa *mapa) {
+    return mapa->mColunas;
+}
+
+const tCobra *adquireCobraInicial(const tMapa *mapa) {
+    return &mapa->cobra;
+}
+
+int adquireQtdComidaInicial(const tMapa *mapa) {
+    return mapa->qtdComida;
+}
+
+char adquireCel(const tMapa *mapa, tPosicao pos) {
+    return mapa->vet[pos];
+}
+
+int adquireItem(const tMapa *mapa, tPosicao pos) {
+    return mapa->itemDaCelula[pos];
+}
+
+int adquireCelula(const tMapa *mapa, tPosicao pos) {
+    return adquireCelulaDimensoes(pos, mapa->mColunas);
+}
+
+__inline__ int adquireCelulaDimensoes(tPosicao pos, unsigned int mColunas) {
+    // com mColunas constante potencia de 2, a multiplicacao vira um deslocamento
+    return adquireI(pos) * mColunas + adquireJ(pos);
+}
+
+tPosicao adquireParTunel(const tMapa *mapa, tPosicao pos) {
+    tPosicao primeiroTunel = adquireElem(&mapa->tuneis, 0);
+    return comparaPos(pos, primeiroTunel) ? adquireElem(&mapa->tuneis, 1) : primeiroTunel;
+}
+
+int estaDentroLimite(const tMapa *mapa, tPosicao pos) {
+    // as bordas e as celulas alem das dimensoes do mapa sao CEL_FORA
+    return adquireCel(mapa, pos) != CEL_FORA;
+}
+
+int ehPosicaoValida(const tMapa *mapa, tPosicao pos) {
+    return estaDentroLimite(mapa, pos) && adquireCel(mapa, pos) != CEL_TUNEL;
+}
+
+tPosicao transformaPosicaoValida(const tMapa *mapa, tPosicao pos, int direcao) {
+    switch (mapa->lado) {
+#define MAP_CASO_TRANSFORMA(L) case L: return transformaPosicao##L(mapa, pos, direcao);
+        MAP_LADOS(MAP_CASO_TRANSFORMA)
+#undef MAP_CASO_TRANSFORMA
+        default:
+            return transformaPosicaoDimensoes(mapa, pos, direcao, mapa->nLinhas, mapa->mColunas);
+    }
+}
+
+__inline__ tPosicao transformaPosicaoDimensoes(const tMapa *mapa, tPosicao pos, int direcao, unsigned int nLinhas, unsigned int mColunas) {
+    while (!ehPosicaoValida(mapa, pos)) {
+        // corrige a posicao para dentro dos limites; a posicao sai no maximo uma celula do mapa, entao
+        // a soma nunca e negativa e o resto sem sinal de uma dimensao constante potencia de 2 e uma mascara
+        pos = inicializaPosicao((nLinhas + adquireI(pos)) % nLinhas, (mColunas + adquireJ(pos)) % mColunas);
+
+        // trata o eventual teleporte da cobra pelos tuneis
+        if (adquireCel(mapa, pos) == CEL_TUNEL) {
+            pos = adquireParTunel(mapa, pos);
+            pos = avancaNaDirecao(pos, direcao);
+        }
+    }
+
+    return pos;
+}
+
+MAP_LADOS(MAP_DEFINE_TRANSFORMA)
+
+void analisaAlcance(tMapa *mapa) {
+    char visitada[(mapa->nLinhas + 2) * POS_LARGURA];
+    tPosicao fila[mapa->nLinhas * mapa->mColunas];
+    memset(visitada, 0, sizeof(visitada));
+
+    int inicio = 0, fim = 0;
+    tPosicao cab = adquireCabeca(&mapa->cobra);
+    visitada[cab] = 1;
+    fila[fim++] = cab;
+    while (inicio < fim) {
+        tPosicao pos = fila[inicio++];
+        int direcao;
+        for (direcao = 0; direcao < 4; direcao++) {
+            tPosicao dest = transformaPosicaoValida(mapa, avancaNaDirecao(pos, direcao), direcao);
+            if (!visitada[dest] && adquireCel(mapa, dest) != CEL_PARED) {
+                visitada[dest] = 1;
+                fila[fim++] = dest;
+            }
+        }
+    }
+
+    mapa->qtdComidaInalcancavel = 0;
+    int k;
+    for (k = 0; k < mapa->qtdItens; k++) {
+        tPosicao item = mapa->itens[k];
+        mapa->itemInalcancavel[k] = adquireCel(mapa, item) == CEL_COMID && !visitada[item];
+        mapa->qtdComidaInalcancavel += mapa->itemInalcancavel[k];
+    }
+}
+
+int escolheLado(int nLinhas, int mColunas) {
+    // sempre termina em 0, o motor generico, mesmo sem variantes
+#define MAP_ITEM_LADO(L) L,
+    static const int lados[] = { MAP_LADOS(MAP_ITEM_LADO) 0 };
+#undef MAP_ITEM_LADO
+    int k;
+    for (k = 0; lados[k] != 0; k++) {
+        if (nLinhas == lados[k] && mColunas == lados[k]) {
+            break;
+        }
+    }
+
+    return lados[k];
+}
+
+int giraDirecao(int direcao, char movimento) {
+    // delta da direcao
+    int dD = 0;
+    if (movimento == MOV_CBRHO)
+        dD = 1;
+    else if (movimento == MOV_CBRAH)
+        dD= -1;
+
+    return (4 + direcao + dD) % 4;
+}
+
+int exportaHeatmap(int nLinhas, int mColunas, const tHeatmap *heatmap, char caminhoBase[]) {
+    char caminhoHeatmap[TAM_CAMINHO];
+    combinaCaminho(caminhoHeatmap, caminhoBase, ARQ_HMAP);
+    FILE *arq = fopen(caminhoHeatmap, "w");
+    if (arq == NULL) {
+        return -1;
+    }
+    escreveHeatmap(arq, nLinhas, mColunas, heatmap);
+    fclose(arq);
+    return 0;
+}
+
+void escreveHeatmap(FILE *arq, int nLinhas, int mColunas, const tHeatmap *heatmap) {
+    int i;
+    for (i = 0; i < nLinhas; i++) {
+        int j;
+        for (j = 0; j < mColunas; j++) {
+            fprintf(arq, "%lld", adquireAcessos(heatmap, i * mColunas + j));
+            if (j < mColunas - 1)
+                fprintf(arq, "%c", ' ');
+        }
+        fprintf(arq, "%c", '\n');
+    }
+}
+
+int exportaRanking(int nLinhas, int mColunas, const tHeatmap *heatmap, char caminhoBase[]) {
+    char caminhoRank[TAM_CAMINHO];
+    combinaCaminho(caminhoRank, caminhoBase, ARQ_RANK);
+    FILE *arq = fopen(caminhoRank, "w");
+    if (arq == NULL) {
+        return -1;
+    }
+    escreveRanking(arq, nLinhas, mColunas, heatmap);
+    fclose(arq);
+    return 0;
+}
+
+void escreveRanking(FILE *arq, int nLinhas, int mColunas, const tHeatmap *heatmap) {
+    tRank ranking[nLinhas * mColunas];
+    int tam = 0;
+    
+    // planifica heatmap
+    int i;
+    for (i = 0; i < nLinhas; i++) {
+        int j;
+        for (j = 0; j < mColunas; j++)
+            if (adquireAcessos(heatmap, i * mColunas + j) > 0)
+                ranking[tam++] = inicializaRank(inicializaPosicao(i, j), adquireAcessos(heatmap, i * mColunas + j));
+    }
+
+    ordenaRanking(ranking, 0, tam - 1);
+
+    // exporta
+    for (i = 0; i < tam; i++) {
+        tRank curr = ranking[i];
+        tPosicao currPos = adquirePosicao(curr);
+        fprintf(arq, "(%d, %d) - %lld\n", adquireI(currPos), adquireJ(currPos), adquireHeat(curr));
+    }
+}
+// FIM MAPA
+
+// ALEATORIO
+tAleatorio inicializaAleatorio(unsigned long long semente) {
+    // espalha a semente com o splitmix64, garantindo um estado nao nulo
+    unsigned long long z = semente + 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    z ^= z >> 31;
+
+    tAleatorio gerador = { z != 0 ? z : 1 };
+    return gerador;
+}
+
+unsigned long long sorteiaBits(tAleatorio *gerador) {
+    unsigned long long x = gerador->estado;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    gerador->estado = x;
+    return x * 0x2545F4914F6CDD1DULL;
+}
+
+int sorteia(tAleatorio *gerador, int limite) {
+    // usa os 32 bits mais altos, os de melhor qualidade
+    return (int)(((sorteiaBits(gerador) >> 32) * (unsigned long long)limite) >> 32);
+}
+// FIM ALEATORIO
+
+// INTEGRAL
+tIntegral *inicializaIntegral(int nLinhas, int mColunas, const tHeatmap *heatmap) {
+    tIntegral *integral = malloc(sizeof(tIntegral));
+    long long *somas = malloc((size_t)(nLinhas + 1) * (mColunas + 1) * sizeof(long long));
+    if (integral == NULL || somas == NULL) {
+        free(integral);
+        free(somas);
+        return NULL;
+    }
+
+    integral->nLinhas = nLinhas;
+    integral->mColunas = mColunas;
+    integral->somas = somas;
+    constroiIntegral(integral, heatmap);
+
+    return integral;
+}
+
+void constroiIntegral(tIntegral *integral, const tHeatmap *heatmap) {
+    int mColunas = integral->mColunas;
+    int largura = mColunas + 1;
+    long long *acima = integral->somas;
+    memset(acima, 0, largura * sizeof(long long));
+
+    int i;
+    for (i = 0; i < integral->nLinhas; i++) {
+        long long *linha = acima + largura;
+
+        // so a soma acumulada da linha depende da coluna anterior; a linha de cima e somada de duas em duas colunas
+        long long acumulado = 0;
+        int j;
+        linha[0] = 0;
+        for (j = 0; j < mColunas; j++) {
+            acumulado += adquireAcessos(heatmap, i * mColunas + j);
+            linha[j + 1] = acumulado;
+        }
+        for (j = 1; j + 2 <= largura; j += 2) {
+            tParSomas par, parAcima;
+            memcpy(&par, linha + j, sizeof(par));
+            memcpy(&parAcima, acima + j, sizeof(parAcima));
+            par += parAcima;
+            memcpy(linha + j, &par, sizeof(par));
+        }
+        for (; j < largura; j++) {
+            linha[j] += acima[j];
+        }
+
+        acima = linha;
+    }
+}
+
+long long somaRegiao(const tIntegral *integral, int i1, int j1, int i2, int j2) {
+    // recorta o retangulo ao heatmap
+    if (i1 < 0) {
+        i1 = 0;
+    }
+    if (j1 < 0) {
+        j1 = 0;
+    }
+    if (i2 >= integral->nLinhas) {
+        i2 = integral->nLinhas - 1;
     }
-
-    jogo.mapa = atualizaMapa(jogo.mapa);
-
-    // atualiza o estado do jogo
-    if (adquireEstado(cbr) == CBR_EST_M) {
-        jogo.estado = JOG_EST_D;
+    if (j2 >= integral->mColunas) {
+        j2 = integral->mColunas - 1;
     }
-    else if (adquireQtdComida(jogo.mapa) == 0) {
-        jogo.estado = JOG_EST_V;
+    if (i1 > i2 || j1 > j2) {
+        return 0;
     }
 
-    jogo.estatisticas = atualizaEstatisticas(jogo.estatisticas, cbr);
-    exportaResumo(jogo, adquireQtdMovimentos(jogo.estatisticas), cbr, movimento);
-
-    return jogo;
+    int largura = integral->mColunas + 1;
+    const long long *somas = integral->somas;
+    return somas[(i2 + 1) * largura + j2 + 1] - somas[i1 * largura + j2 + 1] - somas[(i2 + 1) * largura + j1] + somas[i1 * largura + j1];
 }
 
-void exportaResumo(tJogo jogo, int currMov, tCobra cobra, char movimento) {
-    char devorado = adquireDevorado(cobra);
+tRegiao *leRegioes(const char caminho[], int *qtd) {
+    FILE *arq = fopen(caminho, "r");
+    if (arq == NULL) {
+        printf("ERRO: O arquivo de regioes (%s) nao foi encontrado\n", caminho);
+        exit(EXIT_FAILURE);
+    }
 
-    // interrompe a exportacao se nao houver nenhum evento relevante
-    if (devorado != CEL_DINHR && devorado != CEL_COMID && adquireEstado(cobra) == CBR_EST_V) {
-        return;
+    int capacidade = 16;
+    tRegiao *regioes = malloc(capacidade * sizeof(tRegiao));
+    if (regioes == NULL) {
+        printf("ERRO: Memoria insuficiente para as regioes\n");
+        exit(EXIT_FAILURE);
     }
 
-    char caminhoResm[TAM_CAMINHO];
-    combinaCaminho(caminhoResm, jogo.caminhoSaida, ARQ_RESM);
-    FILE *arq = fopen(caminhoResm, "a");
+    *qtd = 0;
+    tRegiao regiao;
+    int lidos;
+    while ((lidos = fscanf(arq, "%d %d %d %d", &regiao.i1, &regiao.j1, &regiao.i2, &regiao.j2)) == 4) {
+        if (regiao.i1 < 0 || regiao.j1 < 0 || regiao.i1 > regiao.i2 || regiao.j1 > regiao.j2) {
+            printf("ERRO: O arquivo de regioes (%s) tem um retangulo invalido (%d %d %d %d)\n", caminho, regiao.i1, regiao.j1,
+                   regiao.i2, regiao.j2);
+            exit(EXIT_FAILURE);
+        }
 
-    fprintf(arq, "Movimento %d (%c) ", currMov, movimento);
-    if (devorado == CEL_DINHR) {
-        fprintf(arq, "gerou dinheiro");
+        if (*qtd == capacidade) {
+            capacidade *= 2;
+            tRegiao *maior = realloc(regioes, capacidade * sizeof(tRegiao));
+            if (maior == NULL) {
+                printf("ERRO: Memoria insuficiente para as regioes\n");
+                exit(EXIT_FAILURE);
+            }
+            regioes = maior;
+        }
+        regioes[(*qtd)++] = regiao;
     }
-    else if (devorado == CEL_COMID) {
-        fprintf(arq, "fez a cobra crescer para o tamanho %d", adquireTamanho(cobra));
+    fclose(arq);
 
-        if (jogo.estado == JOG_EST_V) {
-            fprintf(arq, ", terminando o jogo");
-        }        
-    }
-    else {
-        fprintf(arq, "resultou no fim de jogo por conta de colisao");
+    if (lidos != EOF) {
+        printf("ERRO: O arquivo de regioes (%s) e invalido\n", caminho);
+        exit(EXIT_FAILURE);
     }
-    fprintf(arq, "%c", '\n');
-    
-    fclose(arq);
-}
 
-void exportaInicializacao(tJogo jogo) {
-    char caminhoInic[TAM_CAMINHO];
-    combinaCaminho(caminhoInic, jogo.caminhoSaida, ARQ_INIC);
-    FILE *arq = fopen(caminhoInic, "w");
+    return regioes;
+}
 
-    int i;
-    for (i = 0; i < adquireLinhas(jogo.mapa); i++) {
-        int j;
-        for (j = 0; j < adquireColunas(jogo.mapa); j++) {
-            fprintf(arq, "%c", adquireCel(jogo.mapa, inicializaPosicao(i, j)));
-        }
-        fprintf(arq, "%c", '\n');
+void exportaRegioes(int nLinhas, int mColunas, const tHeatmap *heatmap, const tRegiao regioes[], int qtd, char caminhoSaida[]) {
+    char caminhoRegioes[TAM_CAMINHO];
+    combinaCaminho(caminhoRegioes, caminhoSaida, ARQ_REGI);
+    FILE *arq = fopen(caminhoRegioes, "w");
+    if (arq == NULL) {
+        printf("ERRO: Nao foi possivel criar o relatorio de regioes (%s)\n", caminhoRegioes);
+        exit(EXIT_FAILURE);
     }
-    tPosicao cbr = adquireCabeca(adquireCobra(jogo.mapa));
-    fprintf(arq, "A cobra comecara o jogo na linha %d e coluna %d\n", adquireI(cbr) + 1, adquireJ(cbr) + 1);
 
+    tIntegral *integral = inicializaIntegral(nLinhas, mColunas, heatmap);
+    if (integral == NULL) {
+        printf("ERRO: Memoria insuficiente para a tabela de somas\n");
+        exit(EXIT_FAILURE);
+    }
+    escreveRegioes(arq, integral, regioes, qtd);
+    liberaIntegral(integral);
     fclose(arq);
 }
 
-void exportaJogo(tJogo jogo) {
-    exportaEstatisticas(jogo.estatisticas, jogo.caminhoSaida);
-    exportaHeatmap(jogo.mapa, jogo.caminhoSaida);
-    exportaRanking(jogo.mapa, jogo.caminhoSaida);
+void escreveRegioes(FILE *arq, const tIntegral *integral, const tRegiao regioes[], int qtd) {
+    int k;
+    for (k = 0; k < qtd; k++) {
+        fprintf(arq, "(%d, %d) ate (%d, %d) - %lld\n", regioes[k].i1, regioes[k].j1, regioes[k].i2, regioes[k].j2,
+                somaRegiao(integral, regioes[k].i1, regioes[k].j1, regioes[k].i2, regioes[k].j2));
+    }
 }
 
-void imprimeJogo(tJogo jogo) {
-    imprimeMapa(jogo.mapa);
-    printf("Pontuacao: %d\n", jogo.pontuacao);
-
-    if (!acabou(jogo)) {
+void liberaIntegral(tIntegral *integral) {
+    if (integral == NULL) {
         return;
     }
 
-    switch (jogo.estado) {
-        case JOG_EST_V:
-            printf("%s", "Voce venceu!\n");
-            break;
-        
-        case JOG_EST_D:
-            printf("%s", "Game over!\n");
-            break;
-    }
-
-    printf("Pontuacao final: %d\n", jogo.pontuacao);
-}
-// FIM JOGO
-
-// ESTATISTICAS
-tEstatisticas inicializaEstatisticas() {
-    tEstatisticas estatisticas = { 0, 0, 0, 0, 0, 0 };
-    return estatisticas;
-}
-
-int adquireQtdMovimentos(tEstatisticas estatisticas) {
-    return estatisticas.qtdMov;
+    free(integral->somas);
+    free(integral);
 }
+// FIM INTEGRAL
 
-tEstatisticas atualizaEstatisticas(tEstatisticas estatisticas, tCobra cobra) {
-    estatisticas.qtdMov++;
-    switch (adquireDirecao(cobra)) {
-        case CBR_DIR_N:
-            estatisticas.qtdMovC++;
-            break;
+// HEATMAP
+tHeatmap *inicializaHeatmap(int nCelulas) {
+    tHeatmap *heatmap = malloc(sizeof(tHeatmap));
+    if (heatmap != NULL) {
+        heatmap->estreitos = calloc(nCelulas, sizeof(unsigned int));
+    }
+    if (heatmap == NULL || heatmap->estreitos == NULL) {
+        free(heatmap);
+        return NULL;
+    }
 
-        case CBR_DIR_L:
-            estatisticas.qtdMovD++;
-            break;
+    heatmap->nCelulas = nCelulas;
+    heatmap->largos = NULL;
+    heatmap->vivo = NULL;
+    heatmap->incompleto = 0;
 
-        case CBR_DIR_S:
-            estatisticas.qtdMovB++;
-            break;
+    return heatmap;
+}
 
-        case CBR_DIR_O:
-            estatisticas.qtdMovE++;
-            break;
+int mapeiaHeatmap(tHeatmap *heatmap, const char caminho[], int nLinhas, int mColunas) {
+    size_t tamanho = sizeof(tCabecalhoVivo) + heatmap->nCelulas * sizeof(unsigned long long);
+    int fd = open(caminho, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        return -1;
     }
-    
-    char devorado = adquireDevorado(cobra);
-    if (devorado != CEL_COMID && devorado != CEL_DINHR) {
-        estatisticas.qtdNPntMov++;
+    if (ftruncate(fd, tamanho) != 0) {
+        close(fd);
+        return -1;
+    }
+    void *arquivo = mmap(NULL, tamanho, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    // o mapeamento continua valido sem o descritor
+    close(fd);
+    if (arquivo == MAP_FAILED) {
+        return -1;
     }
 
-    return estatisticas;
+    tCabecalhoVivo *vivo = arquivo;
+    unsigned long long *contadores = (unsigned long long *) (vivo + 1);
+    int i;
+    for (i = 0; i < heatmap->nCelulas; i++) {
+        contadores[i] = adquireAcessos(heatmap, i);
+    }
+    memcpy(vivo->assinatura, HMV_ASSN, sizeof(vivo->assinatura));
+    vivo->nLinhas = nLinhas;
+    vivo->mColunas = mColunas;
+    vivo->qtdMov = 0;
+
+    free(heatmap->estreitos);
+    free(heatmap->largos);
+    heatmap->estreitos = NULL;
+    heatmap->largos = contadores;
+    heatmap->vivo = vivo;
+
+    return 0;
 }
 
-void exportaEstatisticas(tEstatisticas estatisticas, char caminhoBase[]) {
-    char caminhoStts[TAM_CAMINHO];
-    combinaCaminho(caminhoStts, caminhoBase, ARQ_STTS);
-    FILE *arq = fopen(caminhoStts, "w");
-
-    fprintf(arq, "Numero de movimentos: %d\n", estatisticas.qtdMov);
-    fprintf(arq, "Numero de movimentos sem pontuar: %d\n", estatisticas.qtdNPntMov);
-    fprintf(arq, "Numero de movimentos para baixo: %d\n", estatisticas.qtdMovB);
-    fprintf(arq, "Numero de movimentos para cima: %d\n", estatisticas.qtdMovC);
-    fprintf(arq, "Numero de movimentos para esquerda: %d\n", estatisticas.qtdMovE);
-    fprintf(arq, "Numero de movimentos para direita: %d\n", estatisticas.qtdMovD);
-
-    fclose(arq);
+void publicaMovimentos(tHeatmap *heatmap, long long qtdMov) {
+    if (heatmap->vivo != NULL) {
+        heatmap->vivo->qtdMov = qtdMov;
+    }
 }
-// FIM ESTATISTICAS
-
-// MAPA
-tMapa leMapa(char caminhoBase[]) {
-    char caminhoMapa[TAM_CAMINHO];
-    combinaCaminho(caminhoMapa, caminhoBase, ARQ_MAPA);
-    FILE *arq = fopen(caminhoMapa, "r");
 
-    if (arq == NULL){
-        printf("ERRO: O arquivo de configuração do mapa (%s) nao foi encontrado\n", caminhoMapa);
-        exit(EXIT_FAILURE);
+tHeatmap *clonaHeatmap(const tHeatmap *origem) {
+    tHeatmap *heatmap = malloc(sizeof(tHeatmap));
+    if (heatmap != NULL) {
+        *heatmap = *origem;
+        heatmap->vivo = NULL;
+        if (origem->largos != NULL) {
+            heatmap->largos = malloc(origem->nCelulas * sizeof(unsigned long long));
+        }
+        else {
+            heatmap->estreitos = malloc(origem->nCelulas * sizeof(unsigned int));
+        }
+    }
+    if (heatmap == NULL || (heatmap->largos == NULL && heatmap->estreitos == NULL)) {
+        free(heatmap);
+        return NULL;
     }
-    
-    int n, m;
-    fscanf(arq, "%d %d%*c", &n, &m);
-    tMapa mapa = { n, m };
-    mapa.qtdComida = 0;
-    mapa.tuneis = inicializaFila();
-
-    int i;
-    for (i = 0; i < n; i++) {
-        int j;
-        for (j = 0; j < m; j++) {
-            char curr;
-            fscanf(arq, "%c", &curr);
-            mapa.vet[i][j] = curr;
-            mapa.heatmap[i][j] = 0;
-
-            if (curr == CEL_VAZIA || curr == CEL_PARED) {
-                continue;
-            }
 
-            switch (curr) {
-                case CEL_CBRCB:
-                case CEL_CBRCC:
-                case CEL_CBRCD:
-                case CEL_CBRCE:
-                    mapa.cobra = inicializaCobra(inicializaPosicao(i, j), curr);
-                    mapa.heatmap[i][j] = 1;
-                    break;
+    if (origem->largos != NULL) {
+        memcpy(heatmap->largos, origem->largos, origem->nCelulas * sizeof(unsigned long long));
+    }
+    else {
+        memcpy(heatmap->estreitos, origem->estreitos, origem->nCelulas * sizeof(unsigned int));
+    }
 
-                case CEL_COMID:
-                    mapa.qtdComida++;
-                    break;
+    return heatmap;
+}
 
-                case CEL_TUNEL:
-                    mapa.tuneis = enfileira(mapa.tuneis, inicializaPosicao(i, j));
-                    break;
-            }
+void incrementaHeatmap(tHeatmap *heatmap, int celula) {
+    if (heatmap->largos == NULL) {
+        if (heatmap->estreitos[celula] < UINT_MAX) {
+            heatmap->estreitos[celula]++;
+            return;
+        }
+        if (alargaHeatmap(heatmap) != 0) {
+            return;
         }
-        fscanf(arq, "%*c");
     }
-    fclose(arq);
-
-    return mapa;
-}
 
-int adquireLinhas(tMapa mapa) {
-    return mapa.nLinhas;
+    heatmap->largos[celula]++;
 }
 
-int adquireColunas(tMapa mapa) {
-    return mapa.mColunas;
+void decrementaHeatmap(tHeatmap *heatmap, int celula) {
+    if (heatmap->largos == NULL) {
+        heatmap->estreitos[celula]--;
+    }
+    else {
+        heatmap->largos[celula]--;
+    }
 }
 
-tCobra adquireCobra(tMapa mapa) {
-    return mapa.cobra;
-}
+long long adquireAcessos(const tHeatmap *heatmap, int celula) {
+    if (heatmap->largos == NULL) {
+        return heatmap->estreitos[celula];
+    }
 
-int adquireQtdComida(tMapa mapa) {
-    return mapa.qtdComida;
+    return heatmap->largos[celula];
 }
 
-char adquireCel(tMapa mapa, tPosicao pos) {
-    return mapa.vet[pos.i][pos.j];
-}
+void somaAcessos(tHeatmap *heatmap, int celula, long long qtd) {
+    if (heatmap->largos == NULL) {
+        if ((unsigned long long)qtd <= UINT_MAX - heatmap->estreitos[celula]) {
+            heatmap->estreitos[celula] += (unsigned int)qtd;
+            return;
+        }
+        if (alargaHeatmap(heatmap) != 0) {
+            heatmap->estreitos[celula] = UINT_MAX;
+            return;
+        }
+    }
 
-tMapa defineCel(tMapa mapa, tPosicao pos, char cel) {
-    mapa.vet[pos.i][pos.j] = cel;
-    return mapa;
+    heatmap->largos[celula] += qtd;
 }
 
-tPosicao adquireParTunel(tMapa mapa, tPosicao pos) {
-    tPosicao primeiroTunel = adquireElem(mapa.tuneis, 0);
-    return comparaPos(pos, primeiroTunel) ? adquireElem(mapa.tuneis, 1) : primeiroTunel;
-}
+int alargaHeatmap(tHeatmap *heatmap) {
+    heatmap->largos = malloc(heatmap->nCelulas * sizeof(unsigned long long));
+    if (heatmap->largos == NULL) {
+        heatmap->incompleto = 1;
+        return -1;
+    }
 
-int estaDentroLimite(tMapa mapa, tPosicao pos) {
-    return pos.i >= 0
-        && pos.i < mapa.nLinhas
-        && pos.j >= 0
-        && pos.j < mapa.mColunas;
+    int i;
+    for (i = 0; i < heatmap->nCelulas; i++) {
+        heatmap->largos[i] = heatmap->estreitos[i];
+    }
+    free(heatmap->estreitos);
+    heatmap->estreitos = NULL;
+    return 0;
 }
 
-int ehPosicaoValida(tMapa mapa, tPosicao pos) {
-    return estaDentroLimite(mapa, pos) && adquireCel(mapa, pos) != CEL_TUNEL;
-}
+void liberaHeatmap(tHeatmap *heatmap) {
+    if (heatmap == NULL) {
+        return;
+    }
 
-tPosicao transformaPosicaoValida(tMapa mapa, tPosicao pos) {
-    if (ehPosicaoValida(mapa, pos)) {
-        return pos;
+    free(heatmap->estreitos);
+    if (heatmap->vivo != NULL) {
+        munmap(heatmap->vivo, sizeof(tCabecalhoVivo) + heatmap->nCelulas * sizeof(unsigned long long));
     }
-    
-    // corrige a posicao para dentro dos limites
-    pos = inicializaPosicao(abs((mapa.nLinhas + adquireI(pos)) % mapa.nLinhas), abs((mapa.mColunas + adquireJ(pos)) % mapa.mColunas));
-    
-    // trata o eventual teleporte da cobra pelos tuneis
-    if (adquireCel(mapa, pos) == CEL_TUNEL) {
-        pos = adquireParTunel(mapa, pos);
-        int direcao = adquireDirecao(mapa.cobra);
-        
-        pos = avancaNaDirecao(pos, direcao);
+    else {
+        free(heatmap->largos);
     }
-
-    // faz uma chamada recursiva para a funcao
-    return transformaPosicaoValida(mapa, pos);
+    free(heatmap);
 }
+// FIM HEATMAP
+
+// SUJAS
+tSujas *inicializaSujas(int nCelulas) {
+    tSujas *sujas = malloc(sizeof(tSujas));
+    if (sujas != NULL) {
+        sujas->celulas = malloc(nCelulas * sizeof(int));
+        sujas->incrementos = calloc(nCelulas, sizeof(int));
+    }
 
-tMapa fazMovimento(tMapa mapa, char movimento) {
-    // delta da direcao
-    int dD = 0;
-    if (movimento == MOV_CBRHO)
-        dD = 1;
-    else if (movimento == MOV_CBRAH)
-        dD= -1;
-
-    mapa.cobra = defineDirecao(mapa.cobra, (4 + adquireDirecao(mapa.cobra) + dD) % 4);
+    if (sujas == NULL || sujas->celulas == NULL || sujas->incrementos == NULL) {
+        liberaSujas(sujas);
+        return NULL;
+    }
 
-    int direcao = adquireDirecao(mapa.cobra);
-    tPosicao posDest = adquireCabeca(mapa.cobra);
-    posDest = avancaNaDirecao(posDest, direcao);
+    sujas->qtd = 0;
+    return sujas;
+}
 
-    posDest = transformaPosicaoValida(mapa, posDest);
-    
-    // atualiza a qtd de comida no mapa
-    char cbrDevorou = adquireCel(mapa, posDest);
-    if (cbrDevorou == CEL_COMID) {
-        mapa.qtdComida--;
+void marcaSuja(tSujas *sujas, int celula) {
+    // toda celula suja foi incrementada ao menos uma vez,
+    // logo um incremento nulo indica que ela ainda nao esta na lista
+    if (sujas->incrementos[celula] == 0) {
+        sujas->celulas[sujas->qtd++] = celula;
     }
-    mapa.cobra = moveCbr(mapa.cobra, posDest, cbrDevorou);
-    // atualiza o heatmap
-    mapa.heatmap[adquireI(posDest)][adquireJ(posDest)] += 1;
-    return mapa;
+    sujas->incrementos[celula]++;
 }
 
-tMapa limpaMapa(tMapa mapa) {
-    tFila cbrCorpo = adquireCorpo(mapa.cobra);
-    int i;
-    for (i = adquireTam(cbrCorpo) - 1; i >= 0; i--) {
-        // posicao do pedaco do corpo da cobra
-        tPosicao curr = adquireElem(cbrCorpo, i);
-        mapa = defineCel(mapa, curr, CEL_VAZIA);
-    }
-    return mapa;
+int comparaIncremento(const void *inc1, const void *inc2) {
+    return ((const tIncremento *)inc1)->celula - ((const tIncremento *)inc2)->celula;
 }
 
-tMapa atualizaMapa(tMapa mapa) {    
-    tFila cbrCorpo = adquireCorpo(mapa.cobra);
-    // atualiza o corpo da cobra, nao a cabeca
-    int i;
-    for (i = adquireTam(cbrCorpo) - 1; i >= 0; i--) {
-        // posicao do pedaco do corpo da cobra
-        tPosicao curr = adquireElem(cbrCorpo, i);
-        // caractere da celula que representa o pedaco do corpo da cobra
-        char cbrCh = adquireEstado(mapa.cobra) == CBR_EST_V ? CEL_CBRCO : CEL_CBRCM;
-        mapa = defineCel(mapa, curr, cbrCh);
-    }
-    // atualiza a cabeca da cobra
-    if (adquireEstado(mapa.cobra) == CBR_EST_V) {
-        tPosicao curr = adquireCabeca(mapa.cobra);
-        char cbrCh;
-        switch (adquireDirecao(mapa.cobra)){
-            case CBR_DIR_N:
-                cbrCh = CEL_CBRCC;
-                break;
+int escreveSnapshot(tSujas *sujas, FILE *arq, long long movimento) {
+    tIncremento *incrementos = malloc((sujas->qtd + 1) * sizeof(tIncremento));
+    if (incrementos == NULL) {
+        return -1;
+    }
 
-            case CBR_DIR_L:
-                cbrCh = CEL_CBRCD;
-                break;
+    int qtd = extraiIncrementos(sujas, incrementos);
+    escreveIncrementos(arq, movimento, incrementos, qtd);
 
-            case CBR_DIR_S:
-                cbrCh = CEL_CBRCB;
-                break;
+    free(incrementos);
+    return 0;
+}
 
-            case CBR_DIR_O:
-                cbrCh = CEL_CBRCE;
-                break;
-        }
-        mapa = defineCel(mapa, curr, cbrCh);
+int extraiIncrementos(tSujas *sujas, tIncremento destino[]) {
+    int qtd = sujas->qtd;
+    int i;
+    for (i = 0; i < qtd; i++) {
+        int celula = sujas->celulas[i];
+        destino[i].celula = celula;
+        destino[i].incremento = sujas->incrementos[celula];
+        sujas->incrementos[celula] = 0;
     }
+    sujas->qtd = 0;
 
-    return mapa;
+    return qtd;
 }
 
-void exportaHeatmap(tMapa mapa, char caminhoBase[]) {
-    char caminhoHeatmap[TAM_CAMINHO];
-    combinaCaminho(caminhoHeatmap, caminhoBase, ARQ_HMAP);
-    FILE *arq = fopen(caminhoHeatmap, "w");
+void escreveIncrementos(FILE *arq, long long movimento, tIncremento incrementos[], int qtd) {
+    // ordena as celulas para que as distancias entre elas ocupem poucos bytes
+    qsort(incrementos, qtd, sizeof(tIncremento), comparaIncremento);
 
+    escreveVarint(arq, movimento);
+    escreveVarint(arq, qtd);
+
+    int anterior = 0;
     int i;
-    for (i = 0; i < mapa.nLinhas; i++) {
-        int j;
-        for (j = 0; j < mapa.mColunas; j++) {
-            fprintf(arq, "%d", mapa.heatmap[i][j]);
-            if (j < mapa.mColunas - 1)
-                fprintf(arq, "%c", ' ');
-        }
-        fprintf(arq, "%c", '\n');
+    for (i = 0; i < qtd; i++) {
+        escreveVarint(arq, incrementos[i].celula - anterior);
+        escreveVarint(arq, incrementos[i].incremento);
+        anterior = incrementos[i].celula;
     }
-
-    fclose(arq);
 }
 
-void exportaRanking(tMapa mapa, char caminhoBase[]) {
-    tRank ranking[mapa.nLinhas * mapa.mColunas];
-    int tam = 0;
-    
-    // planifica heatmap
-    int i;
-    for (i = 0; i < mapa.nLinhas; i++) {
-        int j;
-        for (j = 0; j < mapa.mColunas; j++)
-            if (mapa.heatmap[i][j] > 0)
-                ranking[tam++] = inicializaRank(inicializaPosicao(i, j), mapa.heatmap[i][j]);
+void liberaSujas(tSujas *sujas) {
+    if (sujas == NULL) {
+        return;
     }
 
-    ordenaRanking(ranking, 0, tam - 1);
+    free(sujas->celulas);
+    free(sujas->incrementos);
+    free(sujas);
+}
 
-    // exporta
-    char caminhoRank[TAM_CAMINHO];
-    combinaCaminho(caminhoRank, caminhoBase, ARQ_RANK);
-    FILE *arq = fopen(caminhoRank, "w");
-    for (i = 0; i < tam; i++) {
-        tRank curr = ranking[i];
-        tPosicao currPos = adquirePosicao(curr);
-        fprintf(arq, "(%d, %d) - %d\n", adquireI(currPos), adquireJ(currPos), adquireHeat(curr));
+void escreveVarint(FILE *arq, unsigned long valor) {
+    // 7 bits por byte, com o bit mais significativo indicando continuacao
+    while (valor >= 0x80) {
+        fputc((int)(valor & 0x7F) | 0x80, arq);
+        valor >>= 7;
     }
+    fputc((int)valor, arq);
+}
 
-    fclose(arq);
+int leVarint(const unsigned char **dados, const unsigned char *fim, unsigned long *valor) {
+    const unsigned char *p = *dados;
+    unsigned long lido = 0;
+    int desloc;
+    for (desloc = 0; p < fim && desloc < 64; desloc += 7) {
+        lido |= (unsigned long)(*p & 0x7F) << desloc;
+        if ((*p++ & 0x80) == 0) {
+            *dados = p;
+            *valor = lido;
+            return 0;
+        }
+    }
+    return -1;
 }
 
-void imprimeMapa(tMapa mapa) {
+void acumulaSujas(tSujas *sujas, long long acumulado[]) {
     int i;
-    for (i = 0; i < mapa.nLinhas; i++) {
-        int j;
-        for (j = 0; j < mapa.mColunas; j++) {
-            printf("%c", mapa.vet[i][j]);
-        }
-        printf("%c", '\n');
+    for (i = 0; i < sujas->qtd; i++) {
+        int celula = sujas->celulas[i];
+        acumulado[celula] += sujas->incrementos[celula];
+        sujas->incrementos[celula] = 0;
     }
+    sujas->qtd = 0;
 }
-// FIM MAPA
+// FIM SUJAS
 
 // COBRA
-tCobra inicializaCobra(tPosicao posCab, char direcaoInicial) {
+tCobra inicializaCobra(tPosicao corpo[], int capacidade, tPosicao posCab, char direcaoInicial) {
     tCobra cobra;
-    cobra.corpo = inicializaFila();
-    cobra.corpo = enfileira(cobra.corpo, posCab);
+    cobra.corpo = inicializaFila(corpo, capacidade);
+    enfileira(&cobra.corpo, posCab);
 
     // transforma a representacao da cabeca da cobra, em char,
     // na sua respectiva representacao no formato CBR_DIR
@@ -1249,103 +9024,131 @@ tCobra inicializaCobra(tPosicao posCab, char direcaoInicial) {
     return cobra;
 }
 
-tPosicao adquireCabeca(tCobra cobra) {
-    return adquireElem(cobra.corpo, 0);
+tPosicao adquireCabeca(const tCobra *cobra) {
+    return consultaElem(&cobra->corpo, 0);
 }
 
-tFila adquireCorpo(tCobra cobra) {
-    return cobra.corpo;
+const tFila *adquireCorpo(const tCobra *cobra) {
+    return &cobra->corpo;
 }
 
-int adquireDirecao(tCobra cobra) {
-    return cobra.direcaoCabeca;
+int adquireDirecao(const tCobra *cobra) {
+    return cobra->direcaoCabeca;
 }
 
-tCobra defineDirecao(tCobra cobra, int direcao) {
-    cobra.direcaoCabeca = direcao;
-    return cobra;
+void defineDirecao(tCobra *cobra, int direcao) {
+    cobra->direcaoCabeca = direcao;
 }
 
-char adquireDevorado(tCobra cobra) {
-    return cobra.devorado;
+char adquireDevorado(const tCobra *cobra) {
+    return cobra->devorado;
 }
 
-int adquireEstado(tCobra cobra) {
-    return cobra.estado;
+int adquireEstado(const tCobra *cobra) {
+    return cobra->estado;
 }
 
-tCobra defineEstado(tCobra cobra, int estado) {
-    cobra.estado = estado;
-    return cobra;
+void defineEstado(tCobra *cobra, int estado) {
+    cobra->estado = estado;
 }
 
-int adquireTamanho(tCobra cobra) {
-    return adquireTam(cobra.corpo);
+int adquireTamanho(const tCobra *cobra) {
+    return adquireTam(&cobra->corpo);
 }
 
-tCobra moveCbr(tCobra cobra, tPosicao pos, char celDevorado) {
+int cresceAoDevorar(char celDevorado) {
+    return celDevorado == CEL_COMID;
+}
+
+void moveCbr(tCobra *cobra, tPosicao pos, char celDevorado) {
+    int cresce = cresceAoDevorar(celDevorado);
     // define novo devorado
-    cobra.devorado = celDevorado;
+    cobra->devorado = celDevorado;
     // move a cobra
-    cobra.corpo = enfileira(cobra.corpo, pos);
-    if (celDevorado != CEL_COMID) {
-        cobra.corpo = desenfileira(cobra.corpo);
+    enfileira(&cobra->corpo, pos);
+    if (!cresce) {
+        desenfileira(&cobra->corpo);
     }
     // verifica se cobra nao morreu
     if (celDevorado == CEL_PARED) {
-        cobra.estado = CBR_EST_M;
+        cobra->estado = CBR_EST_M;
     }
     else {
         int i;
-        for (i = adquireTam(cobra.corpo) - 1; i > 0; i--) {
-            if (comparaPos(adquireElem(cobra.corpo, i), pos)) {
-                cobra.estado = CBR_EST_M;
+        for (i = adquireTam(&cobra->corpo) - 1; i > 0; i--) {
+            if (comparaPos(consultaElem(&cobra->corpo, i), pos)) {
+                cobra->estado = CBR_EST_M;
                 break;
             }
         }
     }
+}
 
-    return cobra;
+void clonaCobra(tCobra *destino, const tCobra *origem) {
+    clonaFila(&destino->corpo, &origem->corpo);
+    destino->direcaoCabeca = origem->direcaoCabeca;
+    destino->devorado = origem->devorado;
+    destino->estado = origem->estado;
 }
 // FIM COBRA
 
 // FILA
-tFila inicializaFila() {
-    tFila fila = { 0 };
+tFila inicializaFila(tPosicao vet[], int capacidade) {
+    tFila fila = { 0, 0, capacidade, vet };
     return fila;
 }
 
-int adquireTam(tFila fila) {
-    return fila.tam;
+int adquireTam(const tFila *fila) {
+    return fila->tam;
 }
 
-tPosicao adquireElem(tFila fila, int index) {
-    if (index < 0 || index >= fila.tam) {
-        index = fila.tam - 1;
+tPosicao adquireElem(const tFila *fila, int index) {
+    if (index < 0 || index >= fila->tam) {
+        index = fila->tam - 1;
     }
 
-    return fila.vet[index];
+    return consultaElem(fila, index);
 }
 
-tFila enfileira(tFila fila, tPosicao pos) {
-    int i;
-    for (i = fila.tam; i > 0; i--) {
-        fila.vet[i] = fila.vet[i - 1];
-    }
-    fila.vet[0] = pos;
-    fila.tam++;
+tPosicao consultaElem(const tFila *fila, int index) {
+    // a capacidade nao e constante: uma subtracao evita a divisao do resto
+    int i = fila->inicio + index;
+    return fila->vet[i >= fila->capacidade ? i - fila->capacidade : i];
+}
 
-    return fila;
+void enfileira(tFila *fila, tPosicao pos) {
+    fila->inicio = fila->inicio == 0 ? fila->capacidade - 1 : fila->inicio - 1;
+    fila->vet[fila->inicio] = pos;
+    fila->tam++;
 }
 
-tFila desenfileira(tFila fila) {
-    fila.tam--;
-    return fila;
+void desenfileira(tFila *fila) {
+    fila->tam--;
+}
+
+void removeInicio(tFila *fila) {
+    fila->inicio = fila->inicio == fila->capacidade - 1 ? 0 : fila->inicio + 1;
+    fila->tam--;
+}
+
+void insereFim(tFila *fila, tPosicao pos) {
+    int i = fila->inicio + fila->tam;
+    fila->vet[i >= fila->capacidade ? i - fila->capacidade : i] = pos;
+    fila->tam++;
+}
+
+void clonaFila(tFila *destino, const tFila *origem) {
+    // a copia e armazenada a partir do inicio do buffer
+    int primeiros = origem->capacidade - origem->inicio < origem->tam ? origem->capacidade - origem->inicio : origem->tam;
+    memcpy(destino->vet, origem->vet + origem->inicio, primeiros * sizeof(tPosicao));
+    memcpy(destino->vet + primeiros, origem->vet, (origem->tam - primeiros) * sizeof(tPosicao));
+    destino->tam = origem->tam;
+    destino->inicio = 0;
 }
 // FIM FILA
 
 // RANK
-tRank inicializaRank(tPosicao posicao, int heat) {
+tRank inicializaRank(tPosicao posicao, long long heat) {
     tRank rank = { posicao, heat };
     return rank;
 }
@@ -1354,7 +9157,7 @@ tPosicao adquirePosicao(tRank rank) {
     return rank.posicao;
 }
 
-int adquireHeat(tRank rank) {
+long long adquireHeat(tRank rank) {
     return rank.heat;
 }
 
@@ -1422,19 +9225,12 @@ int comparaRank(tRank rank1, tRank rank2) {
     if (rank1.heat < rank2.heat)
         return -1;
 
-    if (adquireI(rank1.posicao) <= adquireI(rank2.posicao)) {
-        if (adquireI(rank1.posicao) < adquireI(rank2.posicao))
-            return 1;
-
-        if (adquireJ(rank1.posicao) <= adquireJ(rank2.posicao)) {
-            if (adquireJ(rank1.posicao) < adquireJ(rank2.posicao))
-                return 1;
-            
-            return 0;
-        }
+    // o indice da posicao segue a ordem de linha e depois coluna
+    if (rank1.posicao < rank2.posicao)
+        return 1;
 
-        return -1;
-    }
+    if (rank1.posicao == rank2.posicao)
+        return 0;
 
     return -1;
 }
@@ -1442,23 +9238,19 @@ int comparaRank(tRank rank1, tRank rank2) {
 
 // POSICAO
 tPosicao inicializaPosicao(int i, int j) {
-    tPosicao pos = { i, j };
-    return pos;
+    return (i + 1) * POS_LARGURA + j + 1;
 }
 
 int adquireI(tPosicao pos) {
-    return pos.i;
+    return pos / POS_LARGURA - 1;
 }
 
 int adquireJ(tPosicao pos) {
-    return pos.j;
+    return pos % POS_LARGURA - 1;
 }
 
 tPosicao alteraPeloDelta(tPosicao pos, int dI, int dJ) {
-    pos.i += dI;
-    pos.j += dJ;
-
-    return pos;
+    return pos + dI * POS_LARGURA + dJ;
 }
 
 tPosicao avancaNaDirecao(tPosicao pos, int direcao) {
@@ -1481,7 +9273,7 @@ tPosicao avancaNaDirecao(tPosicao pos, int direcao) {
 }
 
 int comparaPos(tPosicao pos1, tPosicao pos2) {
-    return pos1.i == pos2.i && pos1.j == pos2.j;
+    return pos1 == pos2;
 }
 // FIM POSICAO
 
@@ -0,0 +1,327 @@
+/**
+ * @file JheamStorchRoss.h
+ * @author Jheam Storch Ross
+ * @brief API em C do motor do jogo snake, para embuti-lo em outros programas sem executar a linha de comando
+ * @version 1.0
+ * @date 2022-08-11
+ *
+ * @copyright Copyright (c) 2022
+ *
+ * Cada @ref jsrJogo e independente: jogos diferentes podem ser usados em threads diferentes ao mesmo
+ * tempo, mas um mesmo jogo nao deve ser usado por duas threads ao mesmo tempo. Nenhuma funcao encerra o
+ * processo: falta de memoria e informada pelo retorno, como descrito em cada uma.
+ *
+ * Compilada com -DJSR_BIBLIOTECA, a partir de JheamStorchRoss.c (veja compilaBiblioteca.sh).
+ *
+ */
+
+#ifndef JHEAMSTORCHROSS_H
+#define JHEAMSTORCHROSS_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Contem a versao da API; muda apenas de forma compativel enquanto o primeiro numero for o mesmo
+ *
+ */
+#define JSR_VERSAO "2.6.0"
+
+/**
+ * @brief Marca as funcoes exportadas pela biblioteca; todo o resto do motor fica oculto
+ *
+ */
+#define JSR_API __attribute__((visibility("default")))
+
+/**
+ * @brief Contem o estado de um jogo em andamento
+ *
+ */
+#define JSR_EST_CONTINUA 0
+/**
+ * @brief Contem o estado de um jogo vencido: toda a comida foi devorada
+ *
+ */
+#define JSR_EST_VITORIA 1
+/**
+ * @brief Contem o estado de um jogo perdido por colisao
+ *
+ */
+#define JSR_EST_DERROTA 2
+
+/**
+ * @brief Artefato com o tabuleiro atual e o placar, como impressos pela linha de comando a cada movimento
+ *
+ */
+#define JSR_ART_TABULEIRO 0
+/**
+ * @brief Artefato com o conteudo de inicializacao.txt
+ *
+ */
+#define JSR_ART_INICIALIZACAO 1
+/**
+ * @brief Artefato com o conteudo de resumo.txt ate o movimento atual; vazio sem @ref jsrDefineResumo
+ *
+ */
+#define JSR_ART_RESUMO 2
+/**
+ * @brief Artefato com o conteudo de estatisticas.txt no movimento atual
+ *
+ */
+#define JSR_ART_ESTATISTICAS 3
+/**
+ * @brief Artefato com o conteudo de heatmap.txt no movimento atual
+ *
+ */
+#define JSR_ART_HEATMAP 4
+/**
+ * @brief Artefato com o conteudo de ranking.txt no movimento atual
+ *
+ */
+#define JSR_ART_RANKING 5
+
+/**
+ * @brief Evento em que a cobra devora uma comida e cresce
+ *
+ */
+#define JSR_EVT_COMIDA 1
+/**
+ * @brief Evento em que a cobra devora um dinheiro
+ *
+ */
+#define JSR_EVT_DINHEIRO 2
+/**
+ * @brief Evento em que a cobra morre ao bater numa parede
+ *
+ */
+#define JSR_EVT_PAREDE 3
+/**
+ * @brief Evento em que a cobra morre ao bater no proprio corpo
+ *
+ */
+#define JSR_EVT_CORPO 4
+/**
+ * @brief Evento em que a cobra devora a ultima comida, vencendo o jogo
+ *
+ */
+#define JSR_EVT_VITORIA 5
+
+/**
+ * @brief Representa um jogo do motor; opaco, criado por @ref jsrCriaJogo e liberado por @ref jsrLiberaJogo
+ *
+ */
+typedef struct jsrJogo jsrJogo;
+
+/**
+ * @brief Representa o estado consultavel de um @ref jsrJogo
+ *
+ */
+typedef struct {
+    int nLinhas; ///< Numero de linhas do mapa
+    int mColunas; ///< Numero de colunas do mapa
+    int estado; ///< O estado do jogo: @ref JSR_EST_CONTINUA , @ref JSR_EST_VITORIA ou @ref JSR_EST_DERROTA
+    long long pontuacao; ///< A pontuacao atual
+    long long qtdMovimentos; ///< Quantos movimentos ja foram feitos
+    int qtdComida; ///< Quantas comidas restam no mapa
+    int tamanho; ///< O tamanho da cobra
+    int cabecaI; ///< A linha da cabeca da cobra, a partir de 0
+    int cabecaJ; ///< A coluna da cabeca da cobra, a partir de 0
+} jsrEstado;
+
+/**
+ * @brief Representa um evento do jogo; tambem e, byte a byte, cada registro de eventos.bin
+ *
+ */
+typedef struct {
+    long long movimento; ///< O numero do movimento, a partir de 1
+    long long pontuacao; ///< A pontuacao apos o movimento
+    int tamanho; ///< O tamanho da cobra apos o movimento
+    char tipo; ///< O tipo do evento, como @ref JSR_EVT_COMIDA
+    char comando; ///< O caractere do movimento, como passado a @ref jsrJoga
+    char reservado[2]; ///< Sempre zero
+} jsrEvento;
+
+/**
+ * @brief Representa a funcao que recebe os eventos de um @ref jsrJogo
+ *
+ */
+typedef void (*jsrTratador)(const jsrEvento *evento, void *contexto);
+
+/**
+ * @brief Representa o agregado de varios heatmaps do mesmo mapa, celula a celula, indexado por i * mColunas + j
+ *
+ */
+typedef struct {
+    int nLinhas; ///< Numero de linhas do mapa
+    int mColunas; ///< Numero de colunas do mapa
+    int qtdHeatmaps; ///< Numero de heatmaps agregados
+    long long *soma; ///< A soma dos heatmaps
+    long long *maximo; ///< O maior valor entre os heatmaps
+    double *media; ///< A media dos heatmaps
+    long long *percentil; ///< O percentil pedido, pelo metodo do posto mais proximo; NULL quando nenhum foi pedido
+} jsrAgregado;
+
+/**
+ * @brief Adquire a versao da biblioteca carregada, para comparar com @ref JSR_VERSAO
+ *
+ * @return const char* A versao
+ */
+JSR_API const char *jsrVersao(void);
+/**
+ * @brief Cria um jogo a partir do texto de um mapa em memoria, no formato de mapa.txt
+ *
+ * @param mapa O texto do mapa; nao precisa terminar em '\0' e e copiado
+ * @param tamanho O numero de bytes de @p mapa
+ * @return jsrJogo* O novo jogo; NULL, caso o mapa seja invalido ou falte memoria
+ */
+JSR_API jsrJogo *jsrCriaJogo(const char mapa[], size_t tamanho);
+/**
+ * @brief Passa a escrever os arquivos do jogo no @p diretorio , em segundo plano, como a linha de comando
+ *
+ * Escreve inicializacao.txt imediatamente; resumo.txt a cada evento; estatisticas.txt, heatmap.txt e
+ * ranking.txt em @ref jsrLiberaJogo . Sem esta chamada o jogo nao toca no sistema de arquivos.
+ *
+ * @param jogo O @ref jsrJogo , ainda sem movimentos
+ * @param diretorio O diretorio de saida, ja existente
+ * @param intervaloSerie A cada quantos movimentos acrescentar um snapshot a heatmap_serie.bin; 0 para nenhum
+ * @return int 0 em caso de sucesso; -1 se o jogo ja tiver movimentos ou saida, se o caminho for longo demais, se
+ * heatmap_serie.bin nao puder ser criado ou se faltar memoria ou uma thread para a escrita, e entao o jogo continua
+ * sem saida. Os demais arquivos que nao puderem ser abertos sao informados por @ref jsrLiberaJogo
+ */
+JSR_API int jsrDefineSaida(jsrJogo *jogo, const char diretorio[], int intervaloSerie);
+/**
+ * @brief Passa a manter em memoria o texto de resumo.txt, para o artefato @ref JSR_ART_RESUMO
+ *
+ * O texto cresce a cada evento ate @ref jsrLiberaJogo ; em jogos longos no modo infinito, prefira o arquivo
+ * resumo.txt de @ref jsrDefineSaida ou um tratador de @ref jsrRegistraTratador .
+ *
+ * @param jogo O @ref jsrJogo , ainda sem movimentos
+ * @return int 0 em caso de sucesso; -1 se o jogo ja tiver movimentos, ja mantiver o resumo ou faltar memoria
+ */
+JSR_API int jsrDefineResumo(jsrJogo *jogo);
+/**
+ * @brief Passa a acrescentar cada evento tambem a eventos.bin, no diretorio de saida, alem de resumo.txt
+ *
+ * eventos.bin e a assinatura "JSREVT1\0" seguida de um @ref jsrEvento por evento, na ordem de bytes da maquina.
+ *
+ * @param jogo O @ref jsrJogo , com saida definida por @ref jsrDefineSaida e ainda sem movimentos
+ * @return int 0 em caso de sucesso; -1 se o jogo nao tiver saida, ja tiver movimentos ou ja registrar os eventos
+ */
+JSR_API int jsrDefineEventos(jsrJogo *jogo);
+/**
+ * @brief Poe o jogo no modo infinito: cada comida devorada renasce numa celula vazia sorteada
+ *
+ * A comida restante nunca acaba, e o jogo so termina com a morte da cobra; o sorteio depende apenas da
+ * @p semente e dos movimentos. A cobra cresce a cada comida, ate ocupar o tabuleiro.
+ *
+ * @param jogo O @ref jsrJogo , ainda sem movimentos
+ * @param semente A semente do sorteio
+ * @return int 0 em caso de sucesso; -1 se o jogo ja tiver movimentos, ja estiver no modo infinito ou faltar memoria
+ */
+JSR_API int jsrDefineInfinito(jsrJogo *jogo, unsigned long long semente);
+/**
+ * @brief Passa a manter o heatmap em heatmap_vivo.bin, no diretorio de saida, atualizado no lugar a cada movimento
+ *
+ * O arquivo tem tamanho fixo e pode ser lido por outros processos durante o jogo: a assinatura "JSRHMV1\0",
+ * nLinhas e mColunas em 32 bits, a quantidade de movimentos em 64 bits e, linha a linha, um contador de
+ * 64 bits por celula, todos na ordem de bytes da maquina. heatmap.txt continua sendo escrito ao fim.
+ *
+ * @param jogo O @ref jsrJogo , com saida definida por @ref jsrDefineSaida
+ * @return int 0 em caso de sucesso; -1 se o jogo nao tiver saida, ja tiver o arquivo, ou o arquivo nao puder ser mapeado
+ */
+JSR_API int jsrDefineHeatmapVivo(jsrJogo *jogo);
+/**
+ * @brief Registra o @p tratador chamado a cada evento do jogo, durante @ref jsrJoga e na mesma thread
+ *
+ * O evento so e valido durante a chamada; o tratador nao deve usar o proprio @p jogo .
+ *
+ * @param jogo O @ref jsrJogo
+ * @param tratador O tratador, substituindo o anterior; NULL para nenhum
+ * @param contexto Repassado ao tratador a cada evento
+ * @return int 0
+ */
+JSR_API int jsrRegistraTratador(jsrJogo *jogo, jsrTratador tratador, void *contexto);
+/**
+ * @brief Faz, em ordem, ate @p qtd movimentos no jogo, parando quando ele acaba
+ *
+ * 'h' gira no sentido horario, 'a' no anti-horario e qualquer outro caractere segue em frente,
+ * como na linha de comando. Os movimentos nunca falham por falta de memoria: um snapshot de heatmap_serie.bin
+ * que nao caiba vai junto com o seguinte, e uma celula do heatmap cujos contadores nao possam passar a 64 bits
+ * para em 4294967295, o que @ref jsrLiberaJogo informa.
+ *
+ * @param jogo O @ref jsrJogo
+ * @param movimentos Os movimentos
+ * @param qtd O numero de movimentos
+ * @return int Quantos movimentos foram feitos
+ */
+JSR_API int jsrJoga(jsrJogo *jogo, const char movimentos[], int qtd);
+/**
+ * @brief Consulta o estado do jogo
+ *
+ * @param jogo O @ref jsrJogo
+ * @param estado Recebe o estado
+ */
+JSR_API void jsrConsulta(const jsrJogo *jogo, jsrEstado *estado);
+/**
+ * @brief Copia o texto de um artefato do jogo para o @p buffer , como o snprintf
+ *
+ * @param jogo O @ref jsrJogo
+ * @param artefato O artefato, como @ref JSR_ART_TABULEIRO
+ * @param buffer Recebe ate @p capacidade - 1 bytes do artefato e um '\0'; pode ser NULL se @p capacidade for 0
+ * @param capacidade O tamanho do @p buffer
+ * @return size_t O tamanho completo do artefato, sem o '\0'; 0 para um artefato desconhecido ou se faltar memoria
+ */
+JSR_API size_t jsrArtefato(const jsrJogo *jogo, int artefato, char buffer[], size_t capacidade);
+/**
+ * @brief Soma as passagens da cabeca da cobra pelas celulas de um retangulo do mapa, em tempo constante
+ *
+ * Usa uma tabela de somas do heatmap, reconstruida numa unica passada na primeira consulta apos cada
+ * @ref jsrJoga ; consultas seguidas, sem movimentos entre elas, nao percorrem o mapa.
+ *
+ * @param jogo O @ref jsrJogo
+ * @param i1 A linha do canto superior esquerdo, a partir de 0
+ * @param j1 A coluna do canto superior esquerdo, a partir de 0
+ * @param i2 A linha do canto inferior direito, inclusive
+ * @param j2 A coluna do canto inferior direito, inclusive
+ * @return long long A soma na parte do retangulo dentro do mapa; 0 se nao houver; -1 se faltar memoria para a tabela
+ */
+JSR_API long long jsrSomaRegiao(jsrJogo *jogo, int i1, int j1, int i2, int j2);
+/**
+ * @brief Libera o jogo; com saida definida, escreve antes os arquivos finais e espera sua escrita terminar
+ *
+ * @param jogo O @ref jsrJogo , podendo ser NULL
+ * @return int 0 em caso de sucesso; -1 se faltou memoria para algum arquivo final, se algum arquivo de saida nao pode
+ * ser aberto ou se o heatmap ficou incompleto, casos em que o jogo e liberado da mesma forma
+ */
+JSR_API int jsrLiberaJogo(jsrJogo *jogo);
+/**
+ * @brief Agrega os heatmaps dos @p arquivos em @p qtdThreads threads: soma, maximo, media e, se pedido, um percentil por celula
+ *
+ * Cada arquivo pode ser um heatmap.txt (ou heatmap_montecarlo.txt), um heatmap_vivo.bin ou um heatmap_serie.bin,
+ * cujos snapshots sao somados; todos devem ter as dimensoes do primeiro. O percentil guarda o valor de cada
+ * arquivo em cada celula durante a agregacao.
+ *
+ * @param arquivos Os caminhos dos arquivos
+ * @param qtd O numero de arquivos
+ * @param qtdThreads O numero de threads; 0 para o numero de nucleos
+ * @param percentil O percentil a calcular, entre 0 (exclusive) e 100; 0 para nenhum
+ * @param agregado Recebe o agregado, apenas em caso de sucesso; deve ser liberado com @ref jsrLiberaAgregado
+ * @return int 0 em caso de sucesso; -1 se @p qtd nao for positivo ou @p percentil estiver fora do intervalo;
+ * -2 se faltar memoria; caso contrario, 1 mais o indice do primeiro arquivo invalido ou com dimensoes diferentes
+ */
+JSR_API int jsrAgregaHeatmaps(const char *const arquivos[], int qtd, int qtdThreads, double percentil, jsrAgregado *agregado);
+/**
+ * @brief Libera a memoria de um @ref jsrAgregado preenchido por @ref jsrAgregaHeatmaps
+ *
+ * @param agregado O @ref jsrAgregado
+ */
+JSR_API void jsrLiberaAgregado(jsrAgregado *agregado);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
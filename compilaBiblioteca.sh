@@ -0,0 +1,12 @@
+srcFile=JheamStorchRoss.c
+buildDir=build
+libName=jheamstorchross
+
+mkdir -p $buildDir
+
+# o motor sem o main; so as funcoes jsr* de JheamStorchRoss.h ficam visiveis
+gcc --std=gnu89 -O2 -fPIC -fvisibility=hidden -DJSR_BIBLIOTECA -c $srcFile -o $buildDir/$libName.o -pthread
+objcopy --localize-hidden $buildDir/$libName.o
+
+ar rcs $buildDir/lib$libName.a $buildDir/$libName.o
+gcc -shared $buildDir/$libName.o -o $buildDir/lib$libName.so -lm -pthread
@@ -1,7 +1,7 @@
 srcFile=JheamStorchRoss.c
 buildFile=build/main
 
-gcc --std=gnu89 $srcFile -o $buildFile -lm
+gcc --std=gnu89 $srcFile -o $buildFile -lm -pthread
 
 for subfolder in ./Testes/*
 do